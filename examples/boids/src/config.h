@@ -7,6 +7,25 @@
 #define BUTTON_PIN 5 // D3
 #define BUTTON_TAP_TIME 200
 
+// flock size, up to 255 (boid indices are bytes)
+#define NUM_BOIDS 120
+
+// erase and redraw only each boid's last head and trail instead of clearing
+// the frame, and flush only the damaged spans; 0 is the clear-and-redraw path
+#define SPRITE_REDRAW 1
+
+// flock updates per second, independent of how long a frame takes to draw
+#define STEP_HZ 50
+
+// shrink the flock to as little as a quarter of NUM_BOIDS when frames run
+// over the step, and grow it back when there is time, logging each change
+// over serial; 0 always draws NUM_BOIDS
+#define QUALITY_GOVERNOR 1
+
+// print flush byte counts and missed frame deadlines over serial every
+// 100 frames
+#define FLUSH_STATS 0
+
 // globals
 #include <Adafruit_SSD1306.h>
 extern Adafruit_SSD1306 display;
\ No newline at end of file
@@ -3,14 +3,23 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "config.h"
+#include "page_line.h"
+#include "ssd1306_bus.h"
+#include "dirty_flush.h"
+#include "sprite_layer.h"
+#include "frame_clock.h"
+#include "button_input.h"
+#include "quality_governor.h"
 
 #define OLED_RESET -1
 
 // Display instance
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+WireBus bus(Wire);
+DirtyFlush flusher(bus); // sends only the spans that changed since the last frame
+FrameClock frameClock(1000000 / STEP_HZ);
 
 // Boids simulation parameters
-#define NUM_BOIDS 42
 #define MAX_SPEED 2.2f
 #define MAX_FORCE 0.35f
 #define SEPARATION_DISTANCE 18.0f
@@ -28,7 +37,9 @@ Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 #define GRID_CELL_SIZE 35
 #define GRID_WIDTH (SCREEN_WIDTH / GRID_CELL_SIZE + 1)
 #define GRID_HEIGHT (SCREEN_HEIGHT / GRID_CELL_SIZE + 1)
-#define MAX_BOIDS_PER_CELL 10
+#define MAX_BOIDS_PER_CELL (NUM_BOIDS / 4 + 10)
+
+static_assert(NUM_BOIDS <= 255, "boid indices are uint8_t");
 
 struct GridCell {
     uint8_t boid_indices[MAX_BOIDS_PER_CELL];
@@ -45,14 +56,23 @@ struct Boid {
 };
 
 Boid boids[NUM_BOIDS];
+
+// Flock size per quality level, cheapest first: a quarter of NUM_BOIDS up to
+// all of them. Boids past activeBoids keep their state and rejoin where
+// they were left.
+#define QUALITY_LEVELS 4
+QualityGovernor governor(1000000 / STEP_HZ, QUALITY_LEVELS, QUALITY_LEVELS - 1);
+uint8_t activeBoids = NUM_BOIDS;
 GridCell grid[GRID_WIDTH][GRID_HEIGHT];
 
-// Button state tracking
-static unsigned long lastButtonChangeTime = 0;
+#if SPRITE_REDRAW
+SpriteFootprint footprints[NUM_BOIDS]; // one sprite per boid: trail plus head
+SpriteLayer sprites(footprints, NUM_BOIDS); // attached to display's buffer in setup()
+#endif
+
+// Button, read by interrupt; a tap restarts the flock
 static const unsigned long DEBOUNCE_DELAY = 100;
-static bool lastButtonState = HIGH;
-static bool buttonCurrentlyPressed = false;
-static bool lastDebouncedState = HIGH;
+ButtonInput button(BUTTON_PIN, DEBOUNCE_DELAY, 1000);
 
 // Inline distance check
 inline float distanceSquared(float x1, float y1, float x2, float y2) {
@@ -77,7 +97,7 @@ void buildGrid() {
     }
 
     // Add boids to grid cells
-    for (uint8_t i = 0; i < NUM_BOIDS; i++) {
+    for (uint8_t i = 0; i < activeBoids; i++) {
         int cell_x = (int)boids[i].x / GRID_CELL_SIZE;
         int cell_y = (int)boids[i].y / GRID_CELL_SIZE;
 
@@ -334,12 +354,73 @@ void initializeBoids() {
     }
 }
 
+// Head end point from velocity and tail length
+inline void headEnd(uint8_t i, int x, int y, int& x2, int& y2) {
+    float speed = sqrt(boids[i].vx * boids[i].vx + boids[i].vy * boids[i].vy);
+    x2 = x;
+    y2 = y;
+
+    if (speed > 0.1f) {
+        // Normalize velocity and scale to tail length
+        x2 = x + (int)(boids[i].vx / speed * BOID_TAIL_LENGTH);
+        y2 = y + (int)(boids[i].vy / speed * BOID_TAIL_LENGTH);
+    }
+    x2 = constrain(x2, 0, SCREEN_WIDTH - 1);
+    y2 = constrain(y2, 0, SCREEN_HEIGHT - 1);
+}
+
+inline bool onScreen(int x, int y) {
+    return x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT;
+}
+
+#if SPRITE_REDRAW
+// Erase every boid's last footprint, then draw each trail and head as one
+// sprite; the frame is never cleared.
+void drawBoids() {
+    sprites.eraseAll();
+    for (uint8_t i = 0; i < activeBoids; i++) {
+        sprites.select(i);
+        for (uint8_t j = 0; j < TRAIL_LENGTH - 1; j++) {
+            uint8_t trail_idx = (boids[i].trail_index + j) % TRAIL_LENGTH;
+            uint8_t next_idx = (trail_idx + 1) % TRAIL_LENGTH;
+            int x1 = boids[i].trail_x[trail_idx];
+            int y1 = boids[i].trail_y[trail_idx];
+            int x2 = boids[i].trail_x[next_idx];
+            int y2 = boids[i].trail_y[next_idx];
+            if (onScreen(x1, y1) && onScreen(x2, y2)) sprites.line(x1, y1, x2, y2);
+        }
+
+        int x = (int)boids[i].x;
+        int y = (int)boids[i].y;
+        if (onScreen(x, y)) {
+            int x2, y2;
+            headEnd(i, x, y, x2, y2);
+            sprites.line(x, y, x2, y2);
+        }
+    }
+}
+
+void present() {
+    flusher.flush(display.getBuffer(), sprites.firstCols(), sprites.lastCols());
+#if FLUSH_STATS
+    if (flusher.frames() % 100 == 0) {
+        flusher.printStats(Serial);
+        frameClock.printStats(Serial);
+        governor.printStats(Serial);
+        button.printStats(Serial);
+        Serial.printf("sprites: %u frame bytes touched\n", (unsigned)sprites.touchedBytes());
+    }
+#endif
+    sprites.clearDamage();
+}
+#else
 // Draw all boids as directional lines with trails
 void drawBoids() {
     display.clearDisplay();
+    uint8_t* frame = display.getBuffer();
     
     // Draw trails first (behind birds)
-    for (uint8_t i = 0; i < NUM_BOIDS; i++) {
+    for (uint8_t i = 0; i < activeBoids; i++) {
         for (uint8_t j = 0; j < TRAIL_LENGTH - 1; j++) {
             uint8_t trail_idx = (boids[i].trail_index + j) % TRAIL_LENGTH;
             uint8_t next_idx = (trail_idx + 1) % TRAIL_LENGTH;
@@ -350,72 +431,52 @@ void drawBoids() {
             int y2 = boids[i].trail_y[next_idx];
             
             // Only draw if points are valid and on screen
-            if (x1 >= 0 && x1 < SCREEN_WIDTH && y1 >= 0 && y1 < SCREEN_HEIGHT &&
-                x2 >= 0 && x2 < SCREEN_WIDTH && y2 >= 0 && y2 < SCREEN_HEIGHT) {
-                display.drawLine(x1, y1, x2, y2, SSD1306_WHITE);
+            if (onScreen(x1, y1) && onScreen(x2, y2)) {
+                pageLine(frame, x1, y1, x2, y2, SSD1306_WHITE);
             }
         }
     }
     
     // Draw birds on top
-    for (uint8_t i = 0; i < NUM_BOIDS; i++) {
+    for (uint8_t i = 0; i < activeBoids; i++) {
         int x = (int)boids[i].x;
         int y = (int)boids[i].y;
         
-        // Calculate direction point based on velocity and tail length
-        float speed = sqrt(boids[i].vx * boids[i].vx + boids[i].vy * boids[i].vy);
-        int x2 = x, y2 = y;
-        
-        if (speed > 0.1f) {
-            // Normalize velocity and scale to tail length
-            x2 = x + (int)(boids[i].vx / speed * BOID_TAIL_LENGTH);
-            y2 = y + (int)(boids[i].vy / speed * BOID_TAIL_LENGTH);
-        }
-        
-        // Draw line from current position to direction point
-        if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
-            x2 = constrain(x2, 0, SCREEN_WIDTH - 1);
-            y2 = constrain(y2, 0, SCREEN_HEIGHT - 1);
-            
-            // Draw line from head to tail
-            display.drawLine(x, y, x2, y2, SSD1306_WHITE);
+        // Draw line from head to tail
+        if (onScreen(x, y)) {
+            int x2, y2;
+            headEnd(i, x, y, x2, y2);
+            pageLine(frame, x, y, x2, y2, SSD1306_WHITE);
         }
     }
-    display.display();
 }
 
+void present() {
+    flusher.flush(display.getBuffer());
+#if FLUSH_STATS
+    if (flusher.frames() % 100 == 0) {
+        flusher.printStats(Serial);
+        frameClock.printStats(Serial);
+        governor.printStats(Serial);
+        button.printStats(Serial);
+    }
+#endif
+}
+#endif
+
 // Update all boids
 void updateAllBoids() {
     buildGrid();
-    for (uint8_t i = 0; i < NUM_BOIDS; i++) {
+    for (uint8_t i = 0; i < activeBoids; i++) {
         updateBoid(i);
     }
 }
 
 void handleButtonPress() {
-    bool currentState = digitalRead(BUTTON_PIN);
-    static bool debounceActive = false;
-
-    if (currentState != lastDebouncedState && !debounceActive) {
-        lastButtonChangeTime = millis();
-        debounceActive = true;
-    }
-
-    if (debounceActive && (millis() - lastButtonChangeTime) > DEBOUNCE_DELAY) {
-        debounceActive = false;
-        lastDebouncedState = currentState;
-
-        // Button press detected (transition to HIGH when pressed)
-        if (currentState == HIGH) {
-            if (!buttonCurrentlyPressed) {
-                buttonCurrentlyPressed = true;
-                initializeBoids();
-            }
-        } else {
-            buttonCurrentlyPressed = false;
-            if (currentState == LOW) {
-            }
-        }
+    button.update();
+    ButtonEvent event;
+    while (button.next(event)) {
+        if (event.kind == ButtonEventKind::kTap) initializeBoids();
     }
 }
 
@@ -430,6 +491,10 @@ void setup() {
         for (;;)
             ;
     }
+    bus.begin();
+#if SPRITE_REDRAW
+    sprites.attach(display.getBuffer());
+#endif
 
     display.clearDisplay();
     display.setTextSize(1);
@@ -437,24 +502,31 @@ void setup() {
     display.setCursor(0, 0);
 
     // Button setup
-    pinMode(BUTTON_PIN, INPUT_PULLUP);
-    
-    // Initialize button state to current reading to avoid false triggers
-    lastButtonState = digitalRead(BUTTON_PIN);
-    lastDebouncedState = lastButtonState;
+    button.begin();
     Serial.printf("Button initialized on pin %d\n", BUTTON_PIN);
-    Serial.printf("Initial button state: %d\n", lastButtonState);
 
     // Initialize boids
     initializeBoids();
+#if QUALITY_GOVERNOR
+    governor.setLog(&Serial);
+#endif
 
     Serial.println("Boids demo started");
 }
 
 void loop() {
     handleButtonPress();
-    updateAllBoids();
-    drawBoids();
-
-    delay(1);
+    int steps = frameClock.steps();
+    if (steps > 0) governor.begin();
+    for (int n = 0; n < steps; n++) updateAllBoids();
+    if (steps > 0) {
+        governor.updated();
+        drawBoids();
+        governor.rendered();
+        present();
+#if QUALITY_GOVERNOR
+        if (governor.flushed()) activeBoids = NUM_BOIDS * (governor.level() + 1) / QUALITY_LEVELS;
+#endif
+    }
+    frameClock.sleep();
 }
\ No newline at end of file
@@ -19,6 +19,14 @@
 #define BALL_RADIUS 2
 #define BALL_SPEED 1.4
 
+// physics steps per second; the ball moves BALL_SPEED-ish pixels a step
+// however long a frame takes to draw
+#define STEP_HZ 100
+
+// time one frame through the rotated GFX path and the portrait canvas
+// every 200 frames and print both, and missed frame deadlines, over serial
+#define PORTRAIT_BENCH 0
+
 // globals
 #include <Adafruit_SSD1306.h>
 extern Adafruit_SSD1306 display;
\ No newline at end of file
@@ -2,8 +2,14 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "config.h"
+#include "ssd1306_bus.h"
+#include "portrait_canvas.h"
+#include "frame_clock.h"
 
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+WireBus bus(Wire);
+PortraitCanvas canvas; // GAME_WIDTH x GAME_HEIGHT, streamed with vertical addressing
+FrameClock frameClock(1000000 / STEP_HZ);
 
 // Game variables
 bool bricks[BRICK_ROWS][BRICK_COLS];
@@ -37,6 +43,57 @@ void resetGame() {
   bouncesSinceBrick = 0;
 }
 
+void drawGame(Adafruit_GFX& gfx) {
+  gfx.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
+  for (int r = 0; r < BRICK_ROWS; r++) {
+    for (int c = 0; c < BRICK_COLS; c++) {
+      if (bricks[r][c]) {
+        gfx.fillRect(brick_start_x + c * BRICK_WIDTH + 1, brick_start_y + r * BRICK_HEIGHT + 1, BRICK_WIDTH - 2, BRICK_HEIGHT - 2, SSD1306_WHITE);
+      }
+    }
+  }
+  gfx.fillRect((int)paddleX, GAME_HEIGHT - PADDLE_HEIGHT, PADDLE_WIDTH, PADDLE_HEIGHT, SSD1306_WHITE);
+  gfx.fillRect(ballX, ballY, 4, 4, SSD1306_WHITE);
+}
+
+void drawResult(Adafruit_GFX& gfx) {
+  gfx.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
+  String msg = (gameState == WIN) ? "WIN" : "LOSE";
+  gfx.setTextSize(2);
+  gfx.setTextColor(SSD1306_WHITE);
+  int16_t x1, y1;
+  uint16_t w, h;
+  gfx.getTextBounds(msg, 0, 0, &x1, &y1, &w, &h);
+  int x = (GAME_WIDTH - w) / 2;
+  int y = (GAME_HEIGHT - h) / 2;
+  gfx.drawRoundRect(x - 5, y - 5, w + 10, h + 10, 5, SSD1306_WHITE);
+  gfx.setCursor(x, y);
+  gfx.print(msg);
+}
+
+#if PORTRAIT_BENCH
+// Same frame both ways, each with a full 1 KB flush so only the render and
+// transfer paths differ.
+void benchFrame() {
+  unsigned long start = micros();
+  display.clearDisplay();
+  drawGame(display);
+  display.display();
+  unsigned long gfxTime = micros() - start;
+  bus.begin(); // Adafruit drops Wire back to 100 kHz after its own transfers
+
+  start = micros();
+  canvas.fillScreen(SSD1306_BLACK);
+  drawGame(canvas);
+  canvas.invalidate();
+  canvas.present(bus);
+  unsigned long portraitTime = micros() - start;
+
+  Serial.printf("frame: rotated gfx %lu us, portrait canvas %lu us\n", gfxTime, portraitTime);
+  frameClock.printStats(Serial);
+}
+#endif
+
 void setup() {
   pinMode(BUTTON_PIN, INPUT_PULLUP);
   randomSeed(analogRead(0));
@@ -46,120 +103,113 @@ void setup() {
   if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
     for (;;);
   }
-  display.setRotation(1); // Rotate 90 degrees for vertical orientation
-  display.clearDisplay();
-  display.display();
+  display.setRotation(1); // only used by the benchmark; frames go through canvas
+  bus.begin();
+#if PORTRAIT_BENCH
+  Serial.begin(115200);
+#endif
+  canvas.fillScreen(SSD1306_BLACK);
+  canvas.present(bus);
 
   resetGame();
 }
 
-void loop() {
-  if (gameState == PLAYING) {
-    // Move paddle towards ball lazily
-    float targetX = ballX - PADDLE_WIDTH / 2.0 + random(-2, 3);
-    targetX = constrain(targetX, 4, GAME_WIDTH - PADDLE_WIDTH - 4);
-    paddleX = paddleX * 0.7 + targetX * 0.3;
-    paddleX = constrain(paddleX, 4, GAME_WIDTH - PADDLE_WIDTH - 4);
-
-    // Update ball position
-    ballX += ballVelX;
-    ballY += ballVelY;
-
-    // Ball collision with walls
-    if (ballX <= 0 || ballX >= GAME_WIDTH - 4) {
-      ballVelX = -ballVelX;
-      bouncesSinceBrick++;
-    }
-    if (ballY <= 0) {
-      ballVelY = -ballVelY;
-      bouncesSinceBrick++;
+void step() {
+  if (gameState != PLAYING) {
+    if (millis() > endTime) {
+      resetGame();
     }
+    return;
+  }
 
-    // Ball collision with paddle
-    if (ballY + 4 >= GAME_HEIGHT - PADDLE_HEIGHT && ballY <= GAME_HEIGHT && ballX + 4 >= paddleX && ballX <= paddleX + PADDLE_WIDTH) {
-      float hitPos = (ballX - paddleX) / PADDLE_WIDTH;
-      ballVelX = (hitPos - 0.5) * 3.0;
-      ballVelX += random(-1, 2); // Add extra randomness
-      if (abs(ballVelX) < 1.4) {
-        ballVelX = (ballVelX > 0) ? 1.4 : -1.4;
-      }
-      ballVelY = -abs(ballVelY); // Always bounce up
-      bouncesSinceBrick++;
-    }
+  // Move paddle towards ball lazily
+  float targetX = ballX - PADDLE_WIDTH / 2.0 + random(-2, 3);
+  targetX = constrain(targetX, 4, GAME_WIDTH - PADDLE_WIDTH - 4);
+  paddleX = paddleX * 0.7 + targetX * 0.3;
+  paddleX = constrain(paddleX, 4, GAME_WIDTH - PADDLE_WIDTH - 4);
 
-    // Ball collision with bricks
-    for (int r = 0; r < BRICK_ROWS; r++) {
-      for (int c = 0; c < BRICK_COLS; c++) {
-        if (bricks[r][c]) {
-          int bx = brick_start_x + c * BRICK_WIDTH;
-          int by = brick_start_y + r * BRICK_HEIGHT;
-          if (ballX >= bx && ballX <= bx + BRICK_WIDTH && ballY >= by && ballY <= by + BRICK_HEIGHT) {
-            bricks[r][c] = false;
-            ballVelY = -ballVelY;
-            bouncesSinceBrick = 0;
-          }
-        }
-      }
-    }
+  // Update ball position
+  ballX += ballVelX;
+  ballY += ballVelY;
+
+  // Ball collision with walls
+  if (ballX <= 0 || ballX >= GAME_WIDTH - 4) {
+    ballVelX = -ballVelX;
+    bouncesSinceBrick++;
+  }
+  if (ballY <= 0) {
+    ballVelY = -ballVelY;
+    bouncesSinceBrick++;
+  }
 
-    // Check if ball is out (below paddle)
-    if (ballY > GAME_HEIGHT) {
-      gameState = LOSE;
-      endTime = millis() + 2000;
+  // Ball collision with paddle
+  if (ballY + 4 >= GAME_HEIGHT - PADDLE_HEIGHT && ballY <= GAME_HEIGHT && ballX + 4 >= paddleX && ballX <= paddleX + PADDLE_WIDTH) {
+    float hitPos = (ballX - paddleX) / PADDLE_WIDTH;
+    ballVelX = (hitPos - 0.5) * 3.0;
+    ballVelX += random(-1, 2); // Add extra randomness
+    if (abs(ballVelX) < 1.4) {
+      ballVelX = (ballVelX > 0) ? 1.4 : -1.4;
     }
+    ballVelY = -abs(ballVelY); // Always bounce up
+    bouncesSinceBrick++;
+  }
 
-    // Check if all bricks are gone
-    bool allGone = true;
-    for (int r = 0; r < BRICK_ROWS; r++) {
-      for (int c = 0; c < BRICK_COLS; c++) {
-        if (bricks[r][c]) {
-          allGone = false;
+  // Ball collision with bricks
+  for (int r = 0; r < BRICK_ROWS; r++) {
+    for (int c = 0; c < BRICK_COLS; c++) {
+      if (bricks[r][c]) {
+        int bx = brick_start_x + c * BRICK_WIDTH;
+        int by = brick_start_y + r * BRICK_HEIGHT;
+        if (ballX >= bx && ballX <= bx + BRICK_WIDTH && ballY >= by && ballY <= by + BRICK_HEIGHT) {
+          bricks[r][c] = false;
+          ballVelY = -ballVelY;
+          bouncesSinceBrick = 0;
         }
       }
     }
-    if (allGone) {
-      gameState = WIN;
-      endTime = millis() + 2000;
-    }
+  }
 
-    // Draw everything
-    display.clearDisplay();
-    display.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
-    for (int r = 0; r < BRICK_ROWS; r++) {
-      for (int c = 0; c < BRICK_COLS; c++) {
-        if (bricks[r][c]) {
-          display.fillRect(brick_start_x + c * BRICK_WIDTH + 1, brick_start_y + r * BRICK_HEIGHT + 1, BRICK_WIDTH - 2, BRICK_HEIGHT - 2, SSD1306_WHITE);
-        }
+  // Check if ball is out (below paddle)
+  if (ballY > GAME_HEIGHT) {
+    gameState = LOSE;
+    endTime = millis() + 2000;
+  }
+
+  // Check if all bricks are gone
+  bool allGone = true;
+  for (int r = 0; r < BRICK_ROWS; r++) {
+    for (int c = 0; c < BRICK_COLS; c++) {
+      if (bricks[r][c]) {
+        allGone = false;
       }
     }
-    display.fillRect((int)paddleX, GAME_HEIGHT - PADDLE_HEIGHT, PADDLE_WIDTH, PADDLE_HEIGHT, SSD1306_WHITE);
-    display.fillRect(ballX, ballY, 4, 4, SSD1306_WHITE);
-    display.display();
+  }
+  if (allGone) {
+    gameState = WIN;
+    endTime = millis() + 2000;
+  }
 
-    if (bouncesSinceBrick > 34) {
-      gameState = LOSE;
-      endTime = millis() + 2000;
-    }
-  } else {
-    // Display WIN or LOSE
-    display.clearDisplay();
-    display.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
-    String msg = (gameState == WIN) ? "WIN" : "LOSE";
-    display.setTextSize(2);
-    display.setTextColor(SSD1306_WHITE);
-    int16_t x1, y1;
-    uint16_t w, h;
-    display.getTextBounds(msg, 0, 0, &x1, &y1, &w, &h);
-    int x = (GAME_WIDTH - w) / 2;
-    int y = (GAME_HEIGHT - h) / 2;
-    display.drawRoundRect(x - 5, y - 5, w + 10, h + 10, 5, SSD1306_WHITE);
-    display.setCursor(x, y);
-    display.print(msg);
-    display.display();
-    if (millis() > endTime) {
-      resetGame();
-    }
+  if (bouncesSinceBrick > 34) {
+    gameState = LOSE;
+    endTime = millis() + 2000;
   }
+}
 
-  delay(2);
+void loop() {
+  int steps = frameClock.steps();
+  for (int n = 0; n < steps; n++) step();
+  if (steps > 0) {
+    canvas.fillScreen(SSD1306_BLACK);
+    if (gameState == PLAYING) {
+      drawGame(canvas);
+    } else {
+      drawResult(canvas);
+    }
+    canvas.present(bus);
+#if PORTRAIT_BENCH
+    static int frameCount = 0;
+    if (++frameCount % 200 == 0) benchFrame();
+#endif
+  }
+  frameClock.sleep();
 }
\ No newline at end of file
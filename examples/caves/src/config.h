@@ -7,6 +7,14 @@
 #define BUTTON_PIN 5 // D3
 #define BUTTON_TAP_TIME 20
 
+// print dirty-flush byte counts over serial every 100 frames
+#define FLUSH_STATS 0
+
+// endless vertical flythrough instead of one dungeon per screen; scrolls
+// with the panel's start line register and sends one page per step
+#define CAVE_FLYER 0
+#define FLYER_STEP_MS 30
+
 // globals
 #include <Adafruit_SSD1306.h>
 extern Adafruit_SSD1306 display;
\ No newline at end of file
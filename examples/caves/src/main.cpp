@@ -5,8 +5,14 @@
 #include <algorithm>
 #include <cstring>
 #include "config.h"
+#include "ssd1306_bus.h"
+#include "dirty_flush.h"
+#include "cell_canvas.h"
+#include "scroll_viewport.h"
 
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+WireBus bus(Wire);
+DirtyFlush flusher(bus); // sends only the spans that changed since the last frame
 
 // Dungeon dimensions
 #define DUNGEON_WIDTH 64
@@ -18,6 +24,8 @@ Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
 #define CELL_FLOOR 1
 #define CELL_CORRIDOR 2
 
+CellCanvas cells(DUNGEON_WIDTH, DUNGEON_HEIGHT, CELL_SIZE); // one bit per dungeon cell
+
 // Structures for dungeon generation
 struct Room {
   int x, y, w, h;
@@ -46,6 +54,15 @@ void createRoom(int x, int y, int w, int h) {
   rooms.push_back({x, y, w, h});
 }
 
+// Wall cell adjacent to floor or corridor
+bool isPerimeter(int x, int y) {
+  if (dungeon[y][x] != CELL_WALL) return false;
+  return (x > 0 && dungeon[y][x-1] != CELL_WALL) ||
+         (x < DUNGEON_WIDTH-1 && dungeon[y][x+1] != CELL_WALL) ||
+         (y > 0 && dungeon[y-1][x] != CELL_WALL) ||
+         (y < DUNGEON_HEIGHT-1 && dungeon[y+1][x] != CELL_WALL);
+}
+
 // Trace the perimeter of all dungeon features as a single continuous line
 void tracePerimeter() {
   drawQueue.clear();
@@ -54,19 +71,8 @@ void tracePerimeter() {
   std::vector<std::pair<int, int>> perimeter;
   for (int y = 0; y < DUNGEON_HEIGHT; y++) {
     for (int x = 0; x < DUNGEON_WIDTH; x++) {
-      if (dungeon[y][x] == CELL_WALL) {
-        // Check if adjacent to floor or corridor
-        bool isPerimeter = false;
-        if ((x > 0 && dungeon[y][x-1] != CELL_WALL) ||
-            (x < DUNGEON_WIDTH-1 && dungeon[y][x+1] != CELL_WALL) ||
-            (y > 0 && dungeon[y-1][x] != CELL_WALL) ||
-            (y < DUNGEON_HEIGHT-1 && dungeon[y+1][x] != CELL_WALL)) {
-          isPerimeter = true;
-        }
-        
-        if (isPerimeter) {
-          perimeter.push_back(std::make_pair(x, y));
-        }
+      if (isPerimeter(x, y)) {
+        perimeter.push_back(std::make_pair(x, y));
       }
     }
   }
@@ -135,8 +141,9 @@ void createCorridor(int x1, int y1, int x2, int y2) {
   }
 }
 
-// Generate a complete dungeon level
-void generateDungeon() {
+// Generate a complete dungeon level; the flyer skips the perimeter trace
+// since it draws row by row
+void generateDungeon(bool trace = true) {
   initDungeon();
 
   // Generate rooms
@@ -176,12 +183,66 @@ void generateDungeon() {
   }
   
   // Trace the complete perimeter as a single continuous line
-  tracePerimeter();
+  if (trace) tracePerimeter();
+}
+
+void present() {
+  flusher.flush(display.getBuffer());
+#if FLUSH_STATS
+  if (flusher.frames() % 100 == 0) flusher.printStats(Serial);
+#endif
+}
+
+#if CAVE_FLYER
+// Endless flythrough: dungeons are stacked vertically and scroll up one
+// pixel row per step. The panel is moved with the start line register, so
+// each step only sends the page holding the new bottom row.
+ScrollViewport viewport(display, bus);
+int flyerExitX = DUNGEON_WIDTH / 2; // corridor column leading into the next dungeon
+int flyerRow = DUNGEON_HEIGHT * CELL_SIZE; // pixel row of the current dungeon to scroll in next
+#if FLUSH_STATS
+uint32_t fullRedrawBytes = 0;
+#endif
+
+// Generate the next dungeon, joined to the previous one through a corridor
+// from the top edge and leaving one through the bottom edge
+void nextFlyerDungeon() {
+  generateDungeon(false);
+  Room first = rooms.front();
+  Room last = rooms.back();
+  createCorridor(first.x + first.w / 2, first.y + first.h / 2, flyerExitX, 0);
+  flyerExitX = random(2, DUNGEON_WIDTH - 2);
+  createCorridor(last.x + last.w / 2, last.y + last.h / 2, flyerExitX, DUNGEON_HEIGHT - 1);
 }
 
+void flyerStep() {
+  viewport.scroll(1);
+  if (flyerRow >= DUNGEON_HEIGHT * CELL_SIZE) {
+    nextFlyerDungeon();
+    flyerRow = 0;
+  }
+  int y = flyerRow / CELL_SIZE;
+  for (int x = 0; x < DUNGEON_WIDTH; x++) {
+    if (isPerimeter(x, y)) {
+      viewport.drawFastHLine(x * CELL_SIZE, SCREEN_HEIGHT - 1, CELL_SIZE, SSD1306_WHITE);
+    }
+  }
+  flyerRow++;
+  viewport.present();
+
+#if FLUSH_STATS
+  static uint32_t steps = 0;
+  if (++steps % 100 == 0) {
+    Serial.printf("flyer: %lu B/frame scrolled, %lu B/frame full redraw\n",
+                  (unsigned long)(bus.bytesSent() / steps), (unsigned long)fullRedrawBytes);
+  }
+#endif
+}
+#endif
+
 // Draw the dungeon progressively as a continuous line, then complete any missed edges
 void progressiveDraw(unsigned long drawTime) {
-  display.clearDisplay();
+  cells.fillScreen(SSD1306_BLACK);
   
   unsigned long startTime = millis();
   int itemsDrawn = 0;
@@ -197,11 +258,12 @@ void progressiveDraw(unsigned long drawTime) {
     while (itemsDrawn < itemsShouldBe) {
       int x = drawQueue[itemsDrawn].first;
       int y = drawQueue[itemsDrawn].second;
-      display.fillRect(x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE, SSD1306_WHITE);
+      cells.drawPixel(x, y, SSD1306_WHITE);
       itemsDrawn++;
     }
     
-    display.display();
+    cells.blit(display.getBuffer());
+    present();
     delay(10);
   }
 }
@@ -209,12 +271,33 @@ void progressiveDraw(unsigned long drawTime) {
 void setup() {
   Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
   display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  bus.begin();
+#if FLUSH_STATS
+  Serial.begin(115200);
+#endif
   display.clearDisplay();
-  display.display();
+  present();
   randomSeed(analogRead(0));
+#if CAVE_FLYER
+#if FLUSH_STATS
+  // price of sending the whole frame, for comparison
+  CountingBus fullRedraw;
+  fullRedraw.writeWindow(0, SCREEN_WIDTH - 1, 0, SCREEN_HEIGHT / 8 - 1, display.getBuffer(), SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+  fullRedrawBytes = fullRedraw.bytesSent();
+#endif
+  viewport.reset();
+  viewport.present();
+  bus.resetCounters();
+#endif
 }
 
 void loop() {
+#if CAVE_FLYER
+  flyerStep();
+  delay(FLYER_STEP_MS);
+  return;
+#endif
+
   generateDungeon();
   
   // Draw dungeon progressively over 5 seconds
@@ -225,6 +308,6 @@ void loop() {
   
   // Clear and start over
   display.clearDisplay();
-  display.display();
+  present();
   delay(500);
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+#define SCREEN_WIDTH 128 // OLED display width, in pixels
+#define SCREEN_HEIGHT 64 // OLED display height, in pixels
+#define OLED_SDA_PIN 7 // D5
+#define OLED_SCL_PIN 6 // D4
+
+// button config
+#define BUTTON_PIN 5 // D3
+#define BUTTON_TAP_TIME 20
+
+// label of the data partition holding the animation (see partitions.csv)
+#define ANIM_PARTITION "anim"
+
+// ms per frame; 0 uses the delay stored in the stream
+#define FRAME_DELAY_MS 0
+
+// print flush byte counts and decode time over serial every 100 frames
+#define FLUSH_STATS 0
+
+// globals
+#include <Adafruit_SSD1306.h>
+extern Adafruit_SSD1306 display;
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include <Wire.h>
+#include <Adafruit_GFX.h>
+#include "config.h"
+#include "ssd1306_bus.h"
+#include "dirty_flush.h"
+#include "anim_stream.h"
+
+Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+WireBus bus(Wire);
+DirtyFlush flusher(bus); // sends only the spans that changed since the last frame
+AnimSource source; // the anim partition, memory-mapped
+AnimPlayer player; // decodes straight from the mapping into display's buffer
+
+bool paused = false;
+bool lastButton = HIGH;
+unsigned long lastButtonChange = 0;
+unsigned long nextFrameAt = 0;
+
+void showMissing() {
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+  display.setCursor(0, 20);
+  display.println("No animation in the");
+  display.print("'" ANIM_PARTITION "' partition");
+  flusher.flush(display.getBuffer());
+}
+
+// Tap to pause and resume.
+void handleButton() {
+  bool state = digitalRead(BUTTON_PIN);
+  if (state != lastButton && millis() - lastButtonChange > BUTTON_TAP_TIME) {
+    lastButtonChange = millis();
+    if (state == LOW) paused = !paused;
+    lastButton = state;
+  }
+}
+
+void setup() {
+  Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
+  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  bus.begin();
+#if FLUSH_STATS
+  Serial.begin(115200);
+#endif
+  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  display.clearDisplay();
+
+  if (!source.open(ANIM_PARTITION) || !player.begin(source.data(), source.size())) {
+    showMissing();
+    return;
+  }
+  nextFrameAt = millis();
+}
+
+void loop() {
+  if (!player.valid()) {
+    delay(1000);
+    return;
+  }
+  handleButton();
+  if (paused || (long)(millis() - nextFrameAt) < 0) {
+    delay(1);
+    return;
+  }
+
+#if FLUSH_STATS
+  uint32_t start = micros();
+#endif
+  if (!player.next(display.getBuffer())) {
+    // Corrupt stream: start over from black.
+    player.rewind();
+    display.clearDisplay();
+    return;
+  }
+#if FLUSH_STATS
+  uint32_t decoded = micros() - start;
+#endif
+  flusher.flush(display.getBuffer());
+#if FLUSH_STATS
+  if (flusher.frames() % 100 == 0) {
+    flusher.printStats(Serial);
+    Serial.printf("frame %u of %u decoded in %u us\n", player.frameIndex(), player.frames(), (unsigned)decoded);
+  }
+#endif
+
+  unsigned long frameDelay = FRAME_DELAY_MS ? FRAME_DELAY_MS : player.delayMs();
+  nextFrameAt += frameDelay;
+  // Don't try to catch up after a pause or a slow flush.
+  if ((long)(millis() - nextFrameAt) > (long)frameDelay) nextFrameAt = millis();
+}
@@ -7,6 +7,25 @@
 #define BUTTON_PIN 5 // D3
 #define BUTTON_TAP_TIME 200
 
+// temporal greyscale: the cloud is shaded in 2^GREY_BITS levels by a refresh
+// task that cycles bit-planes GREY_CYCLE_HZ times a second (falls back to
+// fewer levels, then a dither, while the bus can't keep up, and steps back
+// up once it can); 0 draws the checkerboard glow
+#define GREYSCALE 1
+#define GREY_BITS 2
+#define GREY_CYCLE_HZ 30
+#define GREY_I2C_CLOCK 400000
+#define GREY_STATS 0 // print required vs achieved slot rate (governor only without GREYSCALE) every 2 s
+
+// with GREYSCALE 0: ordered-dither matrix for the glow (kBayer4, kBayer8,
+// kBlueNoise), and the temperature grid dithered over the scene
+#define DITHER_MATRIX DitherMatrix::kBayer8
+#define TGRID_OVERLAY 0
+
+// simulate between 12 and 32 particles to hold a frame every 30 ms,
+// logging each change over serial; 0 keeps 24
+#define QUALITY_GOVERNOR 1
+
 // globals
 #include <Adafruit_SSD1306.h>
 extern Adafruit_SSD1306 display;
\ No newline at end of file
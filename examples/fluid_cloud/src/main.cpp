@@ -1,9 +1,11 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include <Wire.h>
-
-#define SCREEN_WIDTH 128
-#define SCREEN_HEIGHT 64
+#include "config.h"
+#include "dirty_flush.h"
+#include "field_dither.h"
+#include "grey_panel.h"
+#include "quality_governor.h"
 
 #define SDA_PIN 7
 #define SCL_PIN 6
@@ -11,6 +13,11 @@
 
 #define OLED_RESET    -1
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+#if GREYSCALE
+WireBus bus(Wire, 0x3C, GREY_I2C_CLOCK);
+DirtyFlush flusher(bus);
+GreyPanel grey(flusher, GREY_BITS, GREY_CYCLE_HZ); // owns the panel once started
+#endif
 
 const int MAX_PARTICLES = 32;
 struct Particle {
@@ -21,7 +28,16 @@ struct Particle {
   float temp;
 };
 Particle P[MAX_PARTICLES];
-int particleCount = 24;
+
+// Particles simulated per quality level, cheapest first; the pairwise
+// forces make the step quadratic in the count. All MAX_PARTICLES are
+// seeded, and particles past particleCount rejoin where they were left.
+const int kParticleCounts[] = {12, 16, 20, 24, MAX_PARTICLES};
+const uint8_t kQualityLevels = sizeof(kParticleCounts) / sizeof(kParticleCounts[0]);
+const uint8_t kDefaultLevel = 3;
+const unsigned long DRAW_MS = 30;
+QualityGovernor governor(DRAW_MS * 1000, kQualityLevels, kDefaultLevel);
+int particleCount = kParticleCounts[kDefaultLevel];
 
 const float G = 40.0f;
 const float K_BOUY = 170.0f;
@@ -47,7 +63,7 @@ uint8_t pixelBuf[(SCREEN_WIDTH * SCREEN_HEIGHT) / 8];
 inline int tg_idx(int gx, int gy){ return gy * TG_W + gx; }
 
 void seedParticles(){
-  for (int i=0;i<particleCount;i++){
+  for (int i=0;i<MAX_PARTICLES;i++){
     float rx = random(10, SCREEN_WIDTH - 10);
     float ry = random(SCREEN_HEIGHT/2, SCREEN_HEIGHT - 5);
     float rr = random(5, 12);
@@ -186,7 +202,6 @@ void physicsStep(){
 
 // Render metaballs to display
 void renderMetaballs(){
-  display.clearDisplay();
   static float field[SCREEN_WIDTH * SCREEN_HEIGHT];
   int W = SCREEN_WIDTH, H = SCREEN_HEIGHT;
   int WH = W * H;
@@ -212,18 +227,29 @@ void renderMetaballs(){
   }
 
   float glowThresh = THRESHOLD * 0.4f;
+#if GREYSCALE
+  // full brightness inside the iso-line, glow ramping down to glowThresh
+  int top = grey.maxLevel();
+  float glowScale = (top - 1) / (THRESHOLD - glowThresh);
   for (int y=0;y<H;y++){
     for (int x=0;x<W;x++){
       float v = field[y*W + x];
-      if (v >= THRESHOLD){
-        display.drawPixel(x,y,SSD1306_WHITE);
-      } else if (v >= glowThresh){
-        if (((x ^ y) & 1) == 0) display.drawPixel(x,y,SSD1306_WHITE);
-      }
+      int level = 0;
+      if (v >= THRESHOLD) level = top;
+      else if (v >= glowThresh) level = 1 + (int)((v - glowThresh) * glowScale);
+      grey.drawPixel(x, y, level);
     }
   }
-
-  display.display();
+  grey.commit();
+#else
+  // solid inside the iso-line, glow dithered down to glowThresh; packed
+  // straight into the page buffer, overwriting the last frame
+  uint8_t* frame = display.getBuffer();
+  ditherField(frame, field, W, H, glowThresh, THRESHOLD, DITHER_MATRIX);
+#if TGRID_OVERLAY
+  ditherCells(frame, tgrid, TG_W, TG_H, T_AMBIENT, T_BOTTOM, DitherMatrix::kBayer4, true);
+#endif
+#endif
 }
 
 unsigned long lastSim = 0;
@@ -242,6 +268,13 @@ void setup() {
   }
   display.clearDisplay();
   display.setRotation(0);
+#if GREYSCALE
+  bus.begin(); // after display.begin(), which sets its own clock
+  if (!grey.begin()) Serial.println(F("greyscale planes allocation failed"));
+#endif
+#if QUALITY_GOVERNOR
+  governor.setLog(&Serial);
+#endif
   initTGrid();
   seedParticles();
 
@@ -264,16 +297,45 @@ void loop(){
     lastButtonCheck = now;
   }
   
-  if (now - lastSim >= (unsigned long)(DT * 1000.0f)) {
-    updateTempGrid();
-    physicsStep();
-    lastSim = now;
-  }
-  if (now - lastDraw >= 30) {
+  // Each frame runs the simulation steps owed since the last one, so the
+  // governor sees the whole cost of a frame; a frame that ran long owes
+  // no more than four.
+  if (now - lastDraw >= DRAW_MS) {
+    const unsigned long simMs = (unsigned long)(DT * 1000.0f);
+    governor.begin();
+    for (int n = 0; now - lastSim >= simMs; n++) {
+      if (n == 4) {
+        lastSim = now;
+        break;
+      }
+      updateTempGrid();
+      physicsStep();
+      lastSim += simMs;
+    }
+    governor.updated();
     renderMetaballs();
+    governor.rendered();
+#if !GREYSCALE
+    display.display();
+#endif
+#if QUALITY_GOVERNOR
+    if (governor.flushed()) particleCount = kParticleCounts[governor.level()];
+#endif
     lastDraw = now;
   }
 
+#if GREY_STATS
+  static unsigned long lastStats = 0;
+  if (now - lastStats >= 2000) {
+#if GREYSCALE
+    grey.printStats(Serial);
+    flusher.printStats(Serial);
+#endif
+    governor.printStats(Serial);
+    lastStats = now;
+  }
+#endif
+
   if (random(0,1000) < 2){
     int cellx = random(0, TG_W);
     int celly = TG_H-1 - random(0,2);
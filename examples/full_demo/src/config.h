@@ -7,6 +7,33 @@
 #define BUTTON_PIN 5 // D3
 #define BUTTON_TAP_TIME 20
 
+// print flush byte counts and async wait/send times over serial every 100 frames
+#define FLUSH_STATS 0
+
+// flush through the ESP-IDF I2C driver, one driver submission per frame
+// instead of Wire's transaction per window and data chunk; display stays on Wire
+#define I2C_BATCHED 0
+#define I2C_CLOCK 1000000 // Hz, fast-mode plus; set on port 0, so Wire runs at it too
+
+// mirror every presented frame to tools/mirror_view over serial as
+// delta + RLE packets; frames the link has no room for are dropped
+#define SERIAL_MIRROR 0
+#define MIRROR_BAUD 115200 // matches monitor_speed
+#define MIRROR_KEYFRAME 60 // packets between keyframes
+
+// badge composited over every scene: 0 off, 1 frames per second, 2 uptime
+#define BADGE 0
+
+// blend between scenes when the mode changes instead of cutting: 0 off,
+// 1 dissolve, 2 horizontal wipe, 3 vertical wipe, 4 iris, 5 cycle through all
+#define TRANSITION 5
+#define TRANSITION_FRAMES 24 // presented frames per transition
+
+// step the lava and morph grids between 8 and 3 px and thin the boids and
+// stars to a quarter to hold each scene's step rate, logging each change
+// over serial; 0 keeps the compiled-in quality
+#define QUALITY_GOVERNOR 1
+
 // globals
 #include <Adafruit_SSD1306.h>
 extern Adafruit_SSD1306 display;
\ No newline at end of file
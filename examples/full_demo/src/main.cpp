@@ -5,113 +5,272 @@
 #include <set>
 #include <Arduino.h>
 #include "config.h"
+#include "ssd1306_bus.h"
+#include "idf_bus.h"
+#include "dirty_flush.h"
+#include "async_flush.h"
+#include "page_line.h"
+#include "compositor.h"
+#include "transition.h"
+#include "serial_mirror.h"
+#include "frame_clock.h"
+#include "coop_task.h"
+#include "button_input.h"
+#include "quality_governor.h"
+#include "scene.h"
 
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+#if I2C_BATCHED
+IdfBus bus(0, 0x3C, I2C_CLOCK); // shares port 0 with Wire
+#else
+WireBus bus(Wire);
+#endif
+DirtyFlush flusher(bus);
+AsyncFlush frames(flusher); // sends frame N in the background while frame N+1 renders
+#if BADGE
+Compositor layers;
+Overlay badge; // corner badge composited over every scene
+uint32_t composed[kFrameBytes / 4]; // scene plus badge; the scene buffer is left untouched
+#endif
+#if TRANSITION
+Transition transition; // outgoing scene blended into the incoming one after a mode change
+const uint8_t* shownScene = nullptr; // last scene frame presented, before the badge
+#endif
+#if SERIAL_MIRROR
+SerialMirror mirror(Serial, MIRROR_BAUD, 2 * kMirrorMaxPacket, MIRROR_KEYFRAME);
+#endif
 
 enum Mode { SNAKE, BRICK_BREAK, LAVA_LAMP, BOIDS, CAVES, MORPH, STARFIELD };
+// Step and quality levels are set from each scene as it is entered.
+FrameClock frameClock(25000);
+QualityGovernor governor(25000, 1, 0);
 Mode currentMode = SNAKE;
+Scene* scene = nullptr; // the current mode, in liveArena below
 unsigned long modeStartTime = 0;
 const unsigned long MODE_DURATION = 120000; // 2 minutes
 bool autoPlayEnabled = true; // Start with auto-play on
-unsigned long buttonPressStartTime = 0;
-bool buttonWasPressed = false;
+// Tap for the next scene, hold 3 seconds to toggle auto-play
+ButtonInput button(BUTTON_PIN, BUTTON_TAP_TIME, 3000);
 
-// Snake variables
-typedef std::pair<int, int> Pos;
-enum Dir { UP, DOWN, LEFT, RIGHT };
-std::vector<Pos> snake;
-Pos food;
-Dir dir = RIGHT;
-int score = 0;
-bool gameOver = false;
-
-Pos moveHead_snake(Dir d) {
-  Pos h = snake[0];
-  if (d == UP) return {h.first, h.second - 1};
-  if (d == DOWN) return {h.first, h.second + 1};
-  if (d == LEFT) return {h.first - 1, h.second};
-  if (d == RIGHT) return {h.first + 1, h.second};
-  return h;
+#if BADGE
+// Redraw the badge only when its text or the scene's rotation changes.
+void updateBadge() {
+  char text[8];
+  unsigned long now = millis();
+#if BADGE == 1
+  static uint32_t presented = 0;
+  static unsigned long windowStart = 0;
+  static unsigned fps = 0;
+  presented++;
+  if (now - windowStart >= 1000) {
+    fps = presented * 1000 / (now - windowStart);
+    presented = 0;
+    windowStart = now;
+  }
+  snprintf(text, sizeof(text), "%ufps", fps);
+#else
+  unsigned long seconds = now / 1000;
+  snprintf(text, sizeof(text), "%02lu:%02lu", seconds / 60 % 100, seconds % 60);
+#endif
+
+  static char shown[8] = "";
+  static uint8_t shownRotation = 0xFF;
+  if (strcmp(text, shown) == 0 && display.getRotation() == shownRotation) return;
+  strcpy(shown, text);
+  shownRotation = display.getRotation();
+
+  badge.clear();
+  badge.setRotation(shownRotation);
+  int16_t w = strlen(text) * 6 - 1;
+  badge.fillRect(badge.width() - w - 2, 0, w + 2, 9, SSD1306_BLACK);
+  badge.setTextSize(1);
+  badge.setTextColor(SSD1306_WHITE);
+  badge.setCursor(badge.width() - w - 1, 1);
+  badge.print(text);
 }
+#endif
 
-bool isValidMove_snake(Pos p) {
-  if (p.first < 0 || p.first >= 32 || p.second < 0 || p.second >= 16) return false;
-  for (auto s : snake) if (s == p) return false;
-  return true;
+void present() {
+  const uint8_t* scene = display.getBuffer();
+#if TRANSITION
+  scene = transition.apply(scene);
+  shownScene = scene;
+#endif
+#if BADGE
+  updateBadge();
+  layers.compose(scene, reinterpret_cast<uint8_t*>(composed));
+  scene = reinterpret_cast<uint8_t*>(composed);
+#endif
+#if SERIAL_MIRROR
+  mirror.present(scene);
+#endif
+  frames.present(scene);
+#if FLUSH_STATS
+  static uint32_t presented = 0;
+  if (++presented % 100 == 0) {
+    flusher.printStats(Serial);
+    frameClock.printStats(Serial);
+    governor.printStats(Serial);
+    button.printStats(Serial);
+    Serial.printf("async: waited %u us, last send %u us, %lu frames unchanged\n", (unsigned)frames.lastWaitMicros(),
+                  (unsigned)frames.lastSendMicros(), (unsigned long)frames.skipped());
+  }
+#endif
 }
 
-Pos randomFree_snake() {
-  std::vector<Pos> free;
-  for (int x = 0; x < 32; x++) {
-    for (int y = 0; y < 16; y++) {
-      bool occupied = false;
-      for (auto p : snake) if (p.first == x && p.second == y) occupied = true;
-      if (!occupied) free.push_back({x, y});
+// Each mode is a Scene whose state is its members. Only the current one
+// and the one staged after it exist, in two arenas, so the modes share RAM
+// instead of each keeping its state for the whole run, and a scene is set
+// up just before it is shown rather than all of them in setup(). The
+// static_assert after each class caps its footprint in bytes; 64-bit
+// hosts, with wider pointers, come closest to the caps.
+
+// Snake
+typedef std::pair<int, int> Pos;
+enum Dir { UP, DOWN, LEFT, RIGHT };
+
+// Plays itself on a 32x16 board of 4 px cells, steering by a breadth-first
+// search for the food. A lost game holds for a second and starts over.
+class SnakeScene : public Scene {
+ public:
+  SnakeScene() : Scene("snake", 25000) {}
+
+  bool prepare(uint32_t) override {
+    reset();
+    return true;
+  }
+
+  void update() override {
+    if (_gameOver) {
+      if (millis() - _overAt >= 1000) reset();
+      return;
+    }
+    Dir nextd = nextDir();
+    _dir = nextd;
+    Pos nh = moveHead(_dir);
+    if (!isValidMove(nh)) {
+      gameOver();
+      return;
+    }
+    int grown = _length < kMaxLength ? _length + 1 : _length;
+    for (int i = grown - 1; i > 0; i--) _body[i] = _body[i - 1];
+    _body[0] = nh;
+    _length = grown;
+    if (nh == _food) {
+      _score++;
+      _food = randomFree();
+      if (_food.first == -1) gameOver();
+    } else {
+      _length--;
     }
   }
-  if (free.empty()) return {-1, -1};
-  return free[random(free.size())];
-}
 
-Dir getNextDir_snake() {
-  std::queue<std::pair<Pos, std::vector<Dir>>> q;
-  std::set<Pos> visited;
-  q.push({snake[0], {}});
-  visited.insert(snake[0]);
-  while (!q.empty()) {
-    auto front = q.front(); q.pop();
-    Pos curr = front.first;
-    std::vector<Dir> path = front.second;
-    if (curr == food) {
-      if (path.empty()) return dir;
-      return path[0];
+  void render() override {
+    display.clearDisplay();
+    for (int i = 0; i < _length; i++) {
+      display.fillRect(_body[i].first * 4, _body[i].second * 4, 4, 4, SSD1306_WHITE);
     }
-    std::vector<std::pair<Pos, Dir>> nexts = {
-      {{curr.first, curr.second - 1}, UP},
-      {{curr.first, curr.second + 1}, DOWN},
-      {{curr.first - 1, curr.second}, LEFT},
-      {{curr.first + 1, curr.second}, RIGHT}
-    };
-    for (auto [n, d] : nexts) {
-      if (n.first >= 0 && n.first < 32 && n.second >= 0 && n.second < 16 && visited.find(n) == visited.end()) {
-        bool obs = false;
-        for (auto p : snake) if (p == n) obs = true;
-        if (!obs) {
-          std::vector<Dir> newpath = path;
-          newpath.push_back(d);
-          q.push({n, newpath});
-          visited.insert(n);
-        }
+    display.fillRect(_food.first * 4, _food.second * 4, 4, 4, SSD1306_WHITE);
+  }
+
+ private:
+  static const int kCols = 32;
+  static const int kRows = 16;
+  static const int kMaxLength = kCols * kRows;
+
+  void reset() {
+    _length = 0;
+    _body[_length++] = {16, 8};
+    _dir = RIGHT;
+    _food = randomFree();
+    _score = 1;
+    _gameOver = false;
+  }
+
+  void gameOver() {
+    _gameOver = true;
+    _overAt = millis();
+  }
+
+  bool occupied(Pos p) const {
+    for (int i = 0; i < _length; i++) if (_body[i] == p) return true;
+    return false;
+  }
+
+  Pos moveHead(Dir d) const {
+    Pos h = _body[0];
+    if (d == UP) return {h.first, h.second - 1};
+    if (d == DOWN) return {h.first, h.second + 1};
+    if (d == LEFT) return {h.first - 1, h.second};
+    if (d == RIGHT) return {h.first + 1, h.second};
+    return h;
+  }
+
+  bool isValidMove(Pos p) const {
+    if (p.first < 0 || p.first >= kCols || p.second < 0 || p.second >= kRows) return false;
+    return !occupied(p);
+  }
+
+  Pos randomFree() const {
+    std::vector<Pos> free;
+    for (int x = 0; x < kCols; x++) {
+      for (int y = 0; y < kRows; y++) {
+        if (!occupied({x, y})) free.push_back({x, y});
       }
     }
+    if (free.empty()) return {-1, -1};
+    return free[random(free.size())];
   }
-  std::vector<Dir> possibles = {UP, DOWN, LEFT, RIGHT};
-  for (auto d : possibles) {
-    Pos nh = moveHead_snake(d);
-    if (isValidMove_snake(nh)) return d;
-  }
-  return dir;
-}
 
-void draw_snake() {
-  display.clearDisplay();
-  for (auto p : snake) {
-    display.fillRect(p.first * 4, p.second * 4, 4, 4, SSD1306_WHITE);
+  Dir nextDir() const {
+    std::queue<std::pair<Pos, std::vector<Dir>>> q;
+    std::set<Pos> visited;
+    q.push({_body[0], {}});
+    visited.insert(_body[0]);
+    while (!q.empty()) {
+      auto front = q.front(); q.pop();
+      Pos curr = front.first;
+      std::vector<Dir> path = front.second;
+      if (curr == _food) {
+        if (path.empty()) return _dir;
+        return path[0];
+      }
+      std::vector<std::pair<Pos, Dir>> nexts = {
+        {{curr.first, curr.second - 1}, UP},
+        {{curr.first, curr.second + 1}, DOWN},
+        {{curr.first - 1, curr.second}, LEFT},
+        {{curr.first + 1, curr.second}, RIGHT}
+      };
+      for (auto [n, d] : nexts) {
+        if (n.first >= 0 && n.first < kCols && n.second >= 0 && n.second < kRows && visited.find(n) == visited.end()) {
+          if (!occupied(n)) {
+            std::vector<Dir> newpath = path;
+            newpath.push_back(d);
+            q.push({n, newpath});
+            visited.insert(n);
+          }
+        }
+      }
+    }
+    std::vector<Dir> possibles = {UP, DOWN, LEFT, RIGHT};
+    for (auto d : possibles) {
+      Pos nh = moveHead(d);
+      if (isValidMove(nh)) return d;
+    }
+    return _dir;
   }
-  display.fillRect(food.first * 4, food.second * 4, 4, 4, SSD1306_WHITE);
-  display.display();
-}
 
-void reset_snake() {
-  snake.clear();
-  snake.push_back({16, 8});
-  dir = RIGHT;
-  food = randomFree_snake();
-  score = 1;
-  gameOver = false;
-}
+  Pos _body[kMaxLength]; // head first
+  int _length = 0;
+  Pos _food;
+  Dir _dir = RIGHT;
+  int _score = 0;
+  bool _gameOver = false;
+  unsigned long _overAt = 0;
+};
+static_assert(sizeof(SnakeScene) <= 4160, "snake: the body can fill the 512-cell board");
 
-// Brick Break variables
+// Brick Break
 #define BRICK_ROWS 4
 #define BRICK_COLS 4
 #define BRICK_WIDTH 15
@@ -120,36 +279,149 @@ void reset_snake() {
 #define PADDLE_HEIGHT 4
 #define GAME_WIDTH 64
 #define GAME_HEIGHT 128
-bool bricks[BRICK_ROWS][BRICK_COLS];
-float ballX, ballY, ballVelX, ballVelY;
-float paddleX;
-enum GameState { PLAYING, WIN, LOSE };
-GameState gameState = PLAYING;
-unsigned long endTime;
-int bouncesSinceBrick = 0;
-const int brick_draw_width = BRICK_WIDTH - 2;
-const int brick_gap = 2;
-const int total_brick_width = BRICK_COLS * brick_draw_width + (BRICK_COLS - 1) * brick_gap;
-const int brick_start_x = 2;
-const int brick_start_y = 2;
-
-void resetGame_brick() {
-  for (int r = 0; r < BRICK_ROWS; r++) {
-    for (int c = 0; c < BRICK_COLS; c++) {
-      bricks[r][c] = true;
+
+// Played in portrait: the display is rotated while the scene is current.
+class BrickScene : public Scene {
+ public:
+  BrickScene() : Scene("brick", 10000) {}
+
+  bool prepare(uint32_t) override {
+    reset();
+    return true;
+  }
+
+  void enter() override { display.setRotation(1); }
+
+  void exit() override { display.setRotation(0); }
+
+  void update() override {
+    if (_gameState != PLAYING) {
+      if (millis() > _endTime) {
+        reset();
+      }
+      return;
+    }
+
+    float targetX = _ballX - PADDLE_WIDTH / 2.0 + random(-2, 3);
+    targetX = constrain(targetX, 4, GAME_WIDTH - PADDLE_WIDTH - 4);
+    _paddleX = _paddleX * 0.7 + targetX * 0.3;
+    _paddleX = constrain(_paddleX, 4, GAME_WIDTH - PADDLE_WIDTH - 4);
+    _ballX += _ballVelX;
+    _ballY += _ballVelY;
+    if (_ballX <= 0 || _ballX >= GAME_WIDTH - 4) {
+      _ballVelX = -_ballVelX;
+      _bouncesSinceBrick++;
+    }
+    if (_ballY <= 0) {
+      _ballVelY = -_ballVelY;
+      _bouncesSinceBrick++;
+    }
+    if (_ballY + 4 >= GAME_HEIGHT - PADDLE_HEIGHT && _ballY <= GAME_HEIGHT && _ballX + 4 >= _paddleX && _ballX <= _paddleX + PADDLE_WIDTH) {
+      float hitPos = (_ballX - _paddleX) / PADDLE_WIDTH;
+      _ballVelX = (hitPos - 0.5) * 3.0;
+      _ballVelX += random(-1, 2);
+      if (abs(_ballVelX) < 1.4) {
+        _ballVelX = (_ballVelX > 0) ? 1.4 : -1.4;
+      }
+      _ballVelY = -abs(_ballVelY);
+      _bouncesSinceBrick++;
+    }
+    for (int r = 0; r < BRICK_ROWS; r++) {
+      for (int c = 0; c < BRICK_COLS; c++) {
+        if (_bricks[r][c]) {
+          int bx = kStartX + c * BRICK_WIDTH;
+          int by = kStartY + r * BRICK_HEIGHT;
+          if (_ballX >= bx && _ballX <= bx + BRICK_WIDTH && _ballY >= by && _ballY <= by + BRICK_HEIGHT) {
+            _bricks[r][c] = false;
+            _ballVelY = -_ballVelY;
+            _bouncesSinceBrick = 0;
+          }
+        }
+      }
+    }
+    if (_ballY > GAME_HEIGHT) {
+      _gameState = LOSE;
+      _endTime = millis() + 2000;
+    }
+    bool allGone = true;
+    for (int r = 0; r < BRICK_ROWS; r++) for (int c = 0; c < BRICK_COLS; c++) if (_bricks[r][c]) allGone = false;
+    if (allGone) {
+      _gameState = WIN;
+      _endTime = millis() + 2000;
+    }
+    if (_bouncesSinceBrick > 34) {
+      _gameState = LOSE;
+      _endTime = millis() + 2000;
     }
   }
-  ballX = random(10, GAME_WIDTH - 10);
-  ballY = GAME_HEIGHT - 20;
-  ballVelX = random(-2, 3);
-  if (ballVelX == 0) ballVelX = 1;
-  ballVelY = random(-3, -1);
-  paddleX = GAME_WIDTH / 2.0 - PADDLE_WIDTH / 2.0;
-  gameState = PLAYING;
-  bouncesSinceBrick = 0;
-}
 
-// Lava Lamp variables
+  void render() override {
+    display.clearDisplay();
+    display.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
+    if (_gameState == PLAYING) {
+      for (int r = 0; r < BRICK_ROWS; r++) {
+        for (int c = 0; c < BRICK_COLS; c++) {
+          if (_bricks[r][c]) {
+            display.fillRect(kStartX + c * BRICK_WIDTH + 1, kStartY + r * BRICK_HEIGHT + 1, BRICK_WIDTH - 2, BRICK_HEIGHT - 2, SSD1306_WHITE);
+          }
+        }
+      }
+      display.fillRect((int)_paddleX, GAME_HEIGHT - PADDLE_HEIGHT, PADDLE_WIDTH, PADDLE_HEIGHT, SSD1306_WHITE);
+      display.fillRect(_ballX, _ballY, 4, 4, SSD1306_WHITE);
+    } else {
+      String msg = (_gameState == WIN) ? "WIN" : "LOSE";
+      display.setTextSize(2);
+      display.setTextColor(SSD1306_WHITE);
+      int16_t x1, y1;
+      uint16_t w, h;
+      display.getTextBounds(msg, 0, 0, &x1, &y1, &w, &h);
+      int x = (GAME_WIDTH - w) / 2;
+      int y = (GAME_HEIGHT - h) / 2;
+      display.drawRoundRect(x - 5, y - 5, w + 10, h + 10, 5, SSD1306_WHITE);
+      display.setCursor(x, y);
+      display.print(msg);
+    }
+  }
+
+ private:
+  enum GameState { PLAYING, WIN, LOSE };
+  static const int kStartX = 2;
+  static const int kStartY = 2;
+
+  void reset() {
+    for (int r = 0; r < BRICK_ROWS; r++) {
+      for (int c = 0; c < BRICK_COLS; c++) {
+        _bricks[r][c] = true;
+      }
+    }
+    _ballX = random(10, GAME_WIDTH - 10);
+    _ballY = GAME_HEIGHT - 20;
+    _ballVelX = random(-2, 3);
+    if (_ballVelX == 0) _ballVelX = 1;
+    _ballVelY = random(-3, -1);
+    _paddleX = GAME_WIDTH / 2.0 - PADDLE_WIDTH / 2.0;
+    _gameState = PLAYING;
+    _bouncesSinceBrick = 0;
+  }
+
+  bool _bricks[BRICK_ROWS][BRICK_COLS];
+  float _ballX, _ballY, _ballVelX, _ballVelY;
+  float _paddleX;
+  GameState _gameState = PLAYING;
+  unsigned long _endTime = 0;
+  int _bouncesSinceBrick = 0;
+};
+static_assert(sizeof(BrickScene) <= 80, "brick: the wall, ball and paddle");
+
+// Marching-squares grid step per quality level, cheapest first, for lava
+// and morph; their field grids are sized for the finest.
+constexpr int kRenderSkips[] = {8, 6, 4, 3};
+constexpr int kRenderQualityLevels = sizeof(kRenderSkips) / sizeof(kRenderSkips[0]);
+constexpr int kMinRenderSkip = 3;
+constexpr int kMaxGridWidth = (SCREEN_WIDTH + kMinRenderSkip - 1) / kMinRenderSkip;
+constexpr int kMaxGridHeight = (SCREEN_HEIGHT + kMinRenderSkip - 1) / kMinRenderSkip;
+
+// Lava Lamp
 constexpr int kBallCount = 4;
 constexpr float kMinRadius = 9.0f;
 constexpr float kMaxRadius = 11.0f;
@@ -158,137 +430,150 @@ constexpr float kMaxSpeed = 1.0f;
 constexpr float kFieldThreshold = 0.45f;
 constexpr float kMinRadiusDrift = 0.005f;
 constexpr float kMaxRadiusDrift = 0.02f;
-constexpr unsigned long kFrameDelay = 0;
-struct Ball {
-  float x;
-  float y;
-  float vx;
-  float vy;
-  float radius;
-  float radiusDrift;
-};
-static Ball balls[kBallCount];
-static unsigned long lastFrameTime_lava = 0;
-static float fieldGrid[SCREEN_HEIGHT / 4][SCREEN_WIDTH / 4]; // adjusted for grid
 
-float randomFloat_lava(float minValue, float maxValue) {
+float randomFloat(float minValue, float maxValue) {
   float scale = static_cast<float>(random(1000)) / 1000.0f;
   return minValue + (maxValue - minValue) * scale;
 }
 
-void resetBalls_lava() {
-  for (int i = 0; i < kBallCount; ++i) {
-    balls[i].radius = randomFloat_lava(kMinRadius, kMaxRadius);
-    balls[i].x = randomFloat_lava(balls[i].radius, SCREEN_WIDTH - balls[i].radius);
-    balls[i].y = randomFloat_lava(balls[i].radius, SCREEN_HEIGHT - balls[i].radius);
-    balls[i].vx = randomFloat_lava(-kMaxSpeed, kMaxSpeed);
-    balls[i].vy = randomFloat_lava(-kMaxSpeed, kMaxSpeed);
-    if (fabs(balls[i].vx) < kMinSpeed) {
-      balls[i].vx = copysign(kMinSpeed, balls[i].vx == 0 ? 1 : balls[i].vx);
-    }
-    if (fabs(balls[i].vy) < kMinSpeed) {
-      balls[i].vy = copysign(kMinSpeed, balls[i].vy == 0 ? 1 : balls[i].vy);
+class LavaScene : public Scene {
+ public:
+  LavaScene() : Scene("lava", 33333) {}
+
+  bool prepare(uint32_t) override {
+    for (int i = 0; i < kBallCount; ++i) {
+      _balls[i].radius = randomFloat(kMinRadius, kMaxRadius);
+      _balls[i].x = randomFloat(_balls[i].radius, SCREEN_WIDTH - _balls[i].radius);
+      _balls[i].y = randomFloat(_balls[i].radius, SCREEN_HEIGHT - _balls[i].radius);
+      _balls[i].vx = randomFloat(-kMaxSpeed, kMaxSpeed);
+      _balls[i].vy = randomFloat(-kMaxSpeed, kMaxSpeed);
+      if (fabs(_balls[i].vx) < kMinSpeed) {
+        _balls[i].vx = copysign(kMinSpeed, _balls[i].vx == 0 ? 1 : _balls[i].vx);
+      }
+      if (fabs(_balls[i].vy) < kMinSpeed) {
+        _balls[i].vy = copysign(kMinSpeed, _balls[i].vy == 0 ? 1 : _balls[i].vy);
+      }
+      float drift = randomFloat(kMinRadiusDrift, kMaxRadiusDrift);
+      _balls[i].radiusDrift = (random(0, 2) == 0) ? drift : -drift;
     }
-    float drift = randomFloat_lava(kMinRadiusDrift, kMaxRadiusDrift);
-    balls[i].radiusDrift = (random(0, 2) == 0) ? drift : -drift;
+    return true;
   }
-}
 
-void updateBalls_lava() {
-  for (int i = 0; i < kBallCount; ++i) {
-    balls[i].x += balls[i].vx;
-    balls[i].y += balls[i].vy;
-    balls[i].radius += balls[i].radiusDrift;
-    if (balls[i].radius <= kMinRadius) {
-      balls[i].radius = kMinRadius;
-      balls[i].radiusDrift = randomFloat_lava(kMinRadiusDrift, kMaxRadiusDrift);
-    } else if (balls[i].radius >= kMaxRadius) {
-      balls[i].radius = kMaxRadius;
-      balls[i].radiusDrift = -randomFloat_lava(kMinRadiusDrift, kMaxRadiusDrift);
+  void update() override {
+    for (int i = 0; i < kBallCount; ++i) {
+      _balls[i].x += _balls[i].vx;
+      _balls[i].y += _balls[i].vy;
+      _balls[i].radius += _balls[i].radiusDrift;
+      if (_balls[i].radius <= kMinRadius) {
+        _balls[i].radius = kMinRadius;
+        _balls[i].radiusDrift = randomFloat(kMinRadiusDrift, kMaxRadiusDrift);
+      } else if (_balls[i].radius >= kMaxRadius) {
+        _balls[i].radius = kMaxRadius;
+        _balls[i].radiusDrift = -randomFloat(kMinRadiusDrift, kMaxRadiusDrift);
+      }
+      if (_balls[i].x - _balls[i].radius <= 0 || _balls[i].x + _balls[i].radius >= SCREEN_WIDTH) {
+        _balls[i].vx = -_balls[i].vx;
+        _balls[i].x = constrain(_balls[i].x, _balls[i].radius, SCREEN_WIDTH - _balls[i].radius);
+      }
+      if (_balls[i].y - _balls[i].radius <= 0 || _balls[i].y + _balls[i].radius >= SCREEN_HEIGHT) {
+        _balls[i].vy = -_balls[i].vy;
+        _balls[i].y = constrain(_balls[i].y, _balls[i].radius, SCREEN_HEIGHT - _balls[i].radius);
+      }
     }
-    if (balls[i].x - balls[i].radius <= 0 || balls[i].x + balls[i].radius >= SCREEN_WIDTH) {
-      balls[i].vx = -balls[i].vx;
-      balls[i].x = constrain(balls[i].x, balls[i].radius, SCREEN_WIDTH - balls[i].radius);
+  }
+
+  void render() override {
+    display.clearDisplay();
+    uint8_t* frame = display.getBuffer();
+    display.drawRoundRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 4, SSD1306_WHITE);
+    int kRenderSkip = _renderSkip;
+    int kGridWidth = (SCREEN_WIDTH + kRenderSkip - 1) / kRenderSkip;
+    int kGridHeight = (SCREEN_HEIGHT + kRenderSkip - 1) / kRenderSkip;
+    for (int gy = 0; gy < kGridHeight; ++gy) {
+      for (int gx = 0; gx < kGridWidth; ++gx) {
+        int sampleX = gx * kRenderSkip + kRenderSkip / 2;
+        int sampleY = gy * kRenderSkip + kRenderSkip / 2;
+        sampleX = min(sampleX, SCREEN_WIDTH - 1);
+        sampleY = min(sampleY, SCREEN_HEIGHT - 1);
+        _fieldGrid[gy][gx] = sampleFieldAt(sampleX, sampleY);
+      }
     }
-    if (balls[i].y - balls[i].radius <= 0 || balls[i].y + balls[i].radius >= SCREEN_HEIGHT) {
-      balls[i].vy = -balls[i].vy;
-      balls[i].y = constrain(balls[i].y, balls[i].radius, SCREEN_HEIGHT - balls[i].radius);
+    for (int gy = 0; gy < kGridHeight - 1; ++gy) {
+      for (int gx = 0; gx < kGridWidth - 1; ++gx) {
+        int cellX = gx * kRenderSkip + kRenderSkip / 2;
+        int cellY = gy * kRenderSkip + kRenderSkip / 2;
+        float tl = _fieldGrid[gy][gx];
+        float tr = _fieldGrid[gy][gx + 1];
+        float bl = _fieldGrid[gy + 1][gx];
+        float br = _fieldGrid[gy + 1][gx + 1];
+        int caseIndex = (tl > kFieldThreshold ? 8 : 0) |
+                        (tr > kFieldThreshold ? 4 : 0) |
+                        (br > kFieldThreshold ? 2 : 0) |
+                        (bl > kFieldThreshold ? 1 : 0);
+        int px[4], py[4];
+        interpolateEdge(tl, tr, cellX, cellY, cellX + kRenderSkip, cellY, px[0], py[0]);
+        interpolateEdge(tr, br, cellX + kRenderSkip, cellY, cellX + kRenderSkip, cellY + kRenderSkip, px[1], py[1]);
+        interpolateEdge(br, bl, cellX + kRenderSkip, cellY + kRenderSkip, cellX, cellY + kRenderSkip, px[2], py[2]);
+        interpolateEdge(bl, tl, cellX, cellY + kRenderSkip, cellX, cellY, px[3], py[3]);
+        switch (caseIndex) {
+          case 1: pageLine(frame, px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
+          case 2: pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+          case 3: pageLine(frame, px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
+          case 4: pageLine(frame, px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
+          case 5: pageLine(frame, px[3], py[3], px[0], py[0], SSD1306_WHITE); pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+          case 6: pageLine(frame, px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
+          case 7: pageLine(frame, px[3], py[3], px[0], py[0], SSD1306_WHITE); break;
+          case 8: pageLine(frame, px[0], py[0], px[3], py[3], SSD1306_WHITE); break;
+          case 9: pageLine(frame, px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
+          case 10: pageLine(frame, px[0], py[0], px[3], py[3], SSD1306_WHITE); pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+          case 11: pageLine(frame, px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
+          case 12: pageLine(frame, px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
+          case 13: pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+          case 14: pageLine(frame, px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
+        }
+      }
     }
   }
-}
 
-float sampleFieldAt_lava(int x, int y) {
-  float field = 0.0f;
-  for (int i = 0; i < kBallCount; ++i) {
-    float dx = static_cast<float>(x) - balls[i].x;
-    float dy = static_cast<float>(y) - balls[i].y;
-    float dist2 = dx * dx + dy * dy + 0.1f;
-    field += (balls[i].radius * balls[i].radius) / dist2;
-  }
-  return field;
-}
+  uint8_t qualityLevels() const override { return kRenderQualityLevels; }
+  uint8_t defaultQuality() const override { return 2; }
+  void setQuality(uint8_t level) override { _renderSkip = kRenderSkips[level]; }
 
-void interpolateEdge_lava(float f1, float f2, int x1, int y1, int x2, int y2, int& ix, int& iy) {
-  float t = (kFieldThreshold - f1) / (f2 - f1);
-  ix = x1 + static_cast<int>((x2 - x1) * t);
-  iy = y1 + static_cast<int>((y2 - y1) * t);
-}
+ private:
+  struct Ball {
+    float x;
+    float y;
+    float vx;
+    float vy;
+    float radius;
+    float radiusDrift;
+  };
 
-void renderMetaballs_lava() {
-  display.clearDisplay();
-  display.drawRoundRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 4, SSD1306_WHITE);
-  int kRenderSkip = 4;
-  int kGridWidth = (SCREEN_WIDTH + kRenderSkip - 1) / kRenderSkip;
-  int kGridHeight = (SCREEN_HEIGHT + kRenderSkip - 1) / kRenderSkip;
-  for (int gy = 0; gy < kGridHeight; ++gy) {
-    for (int gx = 0; gx < kGridWidth; ++gx) {
-      int sampleX = gx * kRenderSkip + kRenderSkip / 2;
-      int sampleY = gy * kRenderSkip + kRenderSkip / 2;
-      sampleX = min(sampleX, SCREEN_WIDTH - 1);
-      sampleY = min(sampleY, SCREEN_HEIGHT - 1);
-      fieldGrid[gy][gx] = sampleFieldAt_lava(sampleX, sampleY);
+  float sampleFieldAt(int x, int y) const {
+    float field = 0.0f;
+    for (int i = 0; i < kBallCount; ++i) {
+      float dx = static_cast<float>(x) - _balls[i].x;
+      float dy = static_cast<float>(y) - _balls[i].y;
+      float dist2 = dx * dx + dy * dy + 0.1f;
+      field += (_balls[i].radius * _balls[i].radius) / dist2;
     }
+    return field;
   }
-  for (int gy = 0; gy < kGridHeight - 1; ++gy) {
-    for (int gx = 0; gx < kGridWidth - 1; ++gx) {
-      int cellX = gx * kRenderSkip + kRenderSkip / 2;
-      int cellY = gy * kRenderSkip + kRenderSkip / 2;
-      float tl = fieldGrid[gy][gx];
-      float tr = fieldGrid[gy][gx + 1];
-      float bl = fieldGrid[gy + 1][gx];
-      float br = fieldGrid[gy + 1][gx + 1];
-      int caseIndex = (tl > kFieldThreshold ? 8 : 0) |
-                      (tr > kFieldThreshold ? 4 : 0) |
-                      (br > kFieldThreshold ? 2 : 0) |
-                      (bl > kFieldThreshold ? 1 : 0);
-      int px[4], py[4];
-      interpolateEdge_lava(tl, tr, cellX, cellY, cellX + kRenderSkip, cellY, px[0], py[0]);
-      interpolateEdge_lava(tr, br, cellX + kRenderSkip, cellY, cellX + kRenderSkip, cellY + kRenderSkip, px[1], py[1]);
-      interpolateEdge_lava(br, bl, cellX + kRenderSkip, cellY + kRenderSkip, cellX, cellY + kRenderSkip, px[2], py[2]);
-      interpolateEdge_lava(bl, tl, cellX, cellY + kRenderSkip, cellX, cellY, px[3], py[3]);
-      switch (caseIndex) {
-        case 1: display.drawLine(px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
-        case 2: display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 3: display.drawLine(px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
-        case 4: display.drawLine(px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
-        case 5: display.drawLine(px[3], py[3], px[0], py[0], SSD1306_WHITE); display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 6: display.drawLine(px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
-        case 7: display.drawLine(px[3], py[3], px[0], py[0], SSD1306_WHITE); break;
-        case 8: display.drawLine(px[0], py[0], px[3], py[3], SSD1306_WHITE); break;
-        case 9: display.drawLine(px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
-        case 10: display.drawLine(px[0], py[0], px[3], py[3], SSD1306_WHITE); display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 11: display.drawLine(px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
-        case 12: display.drawLine(px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
-        case 13: display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 14: display.drawLine(px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
-      }
-    }
+
+  static void interpolateEdge(float f1, float f2, int x1, int y1, int x2, int y2, int& ix, int& iy) {
+    float t = (kFieldThreshold - f1) / (f2 - f1);
+    ix = x1 + static_cast<int>((x2 - x1) * t);
+    iy = y1 + static_cast<int>((y2 - y1) * t);
   }
-  display.display();
-}
 
-// Boids variables
-#define NUM_BOIDS 42
+  Ball _balls[kBallCount];
+  float _fieldGrid[kMaxGridHeight][kMaxGridWidth];
+  int _renderSkip = 4;
+};
+static_assert(sizeof(LavaScene) <= 3904, "lava: 4 balls and a 43x22 field grid");
+
+// Boids
+#define NUM_BOIDS 120
 #define MAX_SPEED 2.2f
 #define MAX_FORCE 0.35f
 #define SEPARATION_DISTANCE 18.0f
@@ -304,289 +589,306 @@ void renderMetaballs_lava() {
 #define GRID_CELL_SIZE 35
 #define GRID_WIDTH (SCREEN_WIDTH / GRID_CELL_SIZE + 1)
 #define GRID_HEIGHT (SCREEN_HEIGHT / GRID_CELL_SIZE + 1)
-#define MAX_BOIDS_PER_CELL 10
+#define MAX_BOIDS_PER_CELL (NUM_BOIDS / 4 + 10)
 
-struct GridCell_boids {
-    uint8_t boid_indices[MAX_BOIDS_PER_CELL];
-    uint8_t count;
-};
-
-struct Boid {
-    float x, y;
-    float vx, vy;
-    float ax, ay;
-    int8_t trail_x[TRAIL_LENGTH];
-    int8_t trail_y[TRAIL_LENGTH];
-    uint8_t trail_index;
-};
-
-Boid boids[NUM_BOIDS];
-GridCell_boids grid[GRID_WIDTH][GRID_HEIGHT];
-
-inline float distanceSquared_boids(float x1, float y1, float x2, float y2) {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    return dx * dx + dy * dy;
-}
-
-inline float limitMagnitude_boids(float val, float limit) {
-    if (val > limit) return limit;
-    if (val < -limit) return -limit;
-    return val;
-}
+// The flock thins in quarters of NUM_BOIDS for the governor; boids left
+// out keep their state until they are drawn again.
+class BoidsScene : public Scene {
+ public:
+    BoidsScene() : Scene("boids", 20000) {}
 
-void buildGrid_boids() {
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            grid[x][y].count = 0;
+    bool prepare(uint32_t) override {
+        for (uint8_t i = 0; i < NUM_BOIDS; i++) {
+            _boids[i].x = random(10, SCREEN_WIDTH - 10);
+            _boids[i].y = random(10, SCREEN_HEIGHT - 10);
+            _boids[i].vx = random(-20, 20) / 10.0f;
+            _boids[i].vy = random(-20, 20) / 10.0f;
+            _boids[i].ax = 0;
+            _boids[i].ay = 0;
+            _boids[i].trail_index = 0;
+            for (uint8_t j = 0; j < TRAIL_LENGTH; j++) {
+                _boids[i].trail_x[j] = (int8_t)_boids[i].x;
+                _boids[i].trail_y[j] = (int8_t)_boids[i].y;
+            }
         }
+        return true;
     }
-    for (uint8_t i = 0; i < NUM_BOIDS; i++) {
-        int cell_x = (int)boids[i].x / GRID_CELL_SIZE;
-        int cell_y = (int)boids[i].y / GRID_CELL_SIZE;
-        if (cell_x < 0) cell_x = 0;
-        if (cell_x >= GRID_WIDTH) cell_x = GRID_WIDTH - 1;
-        if (cell_y < 0) cell_y = 0;
-        if (cell_y >= GRID_HEIGHT) cell_y = GRID_HEIGHT - 1;
-        GridCell_boids& cell = grid[cell_x][cell_y];
-        if (cell.count < MAX_BOIDS_PER_CELL) {
-            cell.boid_indices[cell.count++] = i;
+
+    void update() override {
+        buildGrid();
+        for (uint8_t i = 0; i < _active; i++) {
+            updateBoid(i);
         }
     }
-}
 
-void getNearbyBoids_boids(int index, uint8_t* nearby, uint8_t& count, float max_dist_sq) {
-    count = 0;
-    float max_dist_sq_limit = max_dist_sq + 100;
-    int cell_x = (int)boids[index].x / GRID_CELL_SIZE;
-    int cell_y = (int)boids[index].y / GRID_CELL_SIZE;
-    if (cell_x < 0) cell_x = 0;
-    if (cell_x >= GRID_WIDTH) cell_x = GRID_WIDTH - 1;
-    if (cell_y < 0) cell_y = 0;
-    if (cell_y >= GRID_HEIGHT) cell_y = GRID_HEIGHT - 1;
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            int nx = cell_x + dx;
-            int ny = cell_y + dy;
-            if (nx >= 0 && nx < GRID_WIDTH && ny >= 0 && ny < GRID_HEIGHT) {
-                GridCell_boids& neighbor_cell = grid[nx][ny];
-                for (uint8_t j = 0; j < neighbor_cell.count; j++) {
-                    uint8_t boid_idx = neighbor_cell.boid_indices[j];
-                    if (boid_idx == index) continue;
-                    float dist_sq = distanceSquared_boids(boids[index].x, boids[index].y, boids[boid_idx].x, boids[boid_idx].y);
-                    if (dist_sq < max_dist_sq_limit && count < 16) {
-                        nearby[count++] = boid_idx;
-                    }
+    void render() override {
+        display.clearDisplay();
+        uint8_t* frame = display.getBuffer();
+        for (uint8_t i = 0; i < _active; i++) {
+            for (uint8_t j = 0; j < TRAIL_LENGTH - 1; j++) {
+                uint8_t trail_idx = (_boids[i].trail_index + j) % TRAIL_LENGTH;
+                uint8_t next_idx = (trail_idx + 1) % TRAIL_LENGTH;
+                int x1 = _boids[i].trail_x[trail_idx];
+                int y1 = _boids[i].trail_y[trail_idx];
+                int x2 = _boids[i].trail_x[next_idx];
+                int y2 = _boids[i].trail_y[next_idx];
+                if (x1 >= 0 && x1 < SCREEN_WIDTH && y1 >= 0 && y1 < SCREEN_HEIGHT &&
+                    x2 >= 0 && x2 < SCREEN_WIDTH && y2 >= 0 && y2 < SCREEN_HEIGHT) {
+                    pageLine(frame, x1, y1, x2, y2, SSD1306_WHITE);
                 }
             }
         }
-    }
-}
-
-void separate_boids(uint8_t index) {
-    uint8_t nearby[16];
-    uint8_t count = 0;
-    float sep_dist_sq = SEPARATION_DISTANCE * SEPARATION_DISTANCE;
-    getNearbyBoids_boids(index, nearby, count, sep_dist_sq);
-    float steerx = 0, steery = 0;
-    int sep_count = 0;
-    for (uint8_t j = 0; j < count; j++) {
-        uint8_t i = nearby[j];
-        float dist_sq = distanceSquared_boids(boids[index].x, boids[index].y, boids[i].x, boids[i].y);
-        if (dist_sq < sep_dist_sq && dist_sq > 0) {
-            float dx = boids[index].x - boids[i].x;
-            float dy = boids[index].y - boids[i].y;
-            float len = sqrt(dist_sq);
-            dx /= len;
-            dy /= len;
-            steerx += dx;
-            steery += dy;
-            sep_count++;
+        for (uint8_t i = 0; i < _active; i++) {
+            int x = (int)_boids[i].x;
+            int y = (int)_boids[i].y;
+            float speed = sqrt(_boids[i].vx * _boids[i].vx + _boids[i].vy * _boids[i].vy);
+            int x2 = x, y2 = y;
+            if (speed > 0.1f) {
+                x2 = x + (int)(_boids[i].vx / speed * BOID_TAIL_LENGTH);
+                y2 = y + (int)(_boids[i].vy / speed * BOID_TAIL_LENGTH);
+            }
+            if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
+                x2 = constrain(x2, 0, SCREEN_WIDTH - 1);
+                y2 = constrain(y2, 0, SCREEN_HEIGHT - 1);
+                pageLine(frame, x, y, x2, y2, SSD1306_WHITE);
+            }
         }
     }
-    if (sep_count > 0) {
-        steerx /= sep_count;
-        steery /= sep_count;
-        steerx = limitMagnitude_boids(steerx, MAX_FORCE);
-        steery = limitMagnitude_boids(steery, MAX_FORCE);
-        boids[index].ax += steerx * SEPARATION_WEIGHT;
-        boids[index].ay += steery * SEPARATION_WEIGHT;
-    }
-}
 
-void align_boids(uint8_t index) {
-    uint8_t nearby[16];
-    uint8_t count = 0;
-    float align_dist_sq = ALIGNMENT_DISTANCE * ALIGNMENT_DISTANCE;
-    getNearbyBoids_boids(index, nearby, count, align_dist_sq);
-    float avgvx = 0, avgvy = 0;
-    int align_count = 0;
-    for (uint8_t j = 0; j < count; j++) {
-        uint8_t i = nearby[j];
-        float dist_sq = distanceSquared_boids(boids[index].x, boids[index].y, boids[i].x, boids[i].y);
-        if (dist_sq < align_dist_sq) {
-            avgvx += boids[i].vx;
-            avgvy += boids[i].vy;
-            align_count++;
-        }
+    uint8_t qualityLevels() const override { return kQualityLevels; }
+    uint8_t defaultQuality() const override { return kQualityLevels - 1; }
+    void setQuality(uint8_t level) override { _active = NUM_BOIDS * (level + 1) / kQualityLevels; }
+
+ private:
+    static const uint8_t kQualityLevels = 4;
+
+    struct GridCell {
+        uint8_t boid_indices[MAX_BOIDS_PER_CELL];
+        uint8_t count;
+    };
+
+    struct Boid {
+        float x, y;
+        float vx, vy;
+        float ax, ay;
+        int8_t trail_x[TRAIL_LENGTH];
+        int8_t trail_y[TRAIL_LENGTH];
+        uint8_t trail_index;
+    };
+
+    static float distanceSquared(float x1, float y1, float x2, float y2) {
+        float dx = x2 - x1;
+        float dy = y2 - y1;
+        return dx * dx + dy * dy;
     }
-    if (align_count > 0) {
-        avgvx /= align_count;
-        avgvy /= align_count;
-        avgvx = limitMagnitude_boids(avgvx, MAX_FORCE);
-        avgvy = limitMagnitude_boids(avgvy, MAX_FORCE);
-        boids[index].ax += avgvx * ALIGNMENT_WEIGHT;
-        boids[index].ay += avgvy * ALIGNMENT_WEIGHT;
+
+    static float limitMagnitude(float val, float limit) {
+        if (val > limit) return limit;
+        if (val < -limit) return -limit;
+        return val;
     }
-}
 
-void cohesion_boids(uint8_t index) {
-    uint8_t nearby[16];
-    uint8_t count = 0;
-    float cohesion_dist_sq = COHESION_DISTANCE * COHESION_DISTANCE;
-    getNearbyBoids_boids(index, nearby, count, cohesion_dist_sq);
-    float targetx = 0, targety = 0;
-    int cohesion_count = 0;
-    for (uint8_t j = 0; j < count; j++) {
-        uint8_t i = nearby[j];
-        float dist_sq = distanceSquared_boids(boids[index].x, boids[index].y, boids[i].x, boids[i].y);
-        if (dist_sq < cohesion_dist_sq) {
-            targetx += boids[i].x;
-            targety += boids[i].y;
-            cohesion_count++;
+    void buildGrid() {
+        for (int y = 0; y < GRID_HEIGHT; y++) {
+            for (int x = 0; x < GRID_WIDTH; x++) {
+                _grid[x][y].count = 0;
+            }
         }
-    }
-    if (cohesion_count > 0) {
-        targetx /= cohesion_count;
-        targety /= cohesion_count;
-        float dx = targetx - boids[index].x;
-        float dy = targety - boids[index].y;
-        float len_sq = dx * dx + dy * dy;
-        if (len_sq > 0) {
-            float len = sqrt(len_sq);
-            dx /= len;
-            dy /= len;
-            dx = limitMagnitude_boids(dx, MAX_FORCE);
-            dy = limitMagnitude_boids(dy, MAX_FORCE);
-            boids[index].ax += dx * COHESION_WEIGHT;
-            boids[index].ay += dy * COHESION_WEIGHT;
+        for (uint8_t i = 0; i < _active; i++) {
+            int cell_x = (int)_boids[i].x / GRID_CELL_SIZE;
+            int cell_y = (int)_boids[i].y / GRID_CELL_SIZE;
+            if (cell_x < 0) cell_x = 0;
+            if (cell_x >= GRID_WIDTH) cell_x = GRID_WIDTH - 1;
+            if (cell_y < 0) cell_y = 0;
+            if (cell_y >= GRID_HEIGHT) cell_y = GRID_HEIGHT - 1;
+            GridCell& cell = _grid[cell_x][cell_y];
+            if (cell.count < MAX_BOIDS_PER_CELL) {
+                cell.boid_indices[cell.count++] = i;
+            }
         }
     }
-}
 
-inline void avoidEdges_boids(uint8_t index) {
-    float steerx = 0, steery = 0;
-    const float OFFSCREEN_ALLOWANCE = 6.0f;
-    if (boids[index].x < -OFFSCREEN_ALLOWANCE) {
-        steerx += 2.0f;
-    } else if (boids[index].x < EDGE_DISTANCE) {
-        steerx += 1.0f;
-    }
-    if (boids[index].x > SCREEN_WIDTH + OFFSCREEN_ALLOWANCE) {
-        steerx -= 2.0f;
-    } else if (boids[index].x > SCREEN_WIDTH - EDGE_DISTANCE) {
-        steerx -= 1.0f;
-    }
-    if (boids[index].y < -OFFSCREEN_ALLOWANCE) {
-        steery += 2.0f;
-    } else if (boids[index].y < EDGE_DISTANCE) {
-        steery += 1.0f;
-    }
-    if (boids[index].y > SCREEN_HEIGHT + OFFSCREEN_ALLOWANCE) {
-        steery -= 2.0f;
-    } else if (boids[index].y > SCREEN_HEIGHT - EDGE_DISTANCE) {
-        steery -= 1.0f;
+    void getNearbyBoids(int index, uint8_t* nearby, uint8_t& count, float max_dist_sq) {
+        count = 0;
+        float max_dist_sq_limit = max_dist_sq + 100;
+        int cell_x = (int)_boids[index].x / GRID_CELL_SIZE;
+        int cell_y = (int)_boids[index].y / GRID_CELL_SIZE;
+        if (cell_x < 0) cell_x = 0;
+        if (cell_x >= GRID_WIDTH) cell_x = GRID_WIDTH - 1;
+        if (cell_y < 0) cell_y = 0;
+        if (cell_y >= GRID_HEIGHT) cell_y = GRID_HEIGHT - 1;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int nx = cell_x + dx;
+                int ny = cell_y + dy;
+                if (nx >= 0 && nx < GRID_WIDTH && ny >= 0 && ny < GRID_HEIGHT) {
+                    GridCell& neighbor_cell = _grid[nx][ny];
+                    for (uint8_t j = 0; j < neighbor_cell.count; j++) {
+                        uint8_t boid_idx = neighbor_cell.boid_indices[j];
+                        if (boid_idx == index) continue;
+                        float dist_sq = distanceSquared(_boids[index].x, _boids[index].y, _boids[boid_idx].x, _boids[boid_idx].y);
+                        if (dist_sq < max_dist_sq_limit && count < 16) {
+                            nearby[count++] = boid_idx;
+                        }
+                    }
+                }
+            }
+        }
     }
-    steerx = limitMagnitude_boids(steerx, MAX_FORCE);
-    steery = limitMagnitude_boids(steery, MAX_FORCE);
-    boids[index].ax += steerx * EDGE_WEIGHT;
-    boids[index].ay += steery * EDGE_WEIGHT;
-}
 
-inline void updateBoid_boids(uint8_t index) {
-    separate_boids(index);
-    align_boids(index);
-    cohesion_boids(index);
-    avoidEdges_boids(index);
-    boids[index].vx += boids[index].ax;
-    boids[index].vy += boids[index].ay;
-    float speed_sq = boids[index].vx * boids[index].vx + boids[index].vy * boids[index].vy;
-    if (speed_sq > MAX_SPEED * MAX_SPEED) {
-        float speed = sqrt(speed_sq);
-        boids[index].vx = (boids[index].vx / speed) * MAX_SPEED;
-        boids[index].vy = (boids[index].vy / speed) * MAX_SPEED;
+    void separate(uint8_t index) {
+        uint8_t nearby[16];
+        uint8_t count = 0;
+        float sep_dist_sq = SEPARATION_DISTANCE * SEPARATION_DISTANCE;
+        getNearbyBoids(index, nearby, count, sep_dist_sq);
+        float steerx = 0, steery = 0;
+        int sep_count = 0;
+        for (uint8_t j = 0; j < count; j++) {
+            uint8_t i = nearby[j];
+            float dist_sq = distanceSquared(_boids[index].x, _boids[index].y, _boids[i].x, _boids[i].y);
+            if (dist_sq < sep_dist_sq && dist_sq > 0) {
+                float dx = _boids[index].x - _boids[i].x;
+                float dy = _boids[index].y - _boids[i].y;
+                float len = sqrt(dist_sq);
+                dx /= len;
+                dy /= len;
+                steerx += dx;
+                steery += dy;
+                sep_count++;
+            }
+        }
+        if (sep_count > 0) {
+            steerx /= sep_count;
+            steery /= sep_count;
+            steerx = limitMagnitude(steerx, MAX_FORCE);
+            steery = limitMagnitude(steery, MAX_FORCE);
+            _boids[index].ax += steerx * SEPARATION_WEIGHT;
+            _boids[index].ay += steery * SEPARATION_WEIGHT;
+        }
     }
-    boids[index].x += boids[index].vx;
-    boids[index].y += boids[index].vy;
-    boids[index].trail_x[boids[index].trail_index] = (int8_t)boids[index].x;
-    boids[index].trail_y[boids[index].trail_index] = (int8_t)boids[index].y;
-    boids[index].trail_index = (boids[index].trail_index + 1) % TRAIL_LENGTH;
-    boids[index].ax = 0;
-    boids[index].ay = 0;
-    if (boids[index].x < 0) boids[index].x = 0;
-    if (boids[index].x > SCREEN_WIDTH) boids[index].x = SCREEN_WIDTH;
-    if (boids[index].y < 0) boids[index].y = 0;
-    if (boids[index].y > SCREEN_HEIGHT) boids[index].y = SCREEN_HEIGHT;
-}
 
-void initializeBoids_boids() {
-    for (uint8_t i = 0; i < NUM_BOIDS; i++) {
-        boids[i].x = random(10, SCREEN_WIDTH - 10);
-        boids[i].y = random(10, SCREEN_HEIGHT - 10);
-        boids[i].vx = random(-20, 20) / 10.0f;
-        boids[i].vy = random(-20, 20) / 10.0f;
-        boids[i].ax = 0;
-        boids[i].ay = 0;
-        boids[i].trail_index = 0;
-        for (uint8_t j = 0; j < TRAIL_LENGTH; j++) {
-            boids[i].trail_x[j] = (int8_t)boids[i].x;
-            boids[i].trail_y[j] = (int8_t)boids[i].y;
+    void align(uint8_t index) {
+        uint8_t nearby[16];
+        uint8_t count = 0;
+        float align_dist_sq = ALIGNMENT_DISTANCE * ALIGNMENT_DISTANCE;
+        getNearbyBoids(index, nearby, count, align_dist_sq);
+        float avgvx = 0, avgvy = 0;
+        int align_count = 0;
+        for (uint8_t j = 0; j < count; j++) {
+            uint8_t i = nearby[j];
+            float dist_sq = distanceSquared(_boids[index].x, _boids[index].y, _boids[i].x, _boids[i].y);
+            if (dist_sq < align_dist_sq) {
+                avgvx += _boids[i].vx;
+                avgvy += _boids[i].vy;
+                align_count++;
+            }
+        }
+        if (align_count > 0) {
+            avgvx /= align_count;
+            avgvy /= align_count;
+            avgvx = limitMagnitude(avgvx, MAX_FORCE);
+            avgvy = limitMagnitude(avgvy, MAX_FORCE);
+            _boids[index].ax += avgvx * ALIGNMENT_WEIGHT;
+            _boids[index].ay += avgvy * ALIGNMENT_WEIGHT;
         }
     }
-}
 
-void drawBoids_boids() {
-    display.clearDisplay();
-    for (uint8_t i = 0; i < NUM_BOIDS; i++) {
-        for (uint8_t j = 0; j < TRAIL_LENGTH - 1; j++) {
-            uint8_t trail_idx = (boids[i].trail_index + j) % TRAIL_LENGTH;
-            uint8_t next_idx = (trail_idx + 1) % TRAIL_LENGTH;
-            int x1 = boids[i].trail_x[trail_idx];
-            int y1 = boids[i].trail_y[trail_idx];
-            int x2 = boids[i].trail_x[next_idx];
-            int y2 = boids[i].trail_y[next_idx];
-            if (x1 >= 0 && x1 < SCREEN_WIDTH && y1 >= 0 && y1 < SCREEN_HEIGHT &&
-                x2 >= 0 && x2 < SCREEN_WIDTH && y2 >= 0 && y2 < SCREEN_HEIGHT) {
-                display.drawLine(x1, y1, x2, y2, SSD1306_WHITE);
+    void cohesion(uint8_t index) {
+        uint8_t nearby[16];
+        uint8_t count = 0;
+        float cohesion_dist_sq = COHESION_DISTANCE * COHESION_DISTANCE;
+        getNearbyBoids(index, nearby, count, cohesion_dist_sq);
+        float targetx = 0, targety = 0;
+        int cohesion_count = 0;
+        for (uint8_t j = 0; j < count; j++) {
+            uint8_t i = nearby[j];
+            float dist_sq = distanceSquared(_boids[index].x, _boids[index].y, _boids[i].x, _boids[i].y);
+            if (dist_sq < cohesion_dist_sq) {
+                targetx += _boids[i].x;
+                targety += _boids[i].y;
+                cohesion_count++;
+            }
+        }
+        if (cohesion_count > 0) {
+            targetx /= cohesion_count;
+            targety /= cohesion_count;
+            float dx = targetx - _boids[index].x;
+            float dy = targety - _boids[index].y;
+            float len_sq = dx * dx + dy * dy;
+            if (len_sq > 0) {
+                float len = sqrt(len_sq);
+                dx /= len;
+                dy /= len;
+                dx = limitMagnitude(dx, MAX_FORCE);
+                dy = limitMagnitude(dy, MAX_FORCE);
+                _boids[index].ax += dx * COHESION_WEIGHT;
+                _boids[index].ay += dy * COHESION_WEIGHT;
             }
         }
     }
-    for (uint8_t i = 0; i < NUM_BOIDS; i++) {
-        int x = (int)boids[i].x;
-        int y = (int)boids[i].y;
-        float speed = sqrt(boids[i].vx * boids[i].vx + boids[i].vy * boids[i].vy);
-        int x2 = x, y2 = y;
-        if (speed > 0.1f) {
-            x2 = x + (int)(boids[i].vx / speed * BOID_TAIL_LENGTH);
-            y2 = y + (int)(boids[i].vy / speed * BOID_TAIL_LENGTH);
+
+    void avoidEdges(uint8_t index) {
+        float steerx = 0, steery = 0;
+        const float OFFSCREEN_ALLOWANCE = 6.0f;
+        if (_boids[index].x < -OFFSCREEN_ALLOWANCE) {
+            steerx += 2.0f;
+        } else if (_boids[index].x < EDGE_DISTANCE) {
+            steerx += 1.0f;
+        }
+        if (_boids[index].x > SCREEN_WIDTH + OFFSCREEN_ALLOWANCE) {
+            steerx -= 2.0f;
+        } else if (_boids[index].x > SCREEN_WIDTH - EDGE_DISTANCE) {
+            steerx -= 1.0f;
+        }
+        if (_boids[index].y < -OFFSCREEN_ALLOWANCE) {
+            steery += 2.0f;
+        } else if (_boids[index].y < EDGE_DISTANCE) {
+            steery += 1.0f;
         }
-        if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
-            x2 = constrain(x2, 0, SCREEN_WIDTH - 1);
-            y2 = constrain(y2, 0, SCREEN_HEIGHT - 1);
-            display.drawLine(x, y, x2, y2, SSD1306_WHITE);
+        if (_boids[index].y > SCREEN_HEIGHT + OFFSCREEN_ALLOWANCE) {
+            steery -= 2.0f;
+        } else if (_boids[index].y > SCREEN_HEIGHT - EDGE_DISTANCE) {
+            steery -= 1.0f;
         }
+        steerx = limitMagnitude(steerx, MAX_FORCE);
+        steery = limitMagnitude(steery, MAX_FORCE);
+        _boids[index].ax += steerx * EDGE_WEIGHT;
+        _boids[index].ay += steery * EDGE_WEIGHT;
     }
-    display.display();
-}
 
-void updateAllBoids_boids() {
-    buildGrid_boids();
-    for (uint8_t i = 0; i < NUM_BOIDS; i++) {
-        updateBoid_boids(i);
+    void updateBoid(uint8_t index) {
+        separate(index);
+        align(index);
+        cohesion(index);
+        avoidEdges(index);
+        _boids[index].vx += _boids[index].ax;
+        _boids[index].vy += _boids[index].ay;
+        float speed_sq = _boids[index].vx * _boids[index].vx + _boids[index].vy * _boids[index].vy;
+        if (speed_sq > MAX_SPEED * MAX_SPEED) {
+            float speed = sqrt(speed_sq);
+            _boids[index].vx = (_boids[index].vx / speed) * MAX_SPEED;
+            _boids[index].vy = (_boids[index].vy / speed) * MAX_SPEED;
+        }
+        _boids[index].x += _boids[index].vx;
+        _boids[index].y += _boids[index].vy;
+        _boids[index].trail_x[_boids[index].trail_index] = (int8_t)_boids[index].x;
+        _boids[index].trail_y[_boids[index].trail_index] = (int8_t)_boids[index].y;
+        _boids[index].trail_index = (_boids[index].trail_index + 1) % TRAIL_LENGTH;
+        _boids[index].ax = 0;
+        _boids[index].ay = 0;
+        if (_boids[index].x < 0) _boids[index].x = 0;
+        if (_boids[index].x > SCREEN_WIDTH) _boids[index].x = SCREEN_WIDTH;
+        if (_boids[index].y < 0) _boids[index].y = 0;
+        if (_boids[index].y > SCREEN_HEIGHT) _boids[index].y = SCREEN_HEIGHT;
     }
-}
 
-// Caves variables
+    Boid _boids[NUM_BOIDS];
+    GridCell _grid[GRID_WIDTH][GRID_HEIGHT];
+    uint8_t _active = NUM_BOIDS;
+};
+static_assert(sizeof(BoidsScene) <= 4240, "boids: 120 boids and their 4x2 neighbour grid");
+
+// Caves
 #define DUNGEON_WIDTH 64
 #define DUNGEON_HEIGHT 32
 #define CELL_SIZE 2
@@ -594,169 +896,183 @@ void updateAllBoids_boids() {
 #define CELL_FLOOR 1
 #define CELL_CORRIDOR 2
 
-struct Room {
-  int x, y, w, h;
-};
-
-uint8_t dungeon[DUNGEON_HEIGHT][DUNGEON_WIDTH];
-std::vector<Room> rooms_caves;
-std::vector<std::pair<int, int>> drawQueue;
+// Draws a dungeon's walls over five seconds, holds the result for one,
+// blanks the screen and starts over on a new dungeon. The drawing is a
+// cooperative task resumed once per frame, so the button and autoplay are
+// seen between any two frames of it. Putting the walls in drawing order is
+// the slow part of a dungeon, so prepare() does it a slice at a time, both
+// ahead of the scene and for each new dungeon in the blank second.
+class CavesScene : public Scene, private CoopTask {
+ public:
+  CavesScene() : Scene("caves", 20000), CoopTask("caves") {}
+  using Scene::name;
 
-void initDungeon() {
-  memset(dungeon, CELL_WALL, sizeof(dungeon));
-  rooms_caves.clear();
-  drawQueue.clear();
-}
+  bool prepare(uint32_t untilMicros) override {
+    if (!_generated) {
+      generateDungeon();
+      _generated = true;
+    }
+    return orderPerimeter(untilMicros);
+  }
+  void update() override {}
+  void render() override { resume(); }
 
-void createRoom(int x, int y, int w, int h) {
-  for (int dy = 0; dy < h; dy++) {
-    for (int dx = 0; dx < w; dx++) {
-      if (y + dy < DUNGEON_HEIGHT && x + dx < DUNGEON_WIDTH) {
-        dungeon[y + dy][x + dx] = CELL_FLOOR;
+ protected:
+  bool run() override {
+    TASK_BEGIN();
+    for (;;) {
+      display.clearDisplay();
+      _start = millis();
+      _drawn = 0;
+      while (_drawn < _queueLength) {
+        drawTo(min((int)((millis() - _start) * _queueLength / kDrawMillis), _queueLength));
+        TASK_YIELD();
       }
+      TASK_SLEEP(1000);
+      display.clearDisplay();
+      TASK_SLEEP(500);
+      _generated = false;
+      while (!prepare(micros() + kSliceMicros)) TASK_YIELD();
     }
+    TASK_END();
   }
-  rooms_caves.push_back({x, y, w, h});
-}
 
-void tracePerimeter() {
-  drawQueue.clear();
-  std::vector<std::pair<int, int>> perimeter;
-  for (int y = 0; y < DUNGEON_HEIGHT; y++) {
-    for (int x = 0; x < DUNGEON_WIDTH; x++) {
-      if (dungeon[y][x] == CELL_WALL) {
-        bool isPerimeter = false;
-        if ((x > 0 && dungeon[y][x-1] != CELL_WALL) ||
-            (x < DUNGEON_WIDTH-1 && dungeon[y][x+1] != CELL_WALL) ||
-            (y > 0 && dungeon[y-1][x] != CELL_WALL) ||
-            (y < DUNGEON_HEIGHT-1 && dungeon[y+1][x] != CELL_WALL)) {
-          isPerimeter = true;
-        }
-        if (isPerimeter) {
-          perimeter.push_back(std::make_pair(x, y));
+ private:
+  static const unsigned long kDrawMillis = 5000;
+  static const uint32_t kSliceMicros = 5000; // of a 20 ms frame, per slice
+  static const int kMaxRooms = 6;
+
+  struct Room {
+    int x, y, w, h;
+  };
+  struct Cell {
+    uint8_t x, y;
+  };
+
+  void drawTo(int items) {
+    for (; _drawn < items; _drawn++) {
+      int x = _queue[_drawn].x;
+      int y = _queue[_drawn].y;
+      display.fillRect(x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE, SSD1306_WHITE);
+    }
+  }
+
+  void createRoom(int x, int y, int w, int h) {
+    for (int dy = 0; dy < h; dy++) {
+      for (int dx = 0; dx < w; dx++) {
+        if (y + dy < DUNGEON_HEIGHT && x + dx < DUNGEON_WIDTH) {
+          _dungeon[y + dy][x + dx] = CELL_FLOOR;
         }
       }
     }
+    _rooms[_roomCount++] = {x, y, w, h};
   }
-  if (!perimeter.empty()) {
-    drawQueue.push_back(perimeter[0]);
-    std::set<std::pair<int, int>> visited;
-    visited.insert(perimeter[0]);
-    while ((int)visited.size() < (int)perimeter.size()) {
-      int cx = drawQueue.back().first;
-      int cy = drawQueue.back().second;
-      double minDist = 1e9;
-      int nextIdx = -1;
-      for (int i = 0; i < (int)perimeter.size(); i++) {
-        if (visited.find(perimeter[i]) == visited.end()) {
-          int dx = perimeter[i].first - cx;
-          int dy = perimeter[i].second - cy;
-          double dist = dx*dx + dy*dy;
-          if (dist < minDist) {
-            minDist = dist;
-            nextIdx = i;
+
+  // Queues the wall cells next to floor, in row order.
+  void collectPerimeter() {
+    _queueLength = 0;
+    for (int y = 0; y < DUNGEON_HEIGHT; y++) {
+      for (int x = 0; x < DUNGEON_WIDTH; x++) {
+        if (_dungeon[y][x] == CELL_WALL) {
+          if ((x > 0 && _dungeon[y][x-1] != CELL_WALL) ||
+              (x < DUNGEON_WIDTH-1 && _dungeon[y][x+1] != CELL_WALL) ||
+              (y > 0 && _dungeon[y-1][x] != CELL_WALL) ||
+              (y < DUNGEON_HEIGHT-1 && _dungeon[y+1][x] != CELL_WALL)) {
+            _queue[_queueLength++] = {(uint8_t)x, (uint8_t)y};
           }
         }
       }
-      if (nextIdx >= 0) {
-        drawQueue.push_back(perimeter[nextIdx]);
-        visited.insert(perimeter[nextIdx]);
-      } else {
-        break;
-      }
     }
+    _ordered = 1;
   }
-}
 
-void createCorridor(int x1, int y1, int x2, int y2) {
-  int x = x1, y = y1;
-  while (x != x2) {
-    if (dungeon[y][x] != CELL_FLOOR) {
-      dungeon[y][x] = CELL_CORRIDOR;
-      drawQueue.push_back({x, y});
-    }
-    x += (x2 > x) ? 1 : -1;
-  }
-  while (y != y2) {
-    if (dungeon[y][x] != CELL_FLOOR) {
-      dungeon[y][x] = CELL_CORRIDOR;
-      drawQueue.push_back({x, y});
+  // Orders the queue for drawing, each cell the nearest one left to the
+  // last, the first in row order on a tie. The cells before _ordered are
+  // done; each pass finds the next and shifts it down to join them. Stops
+  // once micros() reaches untilMicros, and is true when the queue is done.
+  bool orderPerimeter(uint32_t untilMicros) {
+    while (_ordered < _queueLength) {
+      Cell last = _queue[_ordered - 1];
+      int nextIdx = _ordered;
+      int minDist = DUNGEON_WIDTH * DUNGEON_WIDTH + DUNGEON_HEIGHT * DUNGEON_HEIGHT; // past any cell
+      for (int i = _ordered; i < _queueLength; i++) {
+        int dx = _queue[i].x - last.x;
+        int dy = _queue[i].y - last.y;
+        int dist = dx*dx + dy*dy;
+        if (dist < minDist) {
+          minDist = dist;
+          nextIdx = i;
+        }
+      }
+      Cell next = _queue[nextIdx];
+      memmove(&_queue[_ordered + 1], &_queue[_ordered], (nextIdx - _ordered) * sizeof(Cell));
+      _queue[_ordered++] = next;
+      if ((int32_t)(micros() - untilMicros) >= 0) break;
     }
-    y += (y2 > y) ? 1 : -1;
-  }
-  if (dungeon[y][x] != CELL_FLOOR) {
-    dungeon[y][x] = CELL_CORRIDOR;
-    drawQueue.push_back({x, y});
+    return _ordered >= _queueLength;
   }
-}
 
-void generateDungeon() {
-  initDungeon();
-  int numRooms = random(4, 7);
-  int attempts = 0;
-  int maxAttempts = 30;
-  while ((int)rooms_caves.size() < numRooms && attempts < maxAttempts) {
-    int w = random(6, 16);
-    int h = random(5, 14);
-    int x = random(1, DUNGEON_WIDTH - w - 1);
-    int y = random(1, DUNGEON_HEIGHT - h - 1);
-    bool overlaps = false;
-    for (int r = 0; r < (int)rooms_caves.size(); r++) {
-      int rx = rooms_caves[r].x, ry = rooms_caves[r].y, rw = rooms_caves[r].w, rh = rooms_caves[r].h;
-      if (!(x + w < rx || x > rx + rw || y + h < ry || y > ry + rh)) {
-        overlaps = true;
-        break;
-      }
+  void createCorridor(int x1, int y1, int x2, int y2) {
+    int x = x1, y = y1;
+    while (x != x2) {
+      if (_dungeon[y][x] != CELL_FLOOR) _dungeon[y][x] = CELL_CORRIDOR;
+      x += (x2 > x) ? 1 : -1;
     }
-    if (!overlaps) {
-      createRoom(x, y, w, h);
+    while (y != y2) {
+      if (_dungeon[y][x] != CELL_FLOOR) _dungeon[y][x] = CELL_CORRIDOR;
+      y += (y2 > y) ? 1 : -1;
     }
-    attempts++;
-  }
-  for (int i = 0; i < (int)rooms_caves.size() - 1; i++) {
-    int x1 = rooms_caves[i].x + rooms_caves[i].w / 2;
-    int y1 = rooms_caves[i].y + rooms_caves[i].h / 2;
-    int x2 = rooms_caves[i + 1].x + rooms_caves[i + 1].w / 2;
-    int y2 = rooms_caves[i + 1].y + rooms_caves[i + 1].h / 2;
-    createCorridor(x1, y1, x2, y2);
+    if (_dungeon[y][x] != CELL_FLOOR) _dungeon[y][x] = CELL_CORRIDOR;
   }
-  tracePerimeter();
-}
 
-void progressiveDraw_caves(unsigned long drawTime) {
-  display.clearDisplay();
-  unsigned long startTime = millis();
-  int itemsDrawn = 0;
-  int totalItems = drawQueue.size();
-  while (itemsDrawn < totalItems) {
-    // Allow button press to interrupt the drawing
-    if (digitalRead(BUTTON_PIN) == LOW) {
-      buttonWasPressed = true;
-      buttonPressStartTime = millis();
-      return;
+  void generateDungeon() {
+    memset(_dungeon, CELL_WALL, sizeof(_dungeon));
+    _roomCount = 0;
+    _queueLength = 0;
+    int numRooms = random(4, kMaxRooms + 1);
+    int attempts = 0;
+    int maxAttempts = 30;
+    while (_roomCount < numRooms && attempts < maxAttempts) {
+      int w = random(6, 16);
+      int h = random(5, 14);
+      int x = random(1, DUNGEON_WIDTH - w - 1);
+      int y = random(1, DUNGEON_HEIGHT - h - 1);
+      bool overlaps = false;
+      for (int r = 0; r < _roomCount; r++) {
+        int rx = _rooms[r].x, ry = _rooms[r].y, rw = _rooms[r].w, rh = _rooms[r].h;
+        if (!(x + w < rx || x > rx + rw || y + h < ry || y > ry + rh)) {
+          overlaps = true;
+          break;
+        }
+      }
+      if (!overlaps) {
+        createRoom(x, y, w, h);
+      }
+      attempts++;
     }
-    unsigned long elapsed = millis() - startTime;
-    int itemsShouldBe = (int)((elapsed * totalItems) / drawTime);
-    itemsShouldBe = min(itemsShouldBe, totalItems);
-    while (itemsDrawn < itemsShouldBe) {
-      int x = drawQueue[itemsDrawn].first;
-      int y = drawQueue[itemsDrawn].second;
-      display.fillRect(x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE, SSD1306_WHITE);
-      itemsDrawn++;
+    for (int i = 0; i < _roomCount - 1; i++) {
+      int x1 = _rooms[i].x + _rooms[i].w / 2;
+      int y1 = _rooms[i].y + _rooms[i].h / 2;
+      int x2 = _rooms[i + 1].x + _rooms[i + 1].w / 2;
+      int y2 = _rooms[i + 1].y + _rooms[i + 1].h / 2;
+      createCorridor(x1, y1, x2, y2);
     }
-    display.display();
-    delay(10);
+    collectPerimeter();
   }
-}
 
-// Morph variables
-struct MorphBall {
-  float x, y, vx, vy, radius, radiusDrift;
-  int impulseCounter;
-  int currentInterval;
-  unsigned long startDelay;
+  uint8_t _dungeon[DUNGEON_HEIGHT][DUNGEON_WIDTH];
+  Room _rooms[kMaxRooms];
+  int _roomCount = 0;
+  Cell _queue[DUNGEON_HEIGHT * DUNGEON_WIDTH]; // wall cells in drawing order
+  int _queueLength = 0;
+  int _ordered = 0; // cells at the front of _queue already in order
+  bool _generated = false;
+  unsigned long _start = 0;
+  int _drawn = 0;
 };
+static_assert(sizeof(CavesScene) <= 6328, "caves: 64x32 dungeon and a draw queue as long as it");
 
+// Morph
 #define MORPH_BALL_COUNT 5
 #define MORPH_MIN_RADIUS 4.0f
 #define MORPH_MAX_RADIUS 7.0f
@@ -770,397 +1086,375 @@ struct MorphBall {
 #define MORPH_MAX_IMPULSE_STRENGTH 0.6f
 #define MORPH_MAX_IMPULSE_INTERVAL 20
 #define MORPH_START_RADIUS 0.2f
-#define MORPH_RENDER_SKIP 4
 
-MorphBall morph_balls[MORPH_BALL_COUNT];
-float morph_fieldGrid[(SCREEN_HEIGHT + MORPH_RENDER_SKIP - 1) / MORPH_RENDER_SKIP][(SCREEN_WIDTH + MORPH_RENDER_SKIP - 1) / MORPH_RENDER_SKIP];
+class MorphScene : public Scene {
+ public:
+  MorphScene() : Scene("morph", 33333) {}
 
-float randomFloat_morph(float minValue, float maxValue) {
-  float scale = static_cast<float>(random(1000)) / 1000.0f;
-  return minValue + (maxValue - minValue) * scale;
-}
-
-void resetBalls_morph() {
-  for (int i = 0; i < MORPH_BALL_COUNT; ++i) {
-    morph_balls[i].radius = randomFloat_morph(MORPH_MIN_RADIUS, MORPH_MAX_RADIUS);
-    float angle = randomFloat_morph(0, 2 * PI);
-    float r = randomFloat_morph(0, MORPH_START_RADIUS);
-    morph_balls[i].x = 64.0f + r * cos(angle);
-    morph_balls[i].y = 32.0f + r * sin(angle);
-    morph_balls[i].vx = randomFloat_morph(-MORPH_MAX_SPEED, MORPH_MAX_SPEED);
-    morph_balls[i].vy = randomFloat_morph(-MORPH_MAX_SPEED, MORPH_MAX_SPEED);
-    if (fabs(morph_balls[i].vx) < MORPH_MIN_SPEED) {
-      morph_balls[i].vx = copysign(MORPH_MIN_SPEED, morph_balls[i].vx == 0 ? 1 : morph_balls[i].vx);
-    }
-    if (fabs(morph_balls[i].vy) < MORPH_MIN_SPEED) {
-      morph_balls[i].vy = copysign(MORPH_MIN_SPEED, morph_balls[i].vy == 0 ? 1 : morph_balls[i].vy);
+  bool prepare(uint32_t) override {
+    for (int i = 0; i < MORPH_BALL_COUNT; ++i) {
+      _balls[i].radius = randomFloat(MORPH_MIN_RADIUS, MORPH_MAX_RADIUS);
+      float angle = randomFloat(0, 2 * PI);
+      float r = randomFloat(0, MORPH_START_RADIUS);
+      _balls[i].x = 64.0f + r * cos(angle);
+      _balls[i].y = 32.0f + r * sin(angle);
+      _balls[i].vx = randomFloat(-MORPH_MAX_SPEED, MORPH_MAX_SPEED);
+      _balls[i].vy = randomFloat(-MORPH_MAX_SPEED, MORPH_MAX_SPEED);
+      if (fabs(_balls[i].vx) < MORPH_MIN_SPEED) {
+        _balls[i].vx = copysign(MORPH_MIN_SPEED, _balls[i].vx == 0 ? 1 : _balls[i].vx);
+      }
+      if (fabs(_balls[i].vy) < MORPH_MIN_SPEED) {
+        _balls[i].vy = copysign(MORPH_MIN_SPEED, _balls[i].vy == 0 ? 1 : _balls[i].vy);
+      }
+      float drift = randomFloat(MORPH_MIN_DRIFT, MORPH_MAX_DRIFT);
+      _balls[i].radiusDrift = (random(0, 2) == 0) ? drift : -drift;
+      _balls[i].impulseCounter = 0;
+      _balls[i].currentInterval = random(1, MORPH_MAX_IMPULSE_INTERVAL + 1);
+      _balls[i].startDelay = random(0, 2001);
     }
-    float drift = randomFloat_morph(MORPH_MIN_DRIFT, MORPH_MAX_DRIFT);
-    morph_balls[i].radiusDrift = (random(0, 2) == 0) ? drift : -drift;
-    morph_balls[i].impulseCounter = 0;
-    morph_balls[i].currentInterval = random(1, MORPH_MAX_IMPULSE_INTERVAL + 1);
-    morph_balls[i].startDelay = random(0, 2001);
+    return true;
   }
-}
 
-void updateBalls_morph() {
-  for (int i = 0; i < MORPH_BALL_COUNT; ++i) {
-    if (millis() < morph_balls[i].startDelay) continue;
-    float dx = 64.0f - morph_balls[i].x;
-    float dy = 32.0f - morph_balls[i].y;
-    float dist = sqrt(dx * dx + dy * dy);
-    if (dist > 0) {
-      float ax = dx / dist * MORPH_GRAVITY;
-      float ay = dy / dist * MORPH_GRAVITY;
-      morph_balls[i].vx += ax;
-      morph_balls[i].vy += ay;
-    }
-    morph_balls[i].impulseCounter++;
-    if (morph_balls[i].impulseCounter >= morph_balls[i].currentInterval) {
-      morph_balls[i].impulseCounter = 0;
-      morph_balls[i].currentInterval = random(1, MORPH_MAX_IMPULSE_INTERVAL + 1);
-      float randomAngle = randomFloat_morph(0, 2 * PI);
-      float randomMag = randomFloat_morph(0, MORPH_MAX_IMPULSE_STRENGTH);
-      morph_balls[i].vx += randomMag * cos(randomAngle);
-      morph_balls[i].vy += randomMag * sin(randomAngle);
-    }
-    if (fabs(morph_balls[i].vx) > MORPH_MAX_VEL) morph_balls[i].vx = copysign(MORPH_MAX_VEL, morph_balls[i].vx);
-    if (fabs(morph_balls[i].vy) > MORPH_MAX_VEL) morph_balls[i].vy = copysign(MORPH_MAX_VEL, morph_balls[i].vy);
-    morph_balls[i].x += morph_balls[i].vx;
-    morph_balls[i].y += morph_balls[i].vy;
-    morph_balls[i].radius += morph_balls[i].radiusDrift;
-    if (morph_balls[i].radius <= MORPH_MIN_RADIUS) {
-      morph_balls[i].radius = MORPH_MIN_RADIUS;
-      morph_balls[i].radiusDrift = randomFloat_morph(MORPH_MIN_DRIFT, MORPH_MAX_DRIFT);
-    } else if (morph_balls[i].radius >= MORPH_MAX_RADIUS) {
-      morph_balls[i].radius = MORPH_MAX_RADIUS;
-      morph_balls[i].radiusDrift = -randomFloat_morph(MORPH_MIN_DRIFT, MORPH_MAX_DRIFT);
+  void update() override {
+    for (int i = 0; i < MORPH_BALL_COUNT; ++i) {
+      if (millis() < _balls[i].startDelay) continue;
+      float dx = 64.0f - _balls[i].x;
+      float dy = 32.0f - _balls[i].y;
+      float dist = sqrt(dx * dx + dy * dy);
+      if (dist > 0) {
+        float ax = dx / dist * MORPH_GRAVITY;
+        float ay = dy / dist * MORPH_GRAVITY;
+        _balls[i].vx += ax;
+        _balls[i].vy += ay;
+      }
+      _balls[i].impulseCounter++;
+      if (_balls[i].impulseCounter >= _balls[i].currentInterval) {
+        _balls[i].impulseCounter = 0;
+        _balls[i].currentInterval = random(1, MORPH_MAX_IMPULSE_INTERVAL + 1);
+        float randomAngle = randomFloat(0, 2 * PI);
+        float randomMag = randomFloat(0, MORPH_MAX_IMPULSE_STRENGTH);
+        _balls[i].vx += randomMag * cos(randomAngle);
+        _balls[i].vy += randomMag * sin(randomAngle);
+      }
+      if (fabs(_balls[i].vx) > MORPH_MAX_VEL) _balls[i].vx = copysign(MORPH_MAX_VEL, _balls[i].vx);
+      if (fabs(_balls[i].vy) > MORPH_MAX_VEL) _balls[i].vy = copysign(MORPH_MAX_VEL, _balls[i].vy);
+      _balls[i].x += _balls[i].vx;
+      _balls[i].y += _balls[i].vy;
+      _balls[i].radius += _balls[i].radiusDrift;
+      if (_balls[i].radius <= MORPH_MIN_RADIUS) {
+        _balls[i].radius = MORPH_MIN_RADIUS;
+        _balls[i].radiusDrift = randomFloat(MORPH_MIN_DRIFT, MORPH_MAX_DRIFT);
+      } else if (_balls[i].radius >= MORPH_MAX_RADIUS) {
+        _balls[i].radius = MORPH_MAX_RADIUS;
+        _balls[i].radiusDrift = -randomFloat(MORPH_MIN_DRIFT, MORPH_MAX_DRIFT);
+      }
+      if (_balls[i].x - _balls[i].radius <= 0 || _balls[i].x + _balls[i].radius >= SCREEN_WIDTH) {
+        _balls[i].vx = -_balls[i].vx;
+        _balls[i].x = constrain(_balls[i].x, _balls[i].radius, SCREEN_WIDTH - _balls[i].radius);
+      }
+      if (_balls[i].y - _balls[i].radius <= 0 || _balls[i].y + _balls[i].radius >= SCREEN_HEIGHT) {
+        _balls[i].vy = -_balls[i].vy;
+        _balls[i].y = constrain(_balls[i].y, _balls[i].radius, SCREEN_HEIGHT - _balls[i].radius);
+      }
     }
-    if (morph_balls[i].x - morph_balls[i].radius <= 0 || morph_balls[i].x + morph_balls[i].radius >= SCREEN_WIDTH) {
-      morph_balls[i].vx = -morph_balls[i].vx;
-      morph_balls[i].x = constrain(morph_balls[i].x, morph_balls[i].radius, SCREEN_WIDTH - morph_balls[i].radius);
+  }
+
+  void render() override {
+    display.clearDisplay();
+    uint8_t* frame = display.getBuffer();
+    int kGridWidth_m = (SCREEN_WIDTH + _renderSkip - 1) / _renderSkip;
+    int kGridHeight_m = (SCREEN_HEIGHT + _renderSkip - 1) / _renderSkip;
+
+    for (int gy = 0; gy < kGridHeight_m; ++gy) {
+      for (int gx = 0; gx < kGridWidth_m; ++gx) {
+        int sampleX = gx * _renderSkip + _renderSkip / 2;
+        int sampleY = gy * _renderSkip + _renderSkip / 2;
+        sampleX = min(sampleX, SCREEN_WIDTH - 1);
+        sampleY = min(sampleY, SCREEN_HEIGHT - 1);
+        _fieldGrid[gy][gx] = sampleFieldAt(sampleX, sampleY);
+      }
     }
-    if (morph_balls[i].y - morph_balls[i].radius <= 0 || morph_balls[i].y + morph_balls[i].radius >= SCREEN_HEIGHT) {
-      morph_balls[i].vy = -morph_balls[i].vy;
-      morph_balls[i].y = constrain(morph_balls[i].y, morph_balls[i].radius, SCREEN_HEIGHT - morph_balls[i].radius);
+
+    for (int gy = 0; gy < kGridHeight_m - 1; ++gy) {
+      for (int gx = 0; gx < kGridWidth_m - 1; ++gx) {
+        int cellX = gx * _renderSkip + _renderSkip / 2;
+        int cellY = gy * _renderSkip + _renderSkip / 2;
+        float tl = _fieldGrid[gy][gx];
+        float tr = _fieldGrid[gy][gx + 1];
+        float bl = _fieldGrid[gy + 1][gx];
+        float br = _fieldGrid[gy + 1][gx + 1];
+        int caseIndex = (tl > MORPH_FIELD_THRESHOLD ? 8 : 0) |
+                        (tr > MORPH_FIELD_THRESHOLD ? 4 : 0) |
+                        (br > MORPH_FIELD_THRESHOLD ? 2 : 0) |
+                        (bl > MORPH_FIELD_THRESHOLD ? 1 : 0);
+        int px[4], py[4];
+        interpolateEdge(tl, tr, cellX, cellY, cellX + _renderSkip, cellY, px[0], py[0]);
+        interpolateEdge(tr, br, cellX + _renderSkip, cellY, cellX + _renderSkip, cellY + _renderSkip, px[1], py[1]);
+        interpolateEdge(br, bl, cellX + _renderSkip, cellY + _renderSkip, cellX, cellY + _renderSkip, px[2], py[2]);
+        interpolateEdge(bl, tl, cellX, cellY + _renderSkip, cellX, cellY, px[3], py[3]);
+        switch (caseIndex) {
+          case 1: pageLine(frame, px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
+          case 2: pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+          case 3: pageLine(frame, px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
+          case 4: pageLine(frame, px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
+          case 5: pageLine(frame, px[3], py[3], px[0], py[0], SSD1306_WHITE); pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+          case 6: pageLine(frame, px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
+          case 7: pageLine(frame, px[3], py[3], px[0], py[0], SSD1306_WHITE); break;
+          case 8: pageLine(frame, px[0], py[0], px[3], py[3], SSD1306_WHITE); break;
+          case 9: pageLine(frame, px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
+          case 10: pageLine(frame, px[0], py[0], px[3], py[3], SSD1306_WHITE); pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+          case 11: pageLine(frame, px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
+          case 12: pageLine(frame, px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
+          case 13: pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+          case 14: pageLine(frame, px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
+        }
+      }
     }
   }
-}
 
-float sampleFieldAt_morph(int x, int y) {
-  float field = 0.0f;
-  for (int i = 0; i < MORPH_BALL_COUNT; ++i) {
-    float dx = static_cast<float>(x) - morph_balls[i].x;
-    float dy = static_cast<float>(y) - morph_balls[i].y;
-    float dist2 = dx * dx + dy * dy + 0.1f;
-    field += (morph_balls[i].radius * morph_balls[i].radius) / dist2;
-  }
-  return field;
-}
+  uint8_t qualityLevels() const override { return kRenderQualityLevels; }
+  uint8_t defaultQuality() const override { return 2; }
+  void setQuality(uint8_t level) override { _renderSkip = kRenderSkips[level]; }
 
-void interpolateEdge_morph(float f1, float f2, int x1, int y1, int x2, int y2, int& ix, int& iy) {
-  float t = (MORPH_FIELD_THRESHOLD - f1) / (f2 - f1);
-  ix = x1 + static_cast<int>((x2 - x1) * t);
-  iy = y1 + static_cast<int>((y2 - y1) * t);
-}
+ private:
+  struct MorphBall {
+    float x, y, vx, vy, radius, radiusDrift;
+    int impulseCounter;
+    int currentInterval;
+    unsigned long startDelay;
+  };
 
-void renderMetaballs_morph() {
-  display.clearDisplay();
-  int kGridWidth_m = (SCREEN_WIDTH + MORPH_RENDER_SKIP - 1) / MORPH_RENDER_SKIP;
-  int kGridHeight_m = (SCREEN_HEIGHT + MORPH_RENDER_SKIP - 1) / MORPH_RENDER_SKIP;
-  
-  for (int gy = 0; gy < kGridHeight_m; ++gy) {
-    for (int gx = 0; gx < kGridWidth_m; ++gx) {
-      int sampleX = gx * MORPH_RENDER_SKIP + MORPH_RENDER_SKIP / 2;
-      int sampleY = gy * MORPH_RENDER_SKIP + MORPH_RENDER_SKIP / 2;
-      sampleX = min(sampleX, SCREEN_WIDTH - 1);
-      sampleY = min(sampleY, SCREEN_HEIGHT - 1);
-      morph_fieldGrid[gy][gx] = sampleFieldAt_morph(sampleX, sampleY);
+  float sampleFieldAt(int x, int y) const {
+    float field = 0.0f;
+    for (int i = 0; i < MORPH_BALL_COUNT; ++i) {
+      float dx = static_cast<float>(x) - _balls[i].x;
+      float dy = static_cast<float>(y) - _balls[i].y;
+      float dist2 = dx * dx + dy * dy + 0.1f;
+      field += (_balls[i].radius * _balls[i].radius) / dist2;
     }
+    return field;
   }
 
-  for (int gy = 0; gy < kGridHeight_m - 1; ++gy) {
-    for (int gx = 0; gx < kGridWidth_m - 1; ++gx) {
-      int cellX = gx * MORPH_RENDER_SKIP + MORPH_RENDER_SKIP / 2;
-      int cellY = gy * MORPH_RENDER_SKIP + MORPH_RENDER_SKIP / 2;
-      float tl = morph_fieldGrid[gy][gx];
-      float tr = morph_fieldGrid[gy][gx + 1];
-      float bl = morph_fieldGrid[gy + 1][gx];
-      float br = morph_fieldGrid[gy + 1][gx + 1];
-      int caseIndex = (tl > MORPH_FIELD_THRESHOLD ? 8 : 0) |
-                      (tr > MORPH_FIELD_THRESHOLD ? 4 : 0) |
-                      (br > MORPH_FIELD_THRESHOLD ? 2 : 0) |
-                      (bl > MORPH_FIELD_THRESHOLD ? 1 : 0);
-      int px[4], py[4];
-      interpolateEdge_morph(tl, tr, cellX, cellY, cellX + MORPH_RENDER_SKIP, cellY, px[0], py[0]);
-      interpolateEdge_morph(tr, br, cellX + MORPH_RENDER_SKIP, cellY, cellX + MORPH_RENDER_SKIP, cellY + MORPH_RENDER_SKIP, px[1], py[1]);
-      interpolateEdge_morph(br, bl, cellX + MORPH_RENDER_SKIP, cellY + MORPH_RENDER_SKIP, cellX, cellY + MORPH_RENDER_SKIP, px[2], py[2]);
-      interpolateEdge_morph(bl, tl, cellX, cellY + MORPH_RENDER_SKIP, cellX, cellY, px[3], py[3]);
-      switch (caseIndex) {
-        case 1: display.drawLine(px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
-        case 2: display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 3: display.drawLine(px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
-        case 4: display.drawLine(px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
-        case 5: display.drawLine(px[3], py[3], px[0], py[0], SSD1306_WHITE); display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 6: display.drawLine(px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
-        case 7: display.drawLine(px[3], py[3], px[0], py[0], SSD1306_WHITE); break;
-        case 8: display.drawLine(px[0], py[0], px[3], py[3], SSD1306_WHITE); break;
-        case 9: display.drawLine(px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
-        case 10: display.drawLine(px[0], py[0], px[3], py[3], SSD1306_WHITE); display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 11: display.drawLine(px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
-        case 12: display.drawLine(px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
-        case 13: display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 14: display.drawLine(px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
-      }
-    }
+  static void interpolateEdge(float f1, float f2, int x1, int y1, int x2, int y2, int& ix, int& iy) {
+    float t = (MORPH_FIELD_THRESHOLD - f1) / (f2 - f1);
+    ix = x1 + static_cast<int>((x2 - x1) * t);
+    iy = y1 + static_cast<int>((y2 - y1) * t);
   }
-  display.display();
-}
 
-// Starfield variables
-#define NUM_STARS 100
+  MorphBall _balls[MORPH_BALL_COUNT];
+  float _fieldGrid[kMaxGridHeight][kMaxGridWidth];
+  int _renderSkip = 4;
+};
+static_assert(sizeof(MorphScene) <= 4016, "morph: 5 balls and a 43x22 field grid");
+
+// Starfield
+#define NUM_STARS 500
 #define STAR_SPEED 0.01f
 #define STAR_SCALE 50.0f
 
-struct Star {
-    float x, y, z;
-};
-
-Star stars[NUM_STARS];
+// Thins in quarters of NUM_STARS for the governor; stars left out stand
+// still until they are drawn again.
+class StarfieldScene : public Scene {
+ public:
+    StarfieldScene() : Scene("starfield", 33333) {}
 
-void initializeStars() {
-    for (int i = 0; i < NUM_STARS; i++) {
-        stars[i].x = random(-1000, 1000) / 1000.0f;
-        stars[i].y = random(-1000, 1000) / 1000.0f;
-        stars[i].z = random(100, 1000) / 1000.0f;
+    bool prepare(uint32_t) override {
+        for (int i = 0; i < NUM_STARS; i++) {
+            _stars[i].x = random(-1000, 1000) / 1000.0f;
+            _stars[i].y = random(-1000, 1000) / 1000.0f;
+            _stars[i].z = random(100, 1000) / 1000.0f;
+        }
+        return true;
     }
-}
 
-void updateStars() {
-    for (int i = 0; i < NUM_STARS; i++) {
-        stars[i].z -= STAR_SPEED;
-        if (stars[i].z <= 0.0f) {
-            stars[i].x = random(-1000, 1000) / 1000.0f;
-            stars[i].y = random(-1000, 1000) / 1000.0f;
-            stars[i].z = 1.0f;
+    void update() override {
+        for (int i = 0; i < _active; i++) {
+            _stars[i].z -= STAR_SPEED;
+            if (_stars[i].z <= 0.0f) {
+                _stars[i].x = random(-1000, 1000) / 1000.0f;
+                _stars[i].y = random(-1000, 1000) / 1000.0f;
+                _stars[i].z = 1.0f;
+            }
         }
     }
-}
 
-void drawStars() {
-    display.clearDisplay();
-    for (int i = 0; i < NUM_STARS; i++) {
-        float z = stars[i].z;
-        int sx = SCREEN_WIDTH / 2 + (int)(stars[i].x / z * STAR_SCALE);
-        int sy = SCREEN_HEIGHT / 2 + (int)(stars[i].y / z * STAR_SCALE);
-        if (sx >= 0 && sx < SCREEN_WIDTH && sy >= 0 && sy < SCREEN_HEIGHT) {
-            int size = (z < 0.5f) ? 2 : 1;
-            display.fillRect(sx, sy, size, size, SSD1306_WHITE);
+    // Drawn alpha of a step ahead of the last update, where the stars are
+    // by the time a late frame goes out.
+    void render() override {
+        float alpha = frameClock.alpha();
+        display.clearDisplay();
+        for (int i = 0; i < _active; i++) {
+            float z = _stars[i].z - alpha * STAR_SPEED;
+            if (z <= 0.0f) z = _stars[i].z; // due to respawn on the next step
+            int sx = SCREEN_WIDTH / 2 + (int)(_stars[i].x / z * STAR_SCALE);
+            int sy = SCREEN_HEIGHT / 2 + (int)(_stars[i].y / z * STAR_SCALE);
+            if (sx >= 0 && sx < SCREEN_WIDTH && sy >= 0 && sy < SCREEN_HEIGHT) {
+                int size = (z < 0.5f) ? 2 : 1;
+                display.fillRect(sx, sy, size, size, SSD1306_WHITE);
+            }
         }
     }
-    display.display();
+
+    uint8_t qualityLevels() const override { return kQualityLevels; }
+    uint8_t defaultQuality() const override { return kQualityLevels - 1; }
+    void setQuality(uint8_t level) override { _active = NUM_STARS * (level + 1) / kQualityLevels; }
+
+ private:
+    static const uint8_t kQualityLevels = 4;
+
+    struct Star {
+        float x, y, z;
+    };
+
+    Star _stars[NUM_STARS];
+    int _active = NUM_STARS;
+};
+static_assert(sizeof(StarfieldScene) <= 6024, "starfield: 500 stars");
+
+// Two arenas the size of the largest scene: one holds whichever is current
+// and the other stages the mode after it, prepared in the time the current
+// scene's frames leave over, so that a switch is a swap of the two.
+constexpr size_t maxOf(size_t a, size_t b) { return a > b ? a : b; }
+constexpr size_t kSceneArenaBytes =
+    maxOf(sizeof(SnakeScene), maxOf(sizeof(BrickScene), maxOf(sizeof(LavaScene),
+    maxOf(sizeof(BoidsScene), maxOf(sizeof(CavesScene), maxOf(sizeof(MorphScene), sizeof(StarfieldScene)))))));
+alignas(8) uint8_t sceneStorage[2][kSceneArenaBytes];
+SceneArena sceneArenas[2] = {{sceneStorage[0], kSceneArenaBytes}, {sceneStorage[1], kSceneArenaBytes}};
+SceneArena* liveArena = &sceneArenas[0];
+SceneArena* stagingArena = &sceneArenas[1];
+Mode stagedMode = SNAKE; // meaningful while stagingArena holds a scene
+
+// Staging starts this long before autoplay's switch and stops this long
+// before each frame is due.
+const unsigned long kStageMillis = 5000;
+const uint32_t kStageMarginMicros = 2000;
+
+Scene* buildScene(Mode mode, SceneArena& arena) {
+  switch (mode) {
+    case SNAKE: return arena.build<SnakeScene>();
+    case BRICK_BREAK: return arena.build<BrickScene>();
+    case LAVA_LAMP: return arena.build<LavaScene>();
+    case BOIDS: return arena.build<BoidsScene>();
+    case CAVES: return arena.build<CavesScene>();
+    case MORPH: return arena.build<MorphScene>();
+    case STARFIELD: return arena.build<StarfieldScene>();
+  }
+  return nullptr;
+}
+
+Mode nextMode() { return (Mode)((currentMode + 1) % 7); }
+
+// Build the next mode in the staging arena once autoplay's switch is near,
+// and prepare it until shortly before the next frame is due.
+void stageNextScene(unsigned long now) {
+  if (!autoPlayEnabled || now - modeStartTime < MODE_DURATION - kStageMillis) return;
+  if (!stagingArena->scene() || stagedMode != nextMode()) {
+    stagedMode = nextMode();
+    buildScene(stagedMode, *stagingArena);
+  }
+  uint32_t until = frameClock.nextMicros() - kStageMarginMicros;
+  if (!stagingArena->ready() && (int32_t)(until - micros()) > 0) stagingArena->prepare(until);
+}
+
+// Switch to next, in place of the current scene: the staged one if it is
+// next, or one built and prepared here. With TRANSITION the last frame
+// stays on screen through the setup and the new scene's first frames blend
+// in.
+void switchMode(Mode next, unsigned long now) {
+#if TRANSITION
+  static uint8_t transitions = 0;
+#if TRANSITION == 5
+  Wipe wipe = (Wipe)(transitions++ % kWipeKinds);
+#else
+  Wipe wipe = (Wipe)(TRANSITION - 1);
+#endif
+  if (shownScene) transition.start(shownScene, wipe, TRANSITION_FRAMES);
+#endif
+  currentMode = next;
+  modeStartTime = now;
+  if (!stagingArena->scene() || stagedMode != next) buildScene(next, *stagingArena);
+  std::swap(liveArena, stagingArena);
+  stagingArena->release(); // the old scene exits
+  scene = liveArena->scene();
+  frameClock.setStep(scene->stepMicros());
+  // Each scene starts from its own default; what the last one settled on
+  // says nothing about this one.
+  governor.setBudget(scene->stepMicros());
+  governor.reset(scene->qualityLevels(), scene->defaultQuality());
+  scene->setQuality(governor.level());
+  liveArena->enter();
 }
 
 void setup() {
   Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
   display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+#if I2C_BATCHED
+  bus.begin(OLED_SDA_PIN, OLED_SCL_PIN);
+#else
+  bus.begin();
+#endif
+  frames.begin();
+#if BADGE
+  layers.addOverlay(badge);
+#endif
+#if SERIAL_MIRROR
+  Serial.setTxBufferSize(2 * kMirrorMaxPacket); // room for a keyframe behind the one going out
+  Serial.begin(MIRROR_BAUD);
+#elif FLUSH_STATS || QUALITY_GOVERNOR
+  Serial.begin(115200);
+#endif
+#if QUALITY_GOVERNOR
+  governor.setLog(&Serial);
+#endif
+#if FLUSH_STATS
+  Serial.printf("scenes: 2 x %u byte arenas; snake %u, brick %u, lava %u, boids %u, caves %u, morph %u, starfield %u\n",
+                (unsigned)kSceneArenaBytes, (unsigned)sizeof(SnakeScene), (unsigned)sizeof(BrickScene),
+                (unsigned)sizeof(LavaScene), (unsigned)sizeof(BoidsScene), (unsigned)sizeof(CavesScene),
+                (unsigned)sizeof(MorphScene), (unsigned)sizeof(StarfieldScene));
+#endif
   display.clearDisplay();
   randomSeed(analogRead(0));
-  pinMode(BUTTON_PIN, INPUT_PULLUP);
-  reset_snake();
-  resetGame_brick();
-  resetBalls_lava();
-  initializeBoids_boids();
-  generateDungeon();
-  resetBalls_morph();
-  initializeStars();
-  modeStartTime = millis();
+  button.begin();
+  switchMode(SNAKE, millis());
 }
 
 void loop() {
   unsigned long now = millis();
   
-  // Button handling for tap vs hold detection
-  if (digitalRead(BUTTON_PIN) == LOW) {
-    if (!buttonWasPressed) {
-      // Button just pressed
-      buttonWasPressed = true;
-      buttonPressStartTime = now;
-    }
-  } else {
-    if (buttonWasPressed) {
-      // Button was released
-      unsigned long holdDuration = now - buttonPressStartTime;
-      if (holdDuration >= 3000) {
-        // Long hold (3+ seconds) - toggle auto-play
-        autoPlayEnabled = !autoPlayEnabled;
-        modeStartTime = now; // Reset timer when toggling
-      } else {
-        // Short tap - advance to next mode and disable auto-play
-        autoPlayEnabled = false; // Disable auto-play on tap
-        currentMode = (Mode)((currentMode + 1) % 7);
-        modeStartTime = now;
-        if (currentMode == SNAKE) reset_snake();
-        else if (currentMode == BRICK_BREAK) resetGame_brick();
-        else if (currentMode == LAVA_LAMP) resetBalls_lava();
-        else if (currentMode == BOIDS) initializeBoids_boids();
-        else if (currentMode == CAVES) generateDungeon();
-        else if (currentMode == MORPH) resetBalls_morph();
-        else if (currentMode == STARFIELD) initializeStars();
-      }
-      buttonWasPressed = false;
+  // Button events, queued by interrupt while the last frame was busy
+  button.update();
+  ButtonEvent event;
+  while (button.next(event)) {
+    if (event.kind == ButtonEventKind::kLongPress) {
+      // Long hold (3+ seconds) - toggle auto-play
+      autoPlayEnabled = !autoPlayEnabled;
+      modeStartTime = now; // Reset timer when toggling
+    } else if (event.kind == ButtonEventKind::kTap) {
+      // Short tap - advance to next mode and disable auto-play
+      autoPlayEnabled = false; // Disable auto-play on tap
+      switchMode(nextMode(), now);
     }
   }
   
   // Auto-play advance if enabled
   if (autoPlayEnabled && (now - modeStartTime >= MODE_DURATION)) {
-    currentMode = (Mode)((currentMode + 1) % 7);
-    modeStartTime = now;
-    if (currentMode == SNAKE) reset_snake();
-    else if (currentMode == BRICK_BREAK) resetGame_brick();
-    else if (currentMode == LAVA_LAMP) resetBalls_lava();
-    else if (currentMode == BOIDS) initializeBoids_boids();
-    else if (currentMode == CAVES) generateDungeon();
-    else if (currentMode == MORPH) resetBalls_morph();
-    else if (currentMode == STARFIELD) initializeStars();
+    switchMode(nextMode(), now);
   }
-  if (currentMode == SNAKE) {
-    if (gameOver) {
-      reset_snake();
-      delay(1000);
-    }
-    draw_snake();
-    delay(20);
-    Dir nextd = getNextDir_snake();
-    dir = nextd;
-    Pos nh = moveHead_snake(dir);
-    if (!isValidMove_snake(nh)) {
-      gameOver = true;
-      return;
-    }
-    snake.insert(snake.begin(), nh);
-    if (nh == food) {
-      score++;
-      food = randomFree_snake();
-      if (food.first == -1) gameOver = true;
-    } else {
-      snake.pop_back();
-    }
-  } else if (currentMode == BRICK_BREAK) {
-    if (gameState == PLAYING) {
-      float targetX = ballX - PADDLE_WIDTH / 2.0 + random(-2, 3);
-      targetX = constrain(targetX, 4, GAME_WIDTH - PADDLE_WIDTH - 4);
-      paddleX = paddleX * 0.7 + targetX * 0.3;
-      paddleX = constrain(paddleX, 4, GAME_WIDTH - PADDLE_WIDTH - 4);
-      ballX += ballVelX;
-      ballY += ballVelY;
-      if (ballX <= 0 || ballX >= GAME_WIDTH - 4) {
-        ballVelX = -ballVelX;
-        bouncesSinceBrick++;
-      }
-      if (ballY <= 0) {
-        ballVelY = -ballVelY;
-        bouncesSinceBrick++;
-      }
-      if (ballY + 4 >= GAME_HEIGHT - PADDLE_HEIGHT && ballY <= GAME_HEIGHT && ballX + 4 >= paddleX && ballX <= paddleX + PADDLE_WIDTH) {
-        float hitPos = (ballX - paddleX) / PADDLE_WIDTH;
-        ballVelX = (hitPos - 0.5) * 3.0;
-        ballVelX += random(-1, 2);
-        if (abs(ballVelX) < 1.4) {
-          ballVelX = (ballVelX > 0) ? 1.4 : -1.4;
-        }
-        ballVelY = -abs(ballVelY);
-        bouncesSinceBrick++;
-      }
-      for (int r = 0; r < BRICK_ROWS; r++) {
-        for (int c = 0; c < BRICK_COLS; c++) {
-          if (bricks[r][c]) {
-            int bx = brick_start_x + c * BRICK_WIDTH;
-            int by = brick_start_y + r * BRICK_HEIGHT;
-            if (ballX >= bx && ballX <= bx + BRICK_WIDTH && ballY >= by && ballY <= by + BRICK_HEIGHT) {
-              bricks[r][c] = false;
-              ballVelY = -ballVelY;
-              bouncesSinceBrick = 0;
-            }
-          }
-        }
-      }
-      if (ballY > GAME_HEIGHT) {
-        gameState = LOSE;
-        endTime = millis() + 2000;
-      }
-      bool allGone = true;
-      for (int r = 0; r < BRICK_ROWS; r++) for (int c = 0; c < BRICK_COLS; c++) if (bricks[r][c]) allGone = false;
-      if (allGone) {
-        gameState = WIN;
-        endTime = millis() + 2000;
-      }
-      display.setRotation(1);
-      display.clearDisplay();
-      display.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
-      for (int r = 0; r < BRICK_ROWS; r++) {
-        for (int c = 0; c < BRICK_COLS; c++) {
-          if (bricks[r][c]) {
-            display.fillRect(brick_start_x + c * BRICK_WIDTH + 1, brick_start_y + r * BRICK_HEIGHT + 1, BRICK_WIDTH - 2, BRICK_HEIGHT - 2, SSD1306_WHITE);
-          }
-        }
-      }
-      display.fillRect((int)paddleX, GAME_HEIGHT - PADDLE_HEIGHT, PADDLE_WIDTH, PADDLE_HEIGHT, SSD1306_WHITE);
-      display.fillRect(ballX, ballY, 4, 4, SSD1306_WHITE);
-      display.display();
-      display.setRotation(0);
-      if (bouncesSinceBrick > 34) {
-        gameState = LOSE;
-        endTime = millis() + 2000;
-      }
-    } else {
-      display.setRotation(1);
-      display.clearDisplay();
-      display.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
-      String msg = (gameState == WIN) ? "WIN" : "LOSE";
-      display.setTextSize(2);
-      display.setTextColor(SSD1306_WHITE);
-      int16_t x1, y1;
-      uint16_t w, h;
-      display.getTextBounds(msg, 0, 0, &x1, &y1, &w, &h);
-      int x = (GAME_WIDTH - w) / 2;
-      int y = (GAME_HEIGHT - h) / 2;
-      display.drawRoundRect(x - 5, y - 5, w + 10, h + 10, 5, SSD1306_WHITE);
-      display.setCursor(x, y);
-      display.print(msg);
-      display.display();
-      display.setRotation(0);
-      if (millis() > endTime) {
-        resetGame_brick();
-      }
-    }
-    delay(2);
-  } else if (currentMode == LAVA_LAMP) {
-    unsigned long now_lava = millis();
-    if (now_lava - lastFrameTime_lava < kFrameDelay) {
-      return;
-    }
-    lastFrameTime_lava = now_lava;
-    updateBalls_lava();
-    renderMetaballs_lava();
-  } else if (currentMode == BOIDS) {
-    updateAllBoids_boids();
-    drawBoids_boids();
-    delay(1);
-  } else if (currentMode == CAVES) {
-    progressiveDraw_caves(5000);
-    delay(1000);
-    display.clearDisplay();
-    display.display();
-    delay(500);
-    generateDungeon();
-  } else if (currentMode == MORPH) {
-    updateBalls_morph();
-    renderMetaballs_morph();
-    delay(1);
-  } else if (currentMode == STARFIELD) {
-    updateStars();
-    drawStars();
-    delay(30);
+
+  // The scene's steps, then its frame, timed by the governor, which moves
+  // the scene to another quality level when it asks.
+  int steps = frameClock.steps();
+  if (steps > 0) {
+    governor.begin();
+    for (int n = 0; n < steps; n++) scene->update();
+    governor.updated();
+    scene->render();
+    governor.rendered();
+    present();
+#if QUALITY_GOVERNOR
+    if (governor.flushed()) scene->setQuality(governor.level());
+#endif
   }
-}
\ No newline at end of file
+  stageNextScene(now);
+  frameClock.sleep();
+}
@@ -13,6 +13,9 @@
 #define GRID_HEIGHT 32
 #define CELL_SIZE 2
 
+// time drawGrid() through fillRect() vs the cell canvas blit over serial
+#define GRID_BENCH 0
+
 // globals
 #include <Adafruit_SSD1306.h>
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
\ No newline at end of file
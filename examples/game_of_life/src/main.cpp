@@ -1,6 +1,7 @@
 #include "config.h"
 #include <Wire.h>
 #include <Adafruit_GFX.h>
+#include "cell_canvas.h"
 
 // Game of Life grids
 bool currentGrid[GRID_HEIGHT][GRID_WIDTH];
@@ -8,6 +9,9 @@ bool nextGrid[GRID_HEIGHT][GRID_WIDTH];
 
 bool lastButtonState = HIGH;
 
+// one bit per cell, upscaled into the framebuffer by blit()
+CellCanvas cells(GRID_WIDTH, GRID_HEIGHT, CELL_SIZE);
+
 void initDisplay() {
   Wire.begin(SDA_PIN, SCL_PIN);
   if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
@@ -62,17 +66,48 @@ void updateGrid() {
 
 // Function to draw the grid on the display
 void drawGrid() {
-  display.clearDisplay();
   for (int y = 0; y < GRID_HEIGHT; y++) {
     for (int x = 0; x < GRID_WIDTH; x++) {
-      if (currentGrid[y][x]) {
-        display.fillRect(x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE, SSD1306_WHITE);
-      }
+      cells.set(x, y, currentGrid[y][x]);
     }
   }
+  cells.blit(display.getBuffer());
   display.display();
 }
 
+#if GRID_BENCH
+// Render the current board both ways without flushing and print the
+// average time per frame.
+void benchGrid() {
+  const int runs = 20;
+  unsigned long start = micros();
+  for (int i = 0; i < runs; i++) {
+    display.clearDisplay();
+    for (int y = 0; y < GRID_HEIGHT; y++) {
+      for (int x = 0; x < GRID_WIDTH; x++) {
+        if (currentGrid[y][x]) {
+          display.fillRect(x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE, SSD1306_WHITE);
+        }
+      }
+    }
+  }
+  unsigned long fillRectUs = (micros() - start) / runs;
+
+  start = micros();
+  for (int i = 0; i < runs; i++) {
+    for (int y = 0; y < GRID_HEIGHT; y++) {
+      for (int x = 0; x < GRID_WIDTH; x++) {
+        cells.set(x, y, currentGrid[y][x]);
+      }
+    }
+    cells.blit(display.getBuffer());
+  }
+  unsigned long blitUs = (micros() - start) / runs;
+
+  Serial.printf("drawGrid: fillRect %lu us, canvas blit %lu us\n", fillRectUs, blitUs);
+}
+#endif
+
 void setup() {
   Serial.begin(115200);
   pinMode(BUTTON_PIN, INPUT_PULLUP);
@@ -91,6 +126,10 @@ void loop() {
   lastButtonState = currentButtonState;
 
   updateGrid();
+#if GRID_BENCH
+  static int generation = 0;
+  if (++generation % 50 == 0) benchGrid();
+#endif
   drawGrid();
   delay(100);
 }
\ No newline at end of file
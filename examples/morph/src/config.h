@@ -7,6 +7,10 @@
 #define BUTTON_PIN 5 // D3
 #define BUTTON_TAP_TIME 20
 
+// step the marching-squares grid between 8 and 3 px to hold 30 frames per
+// second, logging each change over serial; 0 keeps the 4 px grid
+#define QUALITY_GOVERNOR 1
+
 // globals
 #include <Adafruit_SSD1306.h>
 extern Adafruit_SSD1306 display;
\ No newline at end of file
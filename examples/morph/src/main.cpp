@@ -5,6 +5,10 @@
 #include <esp_random.h>
 
 #include "config.h"
+#include "page_line.h"
+#include "frame_clock.h"
+#include "button_input.h"
+#include "quality_governor.h"
 
 constexpr int kBallCount = 5;
 constexpr float kMinRadius = 4.0f;
@@ -19,10 +23,15 @@ constexpr float kMaxVelocity = 3.2f;
 constexpr float kMaxImpulseStrength = 0.6f;
 constexpr int kMaxImpulseInterval = 20;
 constexpr float kStartRadius = 0.2f;
-constexpr unsigned long kFrameDelay = 0;
-constexpr int kRenderSkip = 4;
-constexpr int kGridWidth = (SCREEN_WIDTH + kRenderSkip - 1) / kRenderSkip;
-constexpr int kGridHeight = (SCREEN_HEIGHT + kRenderSkip - 1) / kRenderSkip;
+constexpr uint32_t kStepMicros = 33333; // 30 simulation steps per second
+// Marching-squares grid step per quality level, cheapest first; 4 is the
+// step it always drew at. The field grid is sized for the finest.
+constexpr int kRenderSkips[] = {8, 6, 4, 3};
+constexpr int kQualityLevels = sizeof(kRenderSkips) / sizeof(kRenderSkips[0]);
+constexpr int kDefaultLevel = 2;
+constexpr int kMinRenderSkip = 3;
+constexpr int kGridWidth = (SCREEN_WIDTH + kMinRenderSkip - 1) / kMinRenderSkip;
+constexpr int kGridHeight = (SCREEN_HEIGHT + kMinRenderSkip - 1) / kMinRenderSkip;
 
 struct Ball {
   float x;
@@ -37,11 +46,11 @@ struct Ball {
 };
 
 static Ball balls[kBallCount];
-static unsigned long lastFrameTime = 0;
+static FrameClock frameClock(kStepMicros);
+static QualityGovernor governor(kStepMicros, kQualityLevels, kDefaultLevel);
+static int renderSkip = kRenderSkips[kDefaultLevel];
 
-static int lastButtonState = HIGH;
-static unsigned long lastButtonChange = 0;
-static bool buttonHandled = false;
+static ButtonInput button(BUTTON_PIN, BUTTON_TAP_TIME, 1000);
 
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
 static float fieldGrid[kGridHeight][kGridWidth];
@@ -125,23 +134,13 @@ void updateBalls() {
   }
 }
 
+// True once per press, on the pass after it lands.
 bool checkButtonPressed() {
-  int reading = digitalRead(BUTTON_PIN);
-  if (reading != lastButtonState) {
-    lastButtonChange = millis();
-    lastButtonState = reading;
-  }
-
-  if (millis() - lastButtonChange > BUTTON_TAP_TIME) {
-    if (reading == LOW && !buttonHandled) {
-      buttonHandled = true;
-      return true;
-    }
-    if (reading == HIGH) {
-      buttonHandled = false;
-    }
-  }
-  return false;
+  button.update();
+  bool pressed = false;
+  ButtonEvent event;
+  while (button.next(event)) pressed |= event.kind == ButtonEventKind::kDown;
+  return pressed;
 }
 
 float sampleFieldAt(int x, int y) {
@@ -163,12 +162,15 @@ void interpolateEdge(float f1, float f2, int x1, int y1, int x2, int y2, int& ix
 
 void renderMetaballs() {
   display.clearDisplay();
+  uint8_t* frame = display.getBuffer();
   //display.drawRoundRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 4, SSD1306_WHITE);
+  int gridWidth = (SCREEN_WIDTH + renderSkip - 1) / renderSkip;
+  int gridHeight = (SCREEN_HEIGHT + renderSkip - 1) / renderSkip;
 
-  for (int gy = 0; gy < kGridHeight; ++gy) {
-    for (int gx = 0; gx < kGridWidth; ++gx) {
-      int sampleX = gx * kRenderSkip + kRenderSkip / 2;
-      int sampleY = gy * kRenderSkip + kRenderSkip / 2;
+  for (int gy = 0; gy < gridHeight; ++gy) {
+    for (int gx = 0; gx < gridWidth; ++gx) {
+      int sampleX = gx * renderSkip + renderSkip / 2;
+      int sampleY = gy * renderSkip + renderSkip / 2;
       sampleX = min(sampleX, SCREEN_WIDTH - 1);
       sampleY = min(sampleY, SCREEN_HEIGHT - 1);
 
@@ -176,10 +178,10 @@ void renderMetaballs() {
     }
   }
 
-  for (int gy = 0; gy < kGridHeight - 1; ++gy) {
-    for (int gx = 0; gx < kGridWidth - 1; ++gx) {
-      int cellX = gx * kRenderSkip + kRenderSkip / 2;
-      int cellY = gy * kRenderSkip + kRenderSkip / 2;
+  for (int gy = 0; gy < gridHeight - 1; ++gy) {
+    for (int gx = 0; gx < gridWidth - 1; ++gx) {
+      int cellX = gx * renderSkip + renderSkip / 2;
+      int cellY = gy * renderSkip + renderSkip / 2;
 
       float tl = fieldGrid[gy][gx];
       float tr = fieldGrid[gy][gx + 1];
@@ -192,38 +194,40 @@ void renderMetaballs() {
                       (bl > kFieldThreshold ? 1 : 0);
 
       int px[4], py[4];
-      interpolateEdge(tl, tr, cellX, cellY, cellX + kRenderSkip, cellY, px[0], py[0]); // top
-      interpolateEdge(tr, br, cellX + kRenderSkip, cellY, cellX + kRenderSkip, cellY + kRenderSkip, px[1], py[1]); // right
-      interpolateEdge(br, bl, cellX + kRenderSkip, cellY + kRenderSkip, cellX, cellY + kRenderSkip, px[2], py[2]); // bottom
-      interpolateEdge(bl, tl, cellX, cellY + kRenderSkip, cellX, cellY, px[3], py[3]); // left
+      interpolateEdge(tl, tr, cellX, cellY, cellX + renderSkip, cellY, px[0], py[0]); // top
+      interpolateEdge(tr, br, cellX + renderSkip, cellY, cellX + renderSkip, cellY + renderSkip, px[1], py[1]); // right
+      interpolateEdge(br, bl, cellX + renderSkip, cellY + renderSkip, cellX, cellY + renderSkip, px[2], py[2]); // bottom
+      interpolateEdge(bl, tl, cellX, cellY + renderSkip, cellX, cellY, px[3], py[3]); // left
 
       switch (caseIndex) {
-        case 1: display.drawLine(px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
-        case 2: display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 3: display.drawLine(px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
-        case 4: display.drawLine(px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
-        case 5: display.drawLine(px[3], py[3], px[0], py[0], SSD1306_WHITE); display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 6: display.drawLine(px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
-        case 7: display.drawLine(px[3], py[3], px[0], py[0], SSD1306_WHITE); break;
-        case 8: display.drawLine(px[0], py[0], px[3], py[3], SSD1306_WHITE); break;
-        case 9: display.drawLine(px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
-        case 10: display.drawLine(px[0], py[0], px[3], py[3], SSD1306_WHITE); display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 11: display.drawLine(px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
-        case 12: display.drawLine(px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
-        case 13: display.drawLine(px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
-        case 14: display.drawLine(px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
+        case 1: pageLine(frame, px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
+        case 2: pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+        case 3: pageLine(frame, px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
+        case 4: pageLine(frame, px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
+        case 5: pageLine(frame, px[3], py[3], px[0], py[0], SSD1306_WHITE); pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+        case 6: pageLine(frame, px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
+        case 7: pageLine(frame, px[3], py[3], px[0], py[0], SSD1306_WHITE); break;
+        case 8: pageLine(frame, px[0], py[0], px[3], py[3], SSD1306_WHITE); break;
+        case 9: pageLine(frame, px[0], py[0], px[2], py[2], SSD1306_WHITE); break;
+        case 10: pageLine(frame, px[0], py[0], px[3], py[3], SSD1306_WHITE); pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+        case 11: pageLine(frame, px[0], py[0], px[1], py[1], SSD1306_WHITE); break;
+        case 12: pageLine(frame, px[3], py[3], px[1], py[1], SSD1306_WHITE); break;
+        case 13: pageLine(frame, px[1], py[1], px[2], py[2], SSD1306_WHITE); break;
+        case 14: pageLine(frame, px[3], py[3], px[2], py[2], SSD1306_WHITE); break;
         // case 0 and 15: no lines
       }
     }
   }
-
-  display.display();
 }
 
 void setup() {
   Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
   randomSeed(esp_random());
-  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  button.begin();
+#if QUALITY_GOVERNOR
+  Serial.begin(115200);
+  governor.setLog(&Serial);
+#endif
 
   if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
     while (true) {
@@ -241,12 +245,17 @@ void loop() {
     resetBalls();
   }
 
-  unsigned long now = millis();
-  if (now - lastFrameTime < kFrameDelay) {
-    return;
+  int steps = frameClock.steps();
+  if (steps > 0) governor.begin();
+  for (int n = 0; n < steps; n++) updateBalls();
+  if (steps > 0) {
+    governor.updated();
+    renderMetaballs();
+    governor.rendered();
+    display.display();
+#if QUALITY_GOVERNOR
+    if (governor.flushed()) renderSkip = kRenderSkips[governor.level()];
+#endif
   }
-  lastFrameTime = now;
-
-  updateBalls();
-  renderMetaballs();
+  frameClock.sleep();
 }
\ No newline at end of file
@@ -7,6 +7,9 @@
 #define BUTTON_PIN 5 // D3
 #define BUTTON_TAP_TIME 20
 
+// draw ops recorded per frame (border, two paddles, ball)
+#define DISPLAY_OPS 8
+
 // globals
-#include <Adafruit_SSD1306.h>
-extern Adafruit_SSD1306 display;
\ No newline at end of file
+#include "page_renderer.h"
+extern PageRenderer display;
\ No newline at end of file
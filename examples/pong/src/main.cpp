@@ -2,8 +2,12 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "config.h"
+#include "ssd1306_bus.h"
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+WireBus bus(Wire);
+// records each frame's few shapes and renders them page by page into a
+// 128-byte buffer instead of keeping a 1 KB framebuffer
+PageRenderer display(bus, DISPLAY_OPS);
 
 // Game variables
 int ballX = SCREEN_WIDTH / 2;
@@ -22,6 +26,7 @@ void setup() {
 
   // Initialize display
   Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
+  bus.begin();
   if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
     for (;;);
   }
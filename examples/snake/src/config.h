@@ -7,6 +7,13 @@
 #define BUTTON_PIN 5 // D3
 #define BUTTON_TAP_TIME 20
 
+// snake moves per second, independent of how long a frame takes to draw
+#define STEP_HZ 40
+
+// print dirty-flush byte counts and missed frame deadlines over serial
+// every 100 frames
+#define FLUSH_STATS 0
+
 // globals
 #include <Adafruit_SSD1306.h>
 extern Adafruit_SSD1306 display;
\ No newline at end of file
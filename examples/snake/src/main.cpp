@@ -4,8 +4,16 @@
 #include <queue>
 #include <set>
 #include "config.h"
+#include "ssd1306_bus.h"
+#include "dirty_flush.h"
+#include "cell_canvas.h"
+#include "frame_clock.h"
 
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+WireBus bus(Wire);
+DirtyFlush flusher(bus); // sends only the spans that changed since the last frame
+CellCanvas cells(32, 16, 4); // one bit per 4x4 board cell
+FrameClock frameClock(1000000 / STEP_HZ);
 
 typedef std::pair<int, int> Pos;
 enum Dir { UP, DOWN, LEFT, RIGHT };
@@ -86,15 +94,26 @@ Dir getNextDir() {
   return dir;
 }
 
+void present() {
+  flusher.flush(display.getBuffer());
+#if FLUSH_STATS
+  if (flusher.frames() % 100 == 0) {
+    flusher.printStats(Serial);
+    frameClock.printStats(Serial);
+  }
+#endif
+}
+
 void draw() {
-  display.clearDisplay();
+  cells.fillScreen(SSD1306_BLACK);
   // draw snake
   for (auto p : snake) {
-    display.fillRect(p.first * 4, p.second * 4, 4, 4, SSD1306_WHITE);
+    cells.drawPixel(p.first, p.second, SSD1306_WHITE);
   }
   // draw food
-  display.fillRect(food.first * 4, food.second * 4, 4, 4, SSD1306_WHITE);
-  display.display();
+  cells.drawPixel(food.first, food.second, SSD1306_WHITE);
+  cells.blit(display.getBuffer());
+  present();
 }
 
 void reset() {
@@ -109,18 +128,16 @@ void reset() {
 void setup() {
   Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
   display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  bus.begin();
+#if FLUSH_STATS
+  Serial.begin(115200);
+#endif
   display.clearDisplay();
   randomSeed(analogRead(0));
   reset();
 }
 
-void loop() {
-  if (gameOver) {
-    reset();
-    delay(1000);
-  }
-  draw();
-  delay(20);
+void step() {
   Dir nextd = getNextDir();
   dir = nextd;
   Pos nh = moveHead(dir);
@@ -137,4 +154,16 @@ void loop() {
   } else {
     snake.pop_back();
   }
+}
+
+void loop() {
+  if (gameOver) {
+    reset();
+    delay(1000);
+    frameClock.restart();
+  }
+  int steps = frameClock.steps();
+  for (int n = 0; n < steps && !gameOver; n++) step();
+  if (steps > 0) draw();
+  frameClock.sleep();
 }
\ No newline at end of file
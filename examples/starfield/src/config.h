@@ -7,6 +7,25 @@
 #define BUTTON_PIN 5 // D3
 #define BUTTON_TAP_TIME 20
 
+// number of stars in the field
+#define NUM_STARS 500
+
+// erase and redraw only each star's last footprint instead of clearing the
+// frame, and flush only the damaged spans; 0 is the clear-and-redraw path
+#define SPRITE_REDRAW 1
+
+// starfield steps per second, independent of how long a frame takes to draw
+#define STEP_HZ 30
+
+// thin the field to as little as a quarter of NUM_STARS when frames run
+// over the step, and fill it back in when there is time, logging each
+// change over serial; 0 always draws NUM_STARS
+#define QUALITY_GOVERNOR 1
+
+// print flush byte counts and missed frame deadlines over serial every
+// 100 frames
+#define FLUSH_STATS 0
+
 // globals
 #include <Adafruit_SSD1306.h>
 extern Adafruit_SSD1306 display;
\ No newline at end of file
@@ -3,9 +3,13 @@
 #include <Adafruit_SSD1306.h>
 #include <Adafruit_GFX.h>
 #include "config.h"
+#include "ssd1306_bus.h"
+#include "dirty_flush.h"
+#include "sprite_layer.h"
+#include "frame_clock.h"
+#include "quality_governor.h"
 
 // Starfield parameters
-const int NUM_STARS = 100;
 const float SPEED = 0.01f;
 const float SCALE = 50.0f;
 
@@ -15,7 +19,22 @@ struct Star {
 
 Star stars[NUM_STARS];
 
+// Stars drawn per quality level, cheapest first: a quarter of NUM_STARS up
+// to all of them. Stars past activeStars stand still until they are drawn
+// again.
+#define QUALITY_LEVELS 4
+QualityGovernor governor(1000000 / STEP_HZ, QUALITY_LEVELS, QUALITY_LEVELS - 1);
+int activeStars = NUM_STARS;
+
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+WireBus bus(Wire);
+DirtyFlush flusher(bus); // sends only the spans that changed since the last frame
+FrameClock frameClock(1000000 / STEP_HZ);
+
+#if SPRITE_REDRAW
+SpriteFootprint footprints[NUM_STARS];
+SpriteLayer sprites(footprints, NUM_STARS); // attached to display's buffer in setup()
+#endif
 
 void initializeStars() {
     for (int i = 0; i < NUM_STARS; i++) {
@@ -26,7 +45,7 @@ void initializeStars() {
 }
 
 void updateStars() {
-    for (int i = 0; i < NUM_STARS; i++) {
+    for (int i = 0; i < activeStars; i++) {
         stars[i].z -= SPEED;
         if (stars[i].z <= 0.0f) {
             stars[i].x = random(-1000, 1000) / 1000.0f;
@@ -36,10 +55,44 @@ void updateStars() {
     }
 }
 
-void drawStars() {
+// Stars are drawn alpha of a step ahead of their last update, where they
+// are by the time the frame goes out when it runs late.
+#if SPRITE_REDRAW
+void drawStars(float alpha) {
+    // Every old footprint goes before any new one is drawn, so a star that
+    // moved off an overlapping one does not cut a hole in it.
+    sprites.eraseAll();
+    for (int i = 0; i < activeStars; i++) {
+        float z = stars[i].z - alpha * SPEED;
+        if (z <= 0.0f) z = stars[i].z; // due to respawn on the next step
+        int sx = SCREEN_WIDTH / 2 + (int)(stars[i].x / z * SCALE);
+        int sy = SCREEN_HEIGHT / 2 + (int)(stars[i].y / z * SCALE);
+        int size = (z < 0.5f) ? 2 : 1;
+        sprites.select(i);
+        if (sx >= 0 && sx < SCREEN_WIDTH && sy >= 0 && sy < SCREEN_HEIGHT) {
+            sprites.fillRect(sx, sy, size, size);
+        }
+    }
+}
+
+void present() {
+    flusher.flush(display.getBuffer(), sprites.firstCols(), sprites.lastCols());
+#if FLUSH_STATS
+    if (flusher.frames() % 100 == 0) {
+        flusher.printStats(Serial);
+        frameClock.printStats(Serial);
+        governor.printStats(Serial);
+        Serial.printf("sprites: %u frame bytes touched\n", (unsigned)sprites.touchedBytes());
+    }
+#endif
+    sprites.clearDamage();
+}
+#else
+void drawStars(float alpha) {
     display.clearDisplay();
-    for (int i = 0; i < NUM_STARS; i++) {
-        float z = stars[i].z;
+    for (int i = 0; i < activeStars; i++) {
+        float z = stars[i].z - alpha * SPEED;
+        if (z <= 0.0f) z = stars[i].z; // due to respawn on the next step
         int sx = SCREEN_WIDTH / 2 + (int)(stars[i].x / z * SCALE);
         int sy = SCREEN_HEIGHT / 2 + (int)(stars[i].y / z * SCALE);
         if (sx >= 0 && sx < SCREEN_WIDTH && sy >= 0 && sy < SCREEN_HEIGHT) {
@@ -47,23 +100,54 @@ void drawStars() {
             display.fillRect(sx, sy, size, size, SSD1306_WHITE);
         }
     }
-    display.display();
 }
 
+void present() {
+    flusher.flush(display.getBuffer());
+#if FLUSH_STATS
+    if (flusher.frames() % 100 == 0) {
+        flusher.printStats(Serial);
+        frameClock.printStats(Serial);
+        governor.printStats(Serial);
+    }
+#endif
+}
+#endif
+
 void setup() {
     randomSeed(analogRead(0));
     Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
     if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
         for (;;) ;
     }
+    bus.begin();
+#if FLUSH_STATS || QUALITY_GOVERNOR
+    Serial.begin(115200);
+#endif
     display.clearDisplay();
     display.display();
+#if SPRITE_REDRAW
+    sprites.attach(display.getBuffer());
+#endif
 
     initializeStars();
+#if QUALITY_GOVERNOR
+    governor.setLog(&Serial);
+#endif
 }
 
 void loop() {
-    updateStars();
-    drawStars();
-    delay(30);
+    int steps = frameClock.steps();
+    if (steps > 0) governor.begin();
+    for (int n = 0; n < steps; n++) updateStars();
+    if (steps > 0) {
+        governor.updated();
+        drawStars(frameClock.alpha());
+        governor.rendered();
+        present();
+#if QUALITY_GOVERNOR
+        if (governor.flushed()) activeStars = NUM_STARS * (governor.level() + 1) / QUALITY_LEVELS;
+#endif
+    }
+    frameClock.sleep();
 }
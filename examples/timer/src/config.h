@@ -10,6 +10,21 @@
 // NTP server
 #define NTP_SERVER "pool.ntp.org"
 
+// print dirty-flush byte counts, unchanged frames and scheduler slices and
+// idle time over serial every 100 frames
+#define FLUSH_STATS 0
+
+// /view page with a live canvas of the screen, fed by server-sent events
+// from /live; each viewer holds a connection and about 2 KB
+#define LIVE_VIEW 1
+#define LIVE_CLIENTS 2
+
+// scheduler periods, ms: DNS and HTTP, and button; the screen redraws when
+// the time shown changes, and at least every SCREEN_IDLE_MS
+#define NET_POLL_MS 2
+#define BUTTON_POLL_MS 10
+#define SCREEN_IDLE_MS 60000
+
 // globals
-#include <Adafruit_SSD1306.h>
-extern Adafruit_SSD1306 display;
\ No newline at end of file
+#include "glyph_blit.h"
+extern GlyphDisplay display;
\ No newline at end of file
@@ -6,8 +6,20 @@
 #include <DNSServer.h>
 #include <Preferences.h>
 #include "config.h"
+#include "ssd1306_bus.h"
+#include "dirty_flush.h"
+#include "compositor.h"
+#include "live_events.h"
+#include "coop_task.h"
+#include "button_input.h"
+#if LIVE_VIEW
+#include <lwip/sockets.h>
+#endif
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+GlyphDisplay display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1); // print() ORs font columns straight into the buffer
+WireBus bus(Wire);
+DirtyFlush flusher(bus); // sends only the spans that changed since the last frame
+Compositor layers; // border and label box, drawn once and ORed under each frame
 
 #define GAME_WIDTH 64
 #define GAME_HEIGHT 128
@@ -26,6 +38,71 @@ WebServer server(80);
 DNSServer dnsServer;
 const byte DNS_PORT = 53;
 
+// loop() is a scheduler pass: DNS and HTTP no longer wait behind the
+// screen, and the button is read every few milliseconds
+void serviceNetwork();
+void handleButton();
+uint32_t refreshScreen();
+
+// Redraws when what it shows next changes: the next second while running,
+// the next blink when done. Stopped or paused, nothing changes until a tap
+// or a new duration wakes it, so it sleeps up to SCREEN_IDLE_MS.
+class ScreenTask : public CoopTask {
+ public:
+  ScreenTask() : CoopTask("screen") {}
+
+ protected:
+  bool run() override {
+    sleepFor(refreshScreen());
+    return true;
+  }
+};
+
+Scheduler scheduler;
+PeriodicTask netTask("net", serviceNetwork, NET_POLL_MS);
+PeriodicTask buttonTask("button", handleButton, BUTTON_POLL_MS);
+ScreenTask screenTask;
+
+#if LIVE_VIEW
+// Viewers of /live, taken over from the web server and fed from present()
+struct LiveViewer {
+  WiFiClient client;
+  LiveEvents events;
+};
+LiveViewer viewers[LIVE_CLIENTS];
+char liveEvent[kLiveMaxEvent]; // one event at a time, shared by all viewers
+
+// Canvas page for /view. The events carry the panel in page order; the
+// timer draws rotated, so pixel (x, y) of the canvas is panel pixel
+// (127 - y, x).
+const char kLivePage[] =
+  "<!DOCTYPE html><html><head><meta name='viewport' content='width=device-width, initial-scale=1'>"
+  "<style>body { font-family: Arial; text-align: center; margin: 20px; background: #f0f0f0; }"
+  "canvas { width: 192px; height: 384px; image-rendering: pixelated; background: #000; }</style>"
+  "</head><body><h1>Timer</h1><canvas id='c' width='64' height='128'></canvas>"
+  "<script>"
+  "const f = new Uint8Array(1024), c = document.getElementById('c').getContext('2d');"
+  "const img = c.createImageData(64, 128);"
+  "function apply(b64, key) {"
+  " const t = atob(b64); if (key) f.fill(0);"
+  " for (let i = 0, p = 0; i < 1024 && p < t.length;) {"
+  "  const k = t.charCodeAt(p++); let n = (k < 128 ? k : k & 63) + 1;"
+  "  if (k < 128) i += n;"
+  "  else if (k < 192) while (n--) f[i++] ^= t.charCodeAt(p++);"
+  "  else { const b = t.charCodeAt(p++); while (n--) f[i++] ^= b; }"
+  " }"
+  " for (let y = 0; y < 128; y++) for (let x = 0; x < 64; x++) {"
+  "  const px = 127 - y, on = f[px + (x >> 3) * 128] >> (x & 7) & 1, o = (y * 64 + x) * 4;"
+  "  img.data[o] = img.data[o + 1] = img.data[o + 2] = on * 255; img.data[o + 3] = 255;"
+  " }"
+  " c.putImageData(img, 0, 0);"
+  "}"
+  "const es = new EventSource('/live');"
+  "es.addEventListener('k', e => apply(e.data, true));"
+  "es.addEventListener('d', e => apply(e.data, false));"
+  "</script></body></html>";
+#endif
+
 // Preferences for persistent storage
 Preferences prefs;
 
@@ -43,11 +120,43 @@ unsigned long timerStartTime = 0;
 unsigned long timerElapsedTime = 0;
 unsigned long timerRemainingTime = 0;
 
-// Button state
-bool lastButtonState = HIGH;
-unsigned long buttonPressTime = 0;
-bool buttonPressed = false;
+// Button, read by interrupt: tap to start/pause, hold to reset
 const unsigned long LONG_PRESS_TIME = 1000; // 1 second for reset
+ButtonInput button(BUTTON_PIN, BUTTON_TAP_TIME, LONG_PRESS_TIME);
+
+#if LIVE_VIEW
+// Send the frame to every viewer that has not seen it. A viewer whose
+// connection has gone, or cannot take a whole event, is dropped; the page
+// reconnects and starts again from a keyframe. WiFiClient::write() waits
+// for room in the socket for seconds, so one stalled browser would hold
+// up the loop; the event goes straight to the socket without blocking.
+void pushLive(const uint8_t* frame) {
+  for (LiveViewer& v : viewers) {
+    if (!v.client.connected()) continue;
+    size_t len = v.events.encode(frame, liveEvent);
+    if (len == 0) continue;
+    if (send(v.client.fd(), liveEvent, len, MSG_DONTWAIT) == (ssize_t)len) {
+      v.events.commit(frame);
+    } else {
+      v.client.stop();
+    }
+  }
+}
+#endif
+
+void present() {
+  flusher.flush(display.getBuffer());
+#if LIVE_VIEW
+  pushLive(display.getBuffer());
+#endif
+#if FLUSH_STATS
+  if (flusher.frames() % 100 == 0) {
+    flusher.printStats(Serial);
+    scheduler.printStats(Serial);
+    button.printStats(Serial);
+  }
+#endif
+}
 
 int drawCenteredText(String text, int y, int textSize, int maxWidth) {
   display.setTextSize(textSize);
@@ -150,7 +259,7 @@ void showBootScreen() {
   display.setCursor(textX, textY);
   display.println(bootText);
   
-  display.display();
+  present();
   delay(800);
 }
 
@@ -193,42 +302,27 @@ void resetTimer() {
 }
 
 void handleButton() {
-  bool currentButtonState = digitalRead(BUTTON_PIN);
-  
-  // Detect button press
-  if (currentButtonState == LOW && lastButtonState == HIGH) {
-    buttonPressed = true;
-    buttonPressTime = millis();
-  }
-  
-  // Check for long press while button is held
-  if (currentButtonState == LOW && buttonPressed) {
-    unsigned long pressDuration = millis() - buttonPressTime;
-    if (pressDuration >= LONG_PRESS_TIME) {
-      // Long press - reset timer immediately
+  button.update();
+  ButtonEvent event;
+  while (button.next(event)) {
+    screenTask.wake();
+    if (event.kind == ButtonEventKind::kLongPress) {
+      // Long press - reset timer while still held
       resetTimer();
-      buttonPressed = false; // Prevent further actions
-    }
-  }
-  
-  // Detect button release
-  if (currentButtonState == HIGH && lastButtonState == LOW) {
-    if (buttonPressed) {
-      // Short tap - start/pause timer or clear finished state
+    } else if (event.kind == ButtonEventKind::kTap) {
+      // Short tap - start/pause timer or clear finished state, timed from
+      // the release rather than from when this pass saw it
       if (timerState == TIMER_FINISHED) {
         resetTimer();
       } else if (timerState == TIMER_STOPPED || timerState == TIMER_PAUSED) {
         timerState = TIMER_RUNNING;
-        timerStartTime = millis() - timerElapsedTime;
+        timerStartTime = event.atMs - timerElapsedTime;
       } else if (timerState == TIMER_RUNNING) {
         timerState = TIMER_PAUSED;
-        timerElapsedTime = millis() - timerStartTime;
+        timerElapsedTime = event.atMs - timerStartTime;
       }
-      buttonPressed = false;
     }
   }
-  
-  lastButtonState = currentButtonState;
 }
 
 void updateTimer() {
@@ -252,16 +346,17 @@ void updateTimer() {
   }
 }
 
-void drawTimer() {
+// Static chrome: the border and the "Timer" label box. Drawn once into the
+// compositor's background layer.
+void drawChrome() {
   display.clearDisplay();
   display.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
-  
-  // Timer label
+
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
   int16_t x1, y1;
   uint16_t w, h;
-  
+
   String timerLabel = "Timer";
   display.getTextBounds(timerLabel, 0, 0, &x1, &y1, &w, &h);
   int labelY = 10; // Moved down from 5 to 10
@@ -277,6 +372,16 @@ void drawTimer() {
   display.setCursor(labelX, labelY);
   display.println(timerLabel);
   display.setTextColor(SSD1306_WHITE);
+
+  layers.setBackground(display.getBuffer());
+}
+
+void drawTimer() {
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+  int16_t x1, y1;
+  uint16_t w, h;
   
   // Time display with blinking for finished state
   bool shouldShow = true;
@@ -321,7 +426,8 @@ void drawTimer() {
   display.setCursor(stateX, stateY);
   display.println(stateStr);
   
-  display.display();
+  layers.compose(display.getBuffer(), display.getBuffer());
+  present();
 }
 
 void handleRoot() {
@@ -344,6 +450,9 @@ void handleRoot() {
   html += "<button type='submit'>Set Timer</button>";
   html += "</form>";
   html += "<div class='info' style='margin-top: 20px;'>Tap button: Start/Pause<br>Hold button: Reset</div>";
+#if LIVE_VIEW
+  html += "<div class='info'><a href='/view'>Live view</a></div>";
+#endif
   html += "</div></body></html>";
   server.send(200, "text/html", html);
 }
@@ -363,6 +472,7 @@ void handleSet() {
       
       // Reset timer with new duration
       resetTimer();
+      screenTask.wake();
       
       String html = "<!DOCTYPE html><html><head>";
       html += "<meta http-equiv='refresh' content='2;url=/'>";
@@ -380,9 +490,34 @@ void handleSet() {
   }
 }
 
+#if LIVE_VIEW
+void handleView() {
+  server.send_P(200, "text/html", kLivePage);
+}
+
+// Take the connection over from the web server, which drops its own copy
+// of the client once this returns, and stream events to it from present().
+void handleLive() {
+  for (LiveViewer& v : viewers) {
+    if (v.client.connected()) continue;
+    v.client = server.client();
+    v.client.setNoDelay(true);
+    v.client.print(kLiveResponseHead);
+    v.events.restart();
+    screenTask.wake(); // its first event is sent from the next present()
+    return;
+  }
+  server.send(503, "text/plain", "Too many viewers");
+}
+#endif
+
 void setupWebServer() {
   server.on("/", handleRoot);
   server.on("/set", handleSet);
+#if LIVE_VIEW
+  server.on("/view", handleView);
+  server.on("/live", handleLive);
+#endif
   server.on("/generate_204", handleRoot); // Android captive portal
   server.on("/fwlink", handleRoot); // Microsoft captive portal
   server.onNotFound(handleRoot); // Redirect all other requests to root
@@ -391,16 +526,20 @@ void setupWebServer() {
 
 void setup() {
   // Initialize button
-  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  button.begin();
   
   // Initialize display
   Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
   if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
     for (;;);
   }
+  bus.begin();
+#if FLUSH_STATS
+  Serial.begin(115200);
+#endif
   display.setRotation(1); // Rotate 90 degrees for vertical orientation
   display.clearDisplay();
-  display.display();
+  present();
 
   // Show boot screen
   showBootScreen();
@@ -412,29 +551,34 @@ void setup() {
   
   // Initialize timer state
   resetTimer();
+  drawChrome();
   
   // Start Access Point
   startAccessPoint();
   
   // Setup web server
   setupWebServer();
+
+  scheduler.add(netTask);
+  scheduler.add(buttonTask);
+  scheduler.add(screenTask);
 }
 
-void loop() {
-  // Handle DNS requests for captive portal
+void serviceNetwork() {
   dnsServer.processNextRequest();
-  
-  // Handle web server requests
   server.handleClient();
-  
-  // Handle button input
-  handleButton();
-  
-  // Update timer
+}
+
+// Draw the timer and return the ms until the screen would look different.
+uint32_t refreshScreen() {
   updateTimer();
-  
-  // Draw display
   drawTimer();
-  
-  delay(50); // Small delay for button debouncing
+  if (timerState == TIMER_RUNNING) return timerRemainingTime % 1000 + 1;
+  if (timerState == TIMER_FINISHED) return 500 - millis() % 500;
+  return SCREEN_IDLE_MS;
+}
+
+void loop() {
+  scheduler.runOnce();
+  scheduler.idle(NET_POLL_MS);
 }
\ No newline at end of file
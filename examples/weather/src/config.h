@@ -10,6 +10,10 @@
 // NTP server
 #define NTP_SERVER "pool.ntp.org"
 
+// print dirty-flush byte counts, unchanged frames and scheduler idle time
+// over serial every 10 frames
+#define FLUSH_STATS 0
+
 // globals
-#include <Adafruit_SSD1306.h>
-extern Adafruit_SSD1306 display;
\ No newline at end of file
+#include "glyph_blit.h"
+extern GlyphDisplay display;
\ No newline at end of file
@@ -5,9 +5,18 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <time.h>
+#include <sys/time.h>
 #include "config.h"
+#include "ssd1306_bus.h"
+#include "dirty_flush.h"
+#include "compositor.h"
+#include "coop_task.h"
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+GlyphDisplay display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1); // print() ORs font columns straight into the buffer
+WireBus bus(Wire);
+DirtyFlush flusher(bus); // sends only the spans that changed since the last frame
+Compositor layers; // border and label boxes, drawn once and ORed under each frame
+Scheduler scheduler; // tasks are declared further down
 
 #define GAME_WIDTH 64
 #define GAME_HEIGHT 128
@@ -167,6 +176,16 @@ String getWeatherDescription(int code) {
   }
 }
 
+void present() {
+  flusher.flush(display.getBuffer());
+#if FLUSH_STATS
+  if (flusher.frames() % 10 == 0) {
+    flusher.printStats(Serial);
+    scheduler.printStats(Serial);
+  }
+#endif
+}
+
 void showBootScreen() {
   display.clearDisplay();
   
@@ -193,62 +212,44 @@ void showBootScreen() {
   display.setCursor(textX, textY);
   display.println(bootText);
   
-  display.display();
+  present();
   delay(800);
 }
 
-void connectToWiFi() {
-  WiFi.begin(ssid, pass);
-  
-  int step = 0;
-  unsigned long lastDotUpdate = 0;
-  
-  while (WiFi.status() != WL_CONNECTED) {
-    unsigned long currentMillis = millis();
-    
-    // Update dots every 500ms
-    if (currentMillis - lastDotUpdate >= 500) {
-      display.clearDisplay();
-      
-      int dotCount = step % 4;
-      String connectingText = "WiFi";
-      for (int i = 0; i < dotCount; i++) {
-        connectingText += ".";
-      }
-      
-      display.setTextSize(1);
-      display.setTextColor(SSD1306_WHITE);
-      
-      int16_t x1, y1;
-      uint16_t w, h;
-      display.getTextBounds(connectingText, 0, 0, &x1, &y1, &w, &h);
-      
-      int textX = (GAME_WIDTH - w) / 2;
-      int textY = (GAME_HEIGHT - h) / 2;
-      
-      String maxText = "WiFi...";
-      display.getTextBounds(maxText, 0, 0, &x1, &y1, &w, &h);
-      int maxTextX = (GAME_WIDTH - w) / 2;
-      
-      int padding = 4;
-      int rectX = maxTextX - padding;
-      int rectY = textY - padding;
-      int rectW = w + (padding * 2);
-      int rectH = h + (padding * 2);
-      display.drawRoundRect(rectX, rectY, rectW, rectH, 2, SSD1306_WHITE);
-      
-      display.setCursor(textX, textY);
-      display.println(connectingText);
-      
-      display.display();
-      
-      step = (step + 1) % 4;
-      
-      lastDotUpdate = currentMillis;
-    }
-    
-    delay(100);
+// The "WiFi..." box with step dots, 0 to 3.
+void drawConnecting(int step) {
+  display.clearDisplay();
+
+  String connectingText = "WiFi";
+  for (int i = 0; i < step; i++) {
+    connectingText += ".";
   }
+
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+
+  int16_t x1, y1;
+  uint16_t w, h;
+  display.getTextBounds(connectingText, 0, 0, &x1, &y1, &w, &h);
+
+  int textX = (GAME_WIDTH - w) / 2;
+  int textY = (GAME_HEIGHT - h) / 2;
+
+  String maxText = "WiFi...";
+  display.getTextBounds(maxText, 0, 0, &x1, &y1, &w, &h);
+  int maxTextX = (GAME_WIDTH - w) / 2;
+
+  int padding = 4;
+  int rectX = maxTextX - padding;
+  int rectY = textY - padding;
+  int rectW = w + (padding * 2);
+  int rectH = h + (padding * 2);
+  display.drawRoundRect(rectX, rectY, rectW, rectH, 2, SSD1306_WHITE);
+
+  display.setCursor(textX, textY);
+  display.println(connectingText);
+
+  present();
 }
 
 String getWeather() {
@@ -302,50 +303,12 @@ void updateTime() {
   }
 }
 
-void setup() {
-  // Initialize display
-  Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
-  if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
-    for (;;);
-  }
-  display.setRotation(1); // Rotate 90 degrees for vertical orientation
-  display.clearDisplay();
-  display.display();
-
-  // Show boot screen
-  showBootScreen();
-
-  connectToWiFi();
-
-  detectTimezone();
-
-  configTime(gmtOffset_sec, daylightOffset_sec, NTP_SERVER);
-
-  getWeather();
-  updateTime();
-}
-
-void loop() {
-  static unsigned long lastWeatherUpdate = 0;
-  static unsigned long lastTimeUpdate = 0;
-
-  unsigned long now = millis();
-
-  if (now - lastWeatherUpdate > 180000) { // Update weather every 3 minutes
-    getWeather();
-    lastWeatherUpdate = now;
-  }
-
-  if (now - lastTimeUpdate > 1000) { // Update time every second
-    updateTime();
-    lastTimeUpdate = now;
-  }
-
-  // Draw display
+// Static chrome: the border and the three label boxes. Drawn once into the
+// compositor's background layer.
+void drawChrome() {
   display.clearDisplay();
   display.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
 
-  // Time on top
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
   int16_t x1, y1;
@@ -367,13 +330,6 @@ void loop() {
   display.println(timeLabel);
   display.setTextColor(SSD1306_WHITE);
 
-  display.setTextSize(2);
-  display.getTextBounds(currentTime, 0, 0, &x1, &y1, &w, &h);
-  int timeX = (GAME_WIDTH - w) / 2;
-  display.setCursor(timeX, 20);
-  display.println(currentTime);
-
-  display.setTextSize(1);
   String dateLabel = "Date";
   display.getTextBounds(dateLabel, 0, 0, &x1, &y1, &w, &h);
   int dateLabelY = 40;
@@ -390,6 +346,44 @@ void loop() {
   display.println(dateLabel);
   display.setTextColor(SSD1306_WHITE);
 
+  String weatherLabel = "Weather";
+  display.getTextBounds(weatherLabel, 0, 0, &x1, &y1, &w, &h);
+  int weatherLabelY = 68;
+  int weatherBoxW = 56;
+  int boxPadding = 2;
+  int boxX = (GAME_WIDTH - weatherBoxW) / 2;
+  int boxY = weatherLabelY - boxPadding;
+  int boxH = h + (boxPadding * 2);
+  display.fillRoundRect(boxX, boxY, weatherBoxW, boxH, 2, SSD1306_WHITE);
+  
+  int weatherLabelX = boxX + (weatherBoxW - w) / 2;
+  display.setTextColor(SSD1306_BLACK);
+  display.setCursor(weatherLabelX, weatherLabelY);
+  display.println(weatherLabel);
+  display.setTextColor(SSD1306_WHITE);
+
+  layers.setBackground(display.getBuffer());
+}
+
+void refreshScreen() {
+  updateTime();
+
+  // Draw display
+  display.clearDisplay();
+
+  // Time on top
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+  int16_t x1, y1;
+  uint16_t w, h;
+
+  display.setTextSize(2);
+  display.getTextBounds(currentTime, 0, 0, &x1, &y1, &w, &h);
+  int timeX = (GAME_WIDTH - w) / 2;
+  display.setCursor(timeX, 20);
+  display.println(currentTime);
+
+  display.setTextSize(1);
   // Get current date
   struct tm timeinfo;
   if (getLocalTime(&timeinfo)) {
@@ -414,23 +408,6 @@ void loop() {
     display.println(currentDate);
   }
 
-  display.setTextSize(1);
-  String weatherLabel = "Weather";
-  display.getTextBounds(weatherLabel, 0, 0, &x1, &y1, &w, &h);
-  int weatherLabelY = 68;
-  int weatherBoxW = 56;
-  int boxPadding = 2;
-  int boxX = (GAME_WIDTH - weatherBoxW) / 2;
-  int boxY = weatherLabelY - boxPadding;
-  int boxH = h + (boxPadding * 2);
-  display.fillRoundRect(boxX, boxY, weatherBoxW, boxH, 2, SSD1306_WHITE);
-  
-  int weatherLabelX = boxX + (weatherBoxW - w) / 2;
-  display.setTextColor(SSD1306_BLACK);
-  display.setCursor(weatherLabelX, weatherLabelY);
-  display.println(weatherLabel);
-  display.setTextColor(SSD1306_WHITE);
-
   String desc = weatherDescription.length() == 0 ? "Loading weather..." : weatherDescription;
   if (desc.length() > 25) desc = desc.substring(0, 25) + "...";
   int weatherHeight = drawCenteredText(desc, 85, 1, GAME_WIDTH);
@@ -455,7 +432,97 @@ void loop() {
     display.setTextSize(1);
   }
 
-  display.display();
+  layers.compose(display.getBuffer(), display.getBuffer());
+  present();
+}
+
+// ms until the clock shows the next minute; a second while it is not set.
+uint32_t msToNextMinute() {
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+  if (now.tv_sec < 1600000000) return 1000;
+  return 60000 - (now.tv_sec % 60) * 1000 - now.tv_usec / 1000;
+}
+
+// Redraws as the minute turns and when new weather comes in, and sleeps in
+// between; the screen shows nothing finer than minutes.
+class ScreenTask : public CoopTask {
+ public:
+  ScreenTask() : CoopTask("screen") {}
+
+ protected:
+  bool run() override {
+    refreshScreen();
+    sleepFor(msToNextMinute());
+    return true;
+  }
+};
+
+ScreenTask screenTask;
+
+void fetchWeather() {
+  getWeather();
+  screenTask.wake();
+}
+
+PeriodicTask weatherTask("weather", fetchWeather, 180000); // every 3 minutes
+
+// Joins the network with the dots animating, then sets the clock and
+// hands over to the weather and screen tasks.
+class ConnectTask : public CoopTask {
+ public:
+  ConnectTask() : CoopTask("connect") {}
+
+ protected:
+  bool run() override {
+    TASK_BEGIN();
+    WiFi.begin(ssid, pass);
+    while (WiFi.status() != WL_CONNECTED) {
+      if (millis() - _drawnAt >= 500) {
+        drawConnecting(_step);
+        _step = (_step + 1) % 4;
+        _drawnAt = millis();
+      }
+      TASK_SLEEP(100);
+    }
+    detectTimezone();
+    TASK_YIELD();
+    configTime(gmtOffset_sec, daylightOffset_sec, NTP_SERVER);
+    drawChrome();
+    scheduler.add(weatherTask);
+    scheduler.add(screenTask);
+    TASK_END();
+  }
+
+ private:
+  int _step = 0;
+  unsigned long _drawnAt = 0;
+};
+
+ConnectTask connectTask;
+
+void setup() {
+  // Initialize display
+  Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
+  if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
+    for (;;);
+  }
+  bus.begin();
+#if FLUSH_STATS
+  Serial.begin(115200);
+#endif
+  display.setRotation(1); // Rotate 90 degrees for vertical orientation
+  display.clearDisplay();
+  present();
+
+  // Show boot screen
+  showBootScreen();
+
+  scheduler.add(connectTask);
+}
 
-  delay(1000);
+void loop() {
+  scheduler.runOnce();
+  // Nothing here needs polling, so sleep until the next task is due.
+  scheduler.idle(60000);
 }
\ No newline at end of file
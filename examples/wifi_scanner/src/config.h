@@ -7,6 +7,16 @@
 #define BUTTON_PIN 5 // D3
 #define BUTTON_TAP_TIME 20
 
+// marquee: characters visible in a scrolling row, and ms per 1 px step
+#define MARQUEE_CHARS 9
+#define SCROLL_STEP_MS 40
+// longest the loop sleeps with nothing scrolling; a button edge ends it
+#define IDLE_MAX_MS 10000
+
+// print dirty-flush byte counts, unchanged frames and idle time over serial
+// every 100 frames
+#define FLUSH_STATS 0
+
 // NTP server
 #define NTP_SERVER "pool.ntp.org"
 
@@ -6,8 +6,14 @@
 #include <string>
 #include <map>
 #include "config.h"
+#include "text_strip.h"
+#include "ssd1306_bus.h"
+#include "dirty_flush.h"
+#include "button_input.h"
 
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+WireBus bus(Wire);
+DirtyFlush flusher(bus); // sends only the spans that changed since the last frame
 
 #define GAME_WIDTH 64
 #define GAME_HEIGHT 128
@@ -28,21 +34,85 @@ struct AP {
   int rssi;
   int channel;
   int enc;
+  TextStrip ssid_strip; // rendered once per scan
 };
 
 std::vector<AP> aps;
 int current_index = 0;
 int state = 0; // 0: list, 1: detail
-int last_button_state = HIGH;
-unsigned long press_start = 0;
 bool force_scan = false;
 int start_index = 0;
 int scroll_pos = 0;
 unsigned long last_scroll = 0;
 int detail_index = 0;
-bool long_press_triggered = false;
 bool is_scanning = false;
 
+// Button, read by interrupt: tap for the next item, hold 1 second to open,
+// rescan or go back
+ButtonInput button(BUTTON_PIN, BUTTON_TAP_TIME, 1000);
+
+// Text rendered once and blitted every frame; scrolling moves the window
+// offset instead of slicing Strings.
+TextStrip aps_strip;
+TextStrip marker_strip;
+TextStrip bold_marker_strip;
+TextStrip rescan_strip;
+TextStrip scan_strip;
+TextStrip label_strips[5];
+TextStrip detail_strips[5]; // values of the AP being inspected
+
+const char* encName(int enc) {
+  switch (enc) {
+    case WIFI_AUTH_OPEN: return "Open";
+    case WIFI_AUTH_WEP: return "WEP";
+    case WIFI_AUTH_WPA_PSK: return "WPA";
+    case WIFI_AUTH_WPA2_PSK: return "WPA2";
+    case WIFI_AUTH_WPA_WPA2_PSK: return "WPA+WPA2";
+    case WIFI_AUTH_WPA2_ENTERPRISE: return "WPA2-EAP";
+    case WIFI_AUTH_WPA3_PSK: return "WPA3";
+    case WIFI_AUTH_WPA2_WPA3_PSK: return "WPA2+WPA3";
+    case WIFI_AUTH_WAPI_PSK: return "WAPI";
+    default: return "Unknown";
+  }
+}
+
+void renderStaticStrips() {
+  static const char* labels[5] = {"SSID", "BSSID", "RSSI", "Channel", "Encryption"};
+  for (int i = 0; i < 5; i++) label_strips[i].render(labels[i], 1, true);
+  marker_strip.render(">", 1);
+  bold_marker_strip.render(">", 1, true);
+  rescan_strip.render("* Rescan", 1, true);
+  scan_strip.render("Scanning..", 1);
+}
+
+void renderListStrips() {
+  char line[16];
+  snprintf(line, sizeof(line), "APs: %u", (unsigned)aps.size());
+  aps_strip.render(line, 1, true);
+  for (AP &ap : aps) ap.ssid_strip.render(ap.ssid.c_str(), 1);
+}
+
+void renderDetailStrips(const AP &ap) {
+  char num[12];
+  detail_strips[0].render(ap.ssid.c_str(), 1);
+  detail_strips[1].render(ap.bssid.c_str(), 1);
+  snprintf(num, sizeof(num), "%d", ap.rssi);
+  detail_strips[2].render(num, 1);
+  snprintf(num, sizeof(num), "%d", ap.channel);
+  detail_strips[3].render(num, 1);
+  detail_strips[4].render(encName(ap.enc), 1);
+}
+
+void present() {
+  flusher.flush(display.getBuffer());
+#if FLUSH_STATS
+  if (flusher.frames() % 100 == 0) {
+    flusher.printStats(Serial);
+    button.printStats(Serial);
+  }
+#endif
+}
+
 void showBootScreen() {
   display.clearDisplay();
   display.setTextSize(1);
@@ -68,7 +138,7 @@ void showBootScreen() {
   display.println(wifiText);
   display.setCursor(textX2, textY2);
   display.println(scannerText);
-  display.display();
+  present();
   delay(800);
 }
 
@@ -81,9 +151,11 @@ void setup() {
   if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
     for (;;);
   }
+  bus.begin();
   display.setRotation(1); // Rotate 90 degrees for vertical orientation
   display.clearDisplay();
-  display.display();
+  present();
+  renderStaticStrips();
 
   // Show boot screen
   showBootScreen();
@@ -93,7 +165,7 @@ void setup() {
   WiFi.disconnect();
   delay(100);
 
-  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  button.begin();
 
   // Initial scan
   Serial.println("Initial scan...");
@@ -103,6 +175,7 @@ void setup() {
     aps.push_back(ap);
   }
   WiFi.scanDelete();
+  renderListStrips();
   Serial.printf("Found %d networks\n", n);
 }
 
@@ -117,6 +190,7 @@ void loop() {
       aps.push_back(ap);
     }
     WiFi.scanDelete();
+    renderListStrips();
     Serial.printf("Found %d networks\n", n);
     force_scan = false;
     is_scanning = false;
@@ -124,27 +198,22 @@ void loop() {
   }
 
   // Handle button
-  int button_state = digitalRead(BUTTON_PIN);
-  if (button_state == LOW && last_button_state == HIGH) {
-    press_start = millis();
-    long_press_triggered = false;
-  }
-  if (button_state == LOW && !long_press_triggered && millis() - press_start > 1000) {
-    // Trigger long press immediately
-    long_press_triggered = true;
-    if (state == 0 && current_index < aps.size()) {
-      state = 1; // enter detail
-      detail_index = 0;
-    } else if (state == 0 && current_index == aps.size()) {
-      force_scan = true; // rescan
-      is_scanning = true;
-    } else if (state == 1) {
-      state = 0; // back from detail
-    }
-  }
-  if (button_state == HIGH && last_button_state == LOW) {
-    unsigned long press_duration = millis() - press_start;
-    if (press_duration <= 1000) { // short press
+  button.update();
+  ButtonEvent event;
+  while (button.next(event)) {
+    if (event.kind == ButtonEventKind::kLongPress) {
+      // Reported as soon as the hold reaches a second
+      if (state == 0 && current_index < aps.size()) {
+        state = 1; // enter detail
+        detail_index = 0;
+        renderDetailStrips(aps[current_index]);
+      } else if (state == 0 && current_index == aps.size()) {
+        force_scan = true; // rescan
+        is_scanning = true;
+      } else if (state == 1) {
+        state = 0; // back from detail
+      }
+    } else if (event.kind == ButtonEventKind::kTap) {
       if (state == 0) {
         int total_items = aps.size() + 1; // +1 for rescan
         current_index = (current_index + 1) % total_items;
@@ -154,9 +223,7 @@ void loop() {
         state = 0; // back to list
       }
     }
-    // Long press already handled above
   }
-  last_button_state = button_state;
 
   // Adjust start_index for scrolling list
   int total_items = aps.size() + 1;
@@ -168,37 +235,14 @@ void loop() {
   if (start_index < 0) start_index = 0;
   if (start_index > total_items - 10) start_index = max(0, total_items - 10);
 
-  // Scroll text for selected item
-  if (((state == 0 && current_index < aps.size()) || (state == 1 && current_index < aps.size())) && aps.size() > 0 && millis() - last_scroll > 200) {
-    String text_to_scroll;
-    if (state == 0) {
-      text_to_scroll = aps[current_index].ssid;
-    } else {
-      AP ap = aps[current_index];
-      switch (detail_index) {
-        case 0: text_to_scroll = ap.ssid; break;
-        case 1: text_to_scroll = ap.bssid; break;
-        case 2: text_to_scroll = String(ap.rssi); break;
-        case 3: text_to_scroll = String(ap.channel); break;
-        case 4: {
-          switch (ap.enc) {
-            case WIFI_AUTH_OPEN: text_to_scroll = "Open"; break;
-            case WIFI_AUTH_WEP: text_to_scroll = "WEP"; break;
-            case WIFI_AUTH_WPA_PSK: text_to_scroll = "WPA"; break;
-            case WIFI_AUTH_WPA2_PSK: text_to_scroll = "WPA2"; break;
-            case WIFI_AUTH_WPA_WPA2_PSK: text_to_scroll = "WPA+WPA2"; break;
-            case WIFI_AUTH_WPA2_ENTERPRISE: text_to_scroll = "WPA2-EAP"; break;
-            case WIFI_AUTH_WPA3_PSK: text_to_scroll = "WPA3"; break;
-            case WIFI_AUTH_WPA2_WPA3_PSK: text_to_scroll = "WPA2+WPA3"; break;
-            case WIFI_AUTH_WAPI_PSK: text_to_scroll = "WAPI"; break;
-            default: text_to_scroll = "Unknown"; break;
-          }
-          break;
-        }
-      }
-    }
-    if (text_to_scroll.length() > 9) {
-      scroll_pos = (scroll_pos + 1) % (text_to_scroll.length() - 8);
+  // Scroll the selected item's text one pixel per step
+  const TextStrip *scrolling = nullptr;
+  if (!aps.empty() && current_index < aps.size()) {
+    scrolling = state == 0 ? &aps[current_index].ssid_strip : &detail_strips[detail_index];
+  }
+  if (scrolling && millis() - last_scroll > SCROLL_STEP_MS) {
+    if (scrolling->length() > MARQUEE_CHARS) {
+      scroll_pos = (scroll_pos + 1) % ((scrolling->length() - MARQUEE_CHARS) * 6 + 1);
     } else {
       scroll_pos = 0;
     }
@@ -210,172 +254,64 @@ void loop() {
   display.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
 
   if (is_scanning) {
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    display.setTextWrap(false);
-    String scan_msg = "Scanning..";
-    int16_t x1, y1;
-    uint16_t w, h;
-    display.getTextBounds(scan_msg, 0, 0, &x1, &y1, &w, &h);
-    int center_x = (GAME_WIDTH - w) / 2;
-    int center_y = (GAME_HEIGHT - h) / 2;
-    display.setCursor(center_x, center_y);
-    display.printf("%s", scan_msg.c_str());
-  } else {
-    // Normal display code
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    display.setTextWrap(false);
+    int center_x = (GAME_WIDTH - scan_strip.textWidth()) / 2;
+    int center_y = (GAME_HEIGHT - 8) / 2;
+    scan_strip.blit(display, center_x, center_y);
+  } else if (state == 0) { // List view
+    int y = 5;
+    aps_strip.blit(display, 5, y);
+    y += 10;
 
-    if (state == 0) { // List view
-      int y = 5;
-      String aps_line = "APs: " + String(aps.size());
-      display.setCursor(5, y);
-      display.printf("%s", aps_line.c_str());
-      display.setCursor(6, y); // offset for bold
-      display.printf("%s", aps_line.c_str());
-      y += 10;
-
-      int num_to_show = 10;
-      int total_items = aps.size() + 1;
-      for (int i = 0; i < num_to_show && start_index + i < total_items; ++i) {
-        int idx = start_index + i;
-        display.setCursor(5, y);
-        if (idx < aps.size()) {
-          String ssid = aps[idx].ssid;
-          if (idx == current_index) {
-            String display_ssid;
-            if (ssid.length() > 9) {
-              display_ssid = ssid.substring(scroll_pos, scroll_pos + 9);
-            } else {
-              display_ssid = ssid;
-            }
-            display.printf(">%s", display_ssid.c_str());
-          } else {
-            if (ssid.length() > 9) ssid = ssid.substring(0, 9);
-            display.printf(" %s", ssid.c_str());
-          }
-        } else {
-          // Rescan option
-          if (idx == current_index) {
-            display.setCursor(5, y);
-            display.printf(">* Rescan");
-            display.setCursor(6, y);
-            display.printf(">* Rescan");
-          } else {
-            display.setCursor(5, y);
-            display.printf(" * Rescan");
-            display.setCursor(6, y);
-            display.printf(" * Rescan");
-          }
-        }
-        y += 10;
+    int num_to_show = 10;
+    int total_items = aps.size() + 1;
+    for (int i = 0; i < num_to_show && start_index + i < total_items; ++i) {
+      int idx = start_index + i;
+      bool selected = idx == current_index;
+      if (idx < aps.size()) {
+        if (selected) marker_strip.blit(display, 5, y);
+        aps[idx].ssid_strip.blit(display, 11, y, selected ? scroll_pos : 0, MARQUEE_CHARS * 6);
+      } else {
+        // Rescan option
+        if (selected) bold_marker_strip.blit(display, 5, y);
+        rescan_strip.blit(display, 11, y);
       }
-    } else { // Detail view
-      if (current_index < aps.size()) {
-        AP ap = aps[current_index];
-        int y = 5;
-        int16_t x1, y1;
-        uint16_t w, h;
-        int center_x;
-        // SSID
-        String label_ssid = detail_index == 0 ? ">SSID" : "SSID";
-        display.getTextBounds(label_ssid, 0, 0, &x1, &y1, &w, &h);
-        center_x = (GAME_WIDTH - w) / 2;
-        display.setCursor(center_x, y);
-        display.printf("%s", label_ssid.c_str());
-        display.setCursor(center_x + 1, y);
-        display.printf("%s", label_ssid.c_str());
-        y += 10;
-        display.setCursor(5, y);
-        String ssid_val = ap.ssid;
-        String display_ssid = (detail_index == 0 && ssid_val.length() > 9) ? ssid_val.substring(scroll_pos, scroll_pos + 9) : ssid_val;
-        display.getTextBounds(display_ssid, 0, 0, &x1, &y1, &w, &h);
-        center_x = (GAME_WIDTH - w) / 2;
-        display.setCursor(center_x, y);
-        display.printf("%s", display_ssid.c_str());
-        y += 10;
-        // BSSID
-        String label_bssid = detail_index == 1 ? ">BSSID" : "BSSID";
-        display.getTextBounds(label_bssid, 0, 0, &x1, &y1, &w, &h);
-        center_x = (GAME_WIDTH - w) / 2;
-        display.setCursor(center_x, y);
-        display.printf("%s", label_bssid.c_str());
-        display.setCursor(center_x + 1, y);
-        display.printf("%s", label_bssid.c_str());
-        y += 10;
-        display.setCursor(5, y);
-        String bssid_val = ap.bssid;
-        String display_bssid = (detail_index == 1 && bssid_val.length() > 9) ? bssid_val.substring(scroll_pos, scroll_pos + 9) : bssid_val;
-        display.getTextBounds(display_bssid, 0, 0, &x1, &y1, &w, &h);
-        center_x = (GAME_WIDTH - w) / 2;
-        display.setCursor(center_x, y);
-        display.printf("%s", display_bssid.c_str());
-        y += 10;
-        // RSSI
-        String label_rssi = detail_index == 2 ? ">RSSI" : "RSSI";
-        display.getTextBounds(label_rssi, 0, 0, &x1, &y1, &w, &h);
-        center_x = (GAME_WIDTH - w) / 2;
-        display.setCursor(center_x, y);
-        display.printf("%s", label_rssi.c_str());
-        display.setCursor(center_x + 1, y);
-        display.printf("%s", label_rssi.c_str());
-        y += 10;
-        display.setCursor(5, y);
-        String rssi_str = String(ap.rssi);
-        display.getTextBounds(rssi_str, 0, 0, &x1, &y1, &w, &h);
-        center_x = (GAME_WIDTH - w) / 2;
-        display.setCursor(center_x, y);
-        display.printf("%s", rssi_str.c_str());
-        y += 10;
-        // Channel
-        String label_ch = detail_index == 3 ? ">Channel" : "Channel";
-        display.getTextBounds(label_ch, 0, 0, &x1, &y1, &w, &h);
-        center_x = (GAME_WIDTH - w) / 2;
-        display.setCursor(center_x, y);
-        display.printf("%s", label_ch.c_str());
-        display.setCursor(center_x + 1, y);
-        display.printf("%s", label_ch.c_str());
-        y += 10;
-        display.setCursor(5, y);
-        String ch_str = String(ap.channel);
-        display.getTextBounds(ch_str, 0, 0, &x1, &y1, &w, &h);
-        center_x = (GAME_WIDTH - w) / 2;
-        display.setCursor(center_x, y);
-        display.printf("%s", ch_str.c_str());
-        y += 10;
-        // Encryption
-        String label_enc = detail_index == 4 ? ">Encryption" : "Encryption";
-        display.getTextBounds(label_enc, 0, 0, &x1, &y1, &w, &h);
-        center_x = (GAME_WIDTH - w) / 2;
-        display.setCursor(center_x, y);
-        display.printf("%s", label_enc.c_str());
-        display.setCursor(center_x + 1, y);
-        display.printf("%s", label_enc.c_str());
-        y += 10;
-        display.setCursor(5, y);
-        String enc_str;
-        switch (ap.enc) {
-          case WIFI_AUTH_OPEN: enc_str = "Open"; break;
-          case WIFI_AUTH_WEP: enc_str = "WEP"; break;
-          case WIFI_AUTH_WPA_PSK: enc_str = "WPA"; break;
-          case WIFI_AUTH_WPA2_PSK: enc_str = "WPA2"; break;
-          case WIFI_AUTH_WPA_WPA2_PSK: enc_str = "WPA+WPA2"; break;
-          case WIFI_AUTH_WPA2_ENTERPRISE: enc_str = "WPA2-EAP"; break;
-          case WIFI_AUTH_WPA3_PSK: enc_str = "WPA3"; break;
-          case WIFI_AUTH_WPA2_WPA3_PSK: enc_str = "WPA2+WPA3"; break;
-          case WIFI_AUTH_WAPI_PSK: enc_str = "WAPI"; break;
-          default: enc_str = "Unknown"; break;
-        }
-        String display_enc = (detail_index == 4 && enc_str.length() > 9) ? enc_str.substring(scroll_pos, scroll_pos + 9) : enc_str;
-        display.getTextBounds(display_enc, 0, 0, &x1, &y1, &w, &h);
-        center_x = (GAME_WIDTH - w) / 2;
-        display.setCursor(center_x, y);
-        display.printf("%s", display_enc.c_str());
+      y += 10;
+    }
+  } else if (current_index < aps.size()) { // Detail view
+    int y = 5;
+    for (int i = 0; i < 5; i++) {
+      // Label, centred the way ">Label" / "Label" measures
+      bool selected = detail_index == i;
+      const TextStrip &label = label_strips[i];
+      int label_w = (label.length() + (selected ? 1 : 0)) * 6;
+      int label_x = (GAME_WIDTH - label_w) / 2;
+      if (selected) {
+        bold_marker_strip.blit(display, label_x, y);
+        label_x += 6;
       }
+      label.blit(display, label_x, y);
+      y += 10;
+
+      // Value, scrolled through a MARQUEE_CHARS window when selected
+      const TextStrip &value = detail_strips[i];
+      bool marquee = selected && value.length() > MARQUEE_CHARS;
+      int value_w = marquee ? MARQUEE_CHARS * 6 : value.textWidth();
+      value.blit(display, (GAME_WIDTH - value_w) / 2, y, marquee ? scroll_pos : 0, marquee ? MARQUEE_CHARS * 6 : 0);
+      y += 10;
     }
   }
 
-  display.display();
-  delay(100);
+  present();
+
+  // Nothing changes on screen until the marquee's next step or a button
+  // edge, so sleep until one of them instead of redrawing every few ms.
+  // A selection left scrolled is stepped back to the start too.
+  uint32_t idle = IDLE_MAX_MS;
+  if (force_scan) {
+    idle = 0;
+  } else if (scrolling && (scrolling->length() > MARQUEE_CHARS || scroll_pos != 0)) {
+    unsigned long since = millis() - last_scroll;
+    idle = since > SCROLL_STEP_MS ? 0 : SCROLL_STEP_MS + 1 - since;
+  }
+  button.wait(idle);
 }
\ No newline at end of file
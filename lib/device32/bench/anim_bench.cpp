@@ -0,0 +1,124 @@
+// Host round trip and throughput check for anim_stream.h. Renders two
+// synthetic sequences (a starfield and a scrolling checkerboard, sparse and
+// dense deltas), encodes them the way tools/anim_encode.cpp does, writes
+// the stream to a file and plays it back through AnimSource's mmap() path,
+// comparing every decoded frame over two loops. Then times decoding.
+//
+//   g++ -O2 -std=gnu++11 -Isrc bench/anim_bench.cpp src/anim_stream.cpp -o anim_bench
+//   ./anim_bench
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "anim_stream.h"
+
+static void setPixel(uint8_t* frame, int x, int y) {
+  if (x < 0 || x >= kPanelWidth || y < 0 || y >= kPanelHeight) return;
+  frame[x + (y / 8) * kPanelWidth] |= 1 << (y & 7);
+}
+
+static std::vector<uint8_t> starfield(int count) {
+  std::vector<uint8_t> frames((size_t)count * kFrameBytes);
+  struct Star { float x, y, z; } stars[100];
+  srand(3);
+  for (auto& s : stars) {
+    s.x = (rand() % 2000 - 1000) / 1000.0f;
+    s.y = (rand() % 2000 - 1000) / 1000.0f;
+    s.z = (100 + rand() % 900) / 1000.0f;
+  }
+  for (int n = 0; n < count; n++) {
+    uint8_t* frame = &frames[(size_t)n * kFrameBytes];
+    for (auto& s : stars) {
+      s.z -= 0.01f;
+      if (s.z <= 0.0f) s.z = 1.0f;
+      int sx = 64 + (int)(s.x / s.z * 50), sy = 32 + (int)(s.y / s.z * 50);
+      int size = s.z < 0.5f ? 2 : 1;
+      for (int dy = 0; dy < size; dy++)
+        for (int dx = 0; dx < size; dx++) setPixel(frame, sx + dx, sy + dy);
+    }
+  }
+  return frames;
+}
+
+static std::vector<uint8_t> checkerboard(int count) {
+  std::vector<uint8_t> frames((size_t)count * kFrameBytes);
+  for (int n = 0; n < count; n++) {
+    uint8_t* frame = &frames[(size_t)n * kFrameBytes];
+    for (int y = 0; y < kPanelHeight; y++)
+      for (int x = 0; x < kPanelWidth; x++)
+        if ((((x + n) / 8) ^ ((y + n / 2) / 8)) & 1) setPixel(frame, x, y);
+  }
+  return frames;
+}
+
+static std::vector<uint8_t> encode(const std::vector<uint8_t>& frames, int count) {
+  std::vector<uint8_t> out(kAnimHeaderBytes);
+  static uint8_t black[kFrameBytes];
+  uint8_t delta[kFrameBytes + kFrameBytes / 64];
+  AnimHeader header = {(uint16_t)count, 33, 0, 0};
+  for (int n = 0; n <= count; n++) {
+    if (n == 1) header.loopOffset = out.size();
+    const uint8_t* prev = n == 0 ? black : &frames[(size_t)(n - 1) * kFrameBytes];
+    size_t len = animEncodeDelta(prev, &frames[(size_t)(n % count) * kFrameBytes], delta);
+    out.insert(out.end(), delta, delta + len);
+  }
+  header.size = out.size();
+  animWriteHeader(header, out.data());
+  return out;
+}
+
+int main() {
+  const char* path = "/tmp/anim_bench.bin";
+  const int count = 300;
+  int mismatches = 0;
+
+  struct { const char* name; std::vector<uint8_t> frames; } clips[] = {
+    {"starfield", starfield(count)},
+    {"checkerboard", checkerboard(count)},
+  };
+  for (auto& clip : clips) {
+    std::vector<uint8_t> stream = encode(clip.frames, count);
+    FILE* f = fopen(path, "wb");
+    fwrite(stream.data(), 1, stream.size(), f);
+    fclose(f);
+
+    AnimSource source;
+    AnimPlayer player;
+    if (!source.open(path) || !player.begin(source.data(), source.size())) {
+      printf("%s: could not open stream\n", clip.name);
+      return 1;
+    }
+
+    static uint8_t frame[kFrameBytes];
+    memset(frame, 0, kFrameBytes);
+    for (int n = 0; n < 2 * count; n++) {
+      if (!player.next(frame) || player.frameIndex() != n % count ||
+          memcmp(frame, &clip.frames[(size_t)(n % count) * kFrameBytes], kFrameBytes) != 0) {
+        mismatches++;
+      }
+    }
+
+    const int rounds = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < rounds; n++) player.next(frame);
+    double decode = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+    start = std::chrono::steady_clock::now();
+    for (int n = 0; n < rounds; n++) {
+      memcpy(frame, &clip.frames[(size_t)(n % count) * kFrameBytes], kFrameBytes);
+      __asm__ __volatile__("" : : "r"(frame) : "memory");
+    }
+    double copy = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+
+    printf("%-12s %4zu B/frame (%4.1f%% of raw), decode %5.2f us/frame, raw memcpy %5.2f us/frame\n",
+           clip.name, stream.size() / count, 100.0 * stream.size() / ((double)count * kFrameBytes),
+           decode, copy);
+  }
+
+  remove(path);
+  printf("%d mismatching frames\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+// Host check for async_flush.h. AsyncFlush runs its sender on a
+// std::thread here, in front of a mock Ssd1306Bus whose writeWindow()
+// sleeps for the wire time of its bytes and logs when it starts and ends.
+// Every frame fills the panel with its own number, so each window says
+// which frame it came from. The loop "renders" by sleeping and presents
+// each frame. The log must show that:
+//
+//   - present() never returns while the previous frame is still being
+//     read out of the send buffer, and the bytes on the wire never change
+//     under a send;
+//   - fence() returns only once the bus is idle;
+//   - rendering frame N+1 overlaps the send of frame N;
+//   - an unchanged frame is dropped at once, even while a send is busy.
+//
+//   g++ -O2 -std=gnu++11 -pthread -Isrc -Ibench/host bench/async_bench.cpp src/async_flush.cpp src/dirty_flush.cpp src/ssd1306_bus.cpp -o async_bench
+//   ./async_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "async_flush.h"
+
+static const unsigned kMicrosPerByte = 10;  // ~900 kHz I2C, 9 bits a byte
+static const unsigned kRenderMicros = 6000;
+static const int kFrames = 24;
+
+struct Send {
+  int frame;
+  unsigned long start, end;
+};
+
+class SlowBus : public Ssd1306Bus {
+ public:
+  std::mutex lock;
+  std::vector<Send> sends;  // one per window
+  std::atomic<int> busy{0};
+  std::atomic<bool> torn{false};
+
+  void commands(const uint8_t*, size_t) override {}
+  void data(const uint8_t*, size_t) override {}
+  void writeWindow(uint8_t, uint8_t, uint8_t, uint8_t, const uint8_t* bytes, size_t len) override {
+    busy++;
+    unsigned long start = micros();
+    int frame = bytes[0];
+    // Shift the bytes out a slice at a time, checking none change under us.
+    for (size_t at = 0; at < len; at += 32) {
+      delayMicroseconds(32 * kMicrosPerByte);
+      for (size_t i = 0; i < len; i++)
+        if (bytes[i] != frame) torn = true;
+    }
+    unsigned long end = micros();
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      sends.push_back({frame, start, end});
+    }
+    _transactions++;
+    _bytes += len;
+    busy--;
+  }
+
+  // Start and end of everything sent for frame.
+  bool span(int frame, unsigned long* start, unsigned long* end) {
+    std::lock_guard<std::mutex> guard(lock);
+    bool found = false;
+    for (const Send& s : sends) {
+      if (s.frame != frame) continue;
+      if (!found || s.start < *start) *start = s.start;
+      if (!found || s.end > *end) *end = s.end;
+      found = true;
+    }
+    return found;
+  }
+};
+
+struct Frame {
+  unsigned long renderStart, renderEnd, presented;
+};
+
+int main() {
+  SlowBus bus;
+  DirtyFlush flusher(bus);
+  AsyncFlush async(flusher);
+  async.begin();
+
+  uint8_t frame[kFrameBytes];
+  std::vector<Frame> frames;
+  int failures = 0;
+
+  // Frame n fills the panel with n + 1, so every page changes every frame.
+  unsigned long skipWorst = 0;
+  for (int n = 0; n < kFrames; n++) {
+    Frame f;
+    f.renderStart = micros();
+    delayMicroseconds(kRenderMicros);
+    memset(frame, n + 1, sizeof(frame));
+    f.renderEnd = micros();
+    async.present(frame);
+    f.presented = micros();
+    frames.push_back(f);
+    if (n % 4 == 3) {
+      // Same frame again, straight away: the last one is still sending.
+      unsigned long start = micros();
+      async.present(frame);
+      unsigned long took = micros() - start;
+      if (took > skipWorst) skipWorst = took;
+    }
+  }
+  async.fence();
+  unsigned long fenced = micros();
+  bool idle = bus.busy == 0;
+
+  // present(N) may only return once frame N-1 is fully sent.
+  int early = 0;
+  for (int n = 1; n < kFrames; n++) {
+    unsigned long start = 0, end = 0;
+    if (!bus.span(n, &start, &end) || frames[n].presented < end) early++;
+  }
+  bool ok = early == 0 && !bus.torn;
+  printf("%-40s %s: %d early returns%s\n", "present waits for the previous send",
+         ok ? "ok" : "FAIL", early, bus.torn ? ", send buffer changed mid-send" : "");
+  failures += !ok;
+
+  unsigned long lastStart = 0, lastEnd = 0;
+  bool sent = bus.span(kFrames, &lastStart, &lastEnd);
+  ok = sent && idle && fenced >= lastEnd;
+  printf("%-40s %s: returned %ld us after the last byte\n", "fence waits for an idle bus",
+         ok ? "ok" : "FAIL", (long)(fenced - lastEnd));
+  failures += !ok;
+
+  // Frame N's send (bytes n + 1) must overlap rendering of frame N+1.
+  int overlapped = 0;
+  unsigned long hidden = 0;
+  for (int n = 0; n + 1 < kFrames; n++) {
+    unsigned long start = 0, end = 0;
+    if (!bus.span(n + 1, &start, &end)) continue;
+    unsigned long from = start > frames[n + 1].renderStart ? start : frames[n + 1].renderStart;
+    unsigned long to = end < frames[n + 1].renderEnd ? end : frames[n + 1].renderEnd;
+    if (from < to) {
+      overlapped++;
+      hidden += to - from;
+    }
+  }
+  ok = overlapped == kFrames - 1;
+  printf("%-40s %s: %d of %d frames, %lu us of send hidden\n", "render N+1 overlaps send of N",
+         ok ? "ok" : "FAIL", overlapped, kFrames - 1, hidden);
+  failures += !ok;
+
+  ok = async.skipped() == kFrames / 4 && skipWorst < 1000;
+  printf("%-40s %s: %u skipped, slowest %lu us\n", "unchanged frame dropped without waiting",
+         ok ? "ok" : "FAIL", (unsigned)async.skipped(), skipWorst);
+  failures += !ok;
+
+  unsigned long total = fenced - frames[0].renderStart;
+  unsigned long serial = 0;
+  for (int n = 0; n < kFrames; n++) {
+    unsigned long start = 0, end = 0;
+    if (bus.span(n + 1, &start, &end)) serial += end - start;
+  }
+  serial += kFrames * kRenderMicros;
+  printf("%d frames in %lu us; render + send back to back would take %lu us\n", kFrames, total, serial);
+
+  printf("%d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
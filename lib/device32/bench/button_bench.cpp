@@ -0,0 +1,182 @@
+// Host check for button_events.h. Scripted edge timings for each gesture,
+// then a long random session: a clean press sequence is fed once with
+// every edge on time and polled every millisecond, and once with contact
+// bounce on every edge and polled at frame-like random intervals. The two
+// must give the same events with the same timestamps. A third pass polls
+// only at edges and when msUntilDue() says something runs out, as a loop
+// sleeping in ButtonInput::wait() does, and must give them too.
+//
+//   g++ -O2 -std=gnu++11 -Isrc bench/button_bench.cpp src/button_events.cpp -o button_bench
+//   ./button_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "button_events.h"
+
+static const char* name(ButtonEventKind kind) {
+  switch (kind) {
+    case ButtonEventKind::kDown: return "down";
+    case ButtonEventKind::kTap: return "tap";
+    case ButtonEventKind::kDoubleTap: return "double";
+    case ButtonEventKind::kLongPress: return "long";
+  }
+  return "?";
+}
+
+static std::string drain(ButtonRecognizer& r) {
+  std::string out;
+  ButtonEvent e;
+  char item[32];
+  while (r.next(e)) {
+    snprintf(item, sizeof(item), "%s%s@%u", out.empty() ? "" : " ", name(e.kind), (unsigned)e.atMs);
+    out += item;
+  }
+  return out;
+}
+
+// Script: "d120" edge down at 120, "u300" edge up, "p400" poll at 400.
+static std::string run(ButtonRecognizer r, const char* script) {
+  for (const char* p = script; *p;) {
+    char op = *p++;
+    uint32_t t = strtoul(p, const_cast<char**>(&p), 10);
+    if (op == 'd' || op == 'u') r.edge(op == 'd', t);
+    if (op == 'p') r.poll(t);
+    while (*p == ' ') p++;
+  }
+  return drain(r);
+}
+
+struct Case {
+  const char* what;
+  uint16_t doubleMs;
+  const char* script;
+  const char* expect;
+};
+
+static const Case kCases[] = {
+  {"clean tap", 0, "d0 u120 p121", "down@0 tap@120"},
+  {"bouncing tap", 0, "d0 u2 d4 u7 d9 p30 u150 d152 u155 p200", "down@0 tap@150"},
+  {"release bounces back inside the window", 0, "d0 u10 p25", "down@0 tap@20"},
+  {"long press while held", 0, "d0 p999 p1000 u1500 p1600", "down@0 long@1000"},
+  {"long press seen only at release", 0, "d0 u1200 p1300", "down@0 long@1000"},
+  {"double tap", 250, "d0 u100 d200 u300 p301", "down@0 down@200 double@300"},
+  {"tap held back for the window", 250, "d0 u100 p349 p350", "down@0 tap@100"},
+  {"two slow taps", 250, "d0 u100 p360 d500 u600 p900", "down@0 tap@100 down@500 tap@600"},
+  {"window ran out with no poll", 250, "d0 u100 d400 u450 p800", "down@0 tap@100 down@400 tap@450"},
+  {"tap then hold", 250, "d0 u100 d200 p1200 u1500", "down@0 down@200 tap@100 long@1200"},
+  {"taps off: tap at once", 0, "d0 u100 d200 u300 p301", "down@0 tap@100 down@200 tap@300"},
+};
+
+// A clean session: alternating press and gap lengths.
+static std::vector<uint32_t> session(int presses) {
+  std::vector<uint32_t> edges;
+  uint32_t t = 100;
+  for (int i = 0; i < presses; i++) {
+    edges.push_back(t);
+    t += rand() % 4 == 0 ? 900 + rand() % 600 : 40 + rand() % 260;  // some holds
+    edges.push_back(t);
+    t += 40 + rand() % 500;
+  }
+  return edges;
+}
+
+int main() {
+  int failures = 0;
+  for (const Case& c : kCases) {
+    std::string got = run(ButtonRecognizer(20, 1000, c.doubleMs), c.script);
+    bool ok = got == c.expect;
+    printf("%-40s %s%s%s\n", c.what, ok ? "ok" : "FAIL: ", ok ? "" : got.c_str(),
+           ok ? "" : (std::string(" (want ") + c.expect + ")").c_str());
+    failures += !ok;
+  }
+
+  srand(5);
+  std::vector<uint32_t> edges = session(2000);
+  uint32_t end = edges.back() + 2000;
+  ButtonRecognizer clean(20, 1000, 250), bouncy(20, 1000, 250);
+  std::string want, got;
+
+  size_t next = 0;
+  for (uint32_t t = 0; t <= end; t++) {
+    while (next < edges.size() && edges[next] == t) clean.edge(next++ % 2 == 0, t);
+    clean.poll(t);
+    want += drain(clean) + " ";
+  }
+
+  // Each edge comes with a burst of up to 5 bounces over the next 11 ms; polls
+  // come 1 to 80 ms apart, as a busy frame loop would see them.
+  std::vector<std::pair<uint32_t, bool> > noisy;
+  for (size_t i = 0; i < edges.size(); i++) {
+    bool down = i % 2 == 0;
+    noisy.push_back(std::make_pair(edges[i], down));
+    int bounces = rand() % 6;
+    uint32_t t = edges[i];
+    for (int b = 0; b < bounces; b++) {
+      t += 1 + rand() % 2;
+      noisy.push_back(std::make_pair(t, b % 2 == 0 ? !down : down));
+    }
+    if (bounces % 2) noisy.push_back(std::make_pair(t + 1, down));
+  }
+  next = 0;
+  int polls = 0;
+  for (uint32_t t = 0; t <= end;) {
+    while (next < noisy.size() && noisy[next].first <= t) {
+      bouncy.edge(noisy[next].second, noisy[next].first);
+      next++;
+    }
+    bouncy.poll(t);
+    got += drain(bouncy) + " ";
+    polls++;
+    t += 1 + rand() % 80;
+  }
+
+  auto squash = [](std::string s) {
+    std::string out;
+    for (size_t i = 0; i < s.size(); i++)
+      if (!(s[i] == ' ' && (out.empty() || out.back() == ' '))) out += s[i];
+    return out;
+  };
+  want = squash(want);
+  got = squash(got);
+  bool same = want == got;
+  int events = 0;
+  for (char ch : want) events += ch == '@';
+  printf("%-40s %s: %d events from %u edges (%u bounces dropped) over %d polls\n", "random session, bounce + late polls",
+         same ? "ok" : "FAIL", events, (unsigned)noisy.size(), (unsigned)bouncy.bounces(), polls);
+  if (!same) {
+    size_t i = 0;
+    while (i < want.size() && i < got.size() && want[i] == got[i]) i++;
+    printf("  first difference near: want ...%s\n                          got  ...%s\n",
+           want.substr(i > 40 ? i - 40 : 0, 80).c_str(), got.substr(i > 40 ? i - 40 : 0, 80).c_str());
+  }
+  failures += !same + (bouncy.lost() != 0) + (clean.lost() != 0);
+
+  ButtonRecognizer sleepy(20, 1000, 250);
+  std::string slept;
+  next = 0;
+  int wakes = 0;
+  for (uint32_t t = 0; t <= end;) {
+    while (next < noisy.size() && noisy[next].first <= t) {
+      sleepy.edge(noisy[next].second, noisy[next].first);
+      next++;
+    }
+    sleepy.poll(t);
+    slept += drain(sleepy) + " ";
+    wakes++;
+    uint32_t wake = next < noisy.size() ? noisy[next].first : end + 1;
+    uint32_t due = sleepy.msUntilDue(t);
+    if (due != UINT32_MAX && t + due < wake) wake = t + due;
+    t = wake > t ? wake : t + 1;
+  }
+  slept = squash(slept);
+  same = want == slept;
+  printf("%-40s %s: %d wakes\n", "same session, woken by msUntilDue", same ? "ok" : "FAIL", wakes);
+  failures += !same;
+
+  printf("%d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
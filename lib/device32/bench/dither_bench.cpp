@@ -0,0 +1,125 @@
+// Host benchmark for ditherField() against fluid_cloud's renderMetaballs()
+// output loop (clear, then threshold plus checkerboard glow through a
+// per-pixel drawPixel). The field is a metaball field like the scene's.
+// Also checks that a degenerate dither (lo == hi) matches a plain
+// threshold, and that the fixed-point path matches the float one.
+//
+//   g++ -O2 -std=gnu++11 -Isrc bench/dither_bench.cpp src/field_dither.cpp -o dither_bench
+//   ./dither_bench
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "field_dither.h"
+
+// Adafruit_SSD1306::drawPixel() as shipped, for rotation 0, kept out of
+// line as it is when called through the library's vtable.
+struct GfxPanel {
+  uint8_t buffer[kFrameBytes];
+
+  virtual ~GfxPanel() {}
+  __attribute__((noinline)) virtual void drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || x >= kPanelWidth || y < 0 || y >= kPanelHeight) return;
+    switch (color) {
+      case kWhite: buffer[x + (y / 8) * kPanelWidth] |= (1 << (y & 7)); break;
+      case kBlack: buffer[x + (y / 8) * kPanelWidth] &= ~(1 << (y & 7)); break;
+      case kInverse: buffer[x + (y / 8) * kPanelWidth] ^= (1 << (y & 7)); break;
+    }
+  }
+};
+
+static const float kThreshold = 10.0f;
+static const int W = kPanelWidth, H = kPanelHeight;
+static float field[W * H];
+static uint16_t fixedField[W * H];
+
+// 24 balls of radius 5-12 spread over the lower two thirds, as seeded by
+// fluid_cloud, with its influence cut-off of 3 radii.
+static void makeField(int seed) {
+  srand(seed);
+  memset(field, 0, sizeof(field));
+  for (int p = 0; p < 24; p++) {
+    float px = 10 + rand() % 108, py = 16 + rand() % 44, r = 5 + rand() % 7;
+    int x0 = fmaxf(0, px - 3 * r), x1 = fminf(W - 1, px + 3 * r);
+    int y0 = fmaxf(0, py - 3 * r), y1 = fminf(H - 1, py + 3 * r);
+    for (int y = y0; y <= y1; y++) {
+      for (int x = x0; x <= x1; x++) {
+        float dx = x + 0.5f - px, dy = y + 0.5f - py;
+        field[y * W + x] += r * r / (dx * dx + dy * dy + 0.0001f);
+      }
+    }
+  }
+  for (int i = 0; i < W * H; i++) fixedField[i] = fminf(field[i] * 256.0f, 65535.0f);
+}
+
+static void renderMetaballsLoop(GfxPanel* gfx) {
+  memset(gfx->buffer, 0, kFrameBytes);
+  float glowThresh = kThreshold * 0.4f;
+  for (int y = 0; y < H; y++) {
+    for (int x = 0; x < W; x++) {
+      float v = field[y * W + x];
+      if (v >= kThreshold) {
+        gfx->drawPixel(x, y, kWhite);
+      } else if (v >= glowThresh) {
+        if (((x ^ y) & 1) == 0) gfx->drawPixel(x, y, kWhite);
+      }
+    }
+  }
+}
+
+template <typename F>
+static double microsPerFrame(int rounds, F render) {
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) render();
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main() {
+  const int rounds = 2000;
+  GfxPanel* gfx = new GfxPanel();
+  static uint8_t frame[kFrameBytes], check[kFrameBytes];
+  int mismatches = 0;
+
+  for (int seed = 1; seed <= 20; seed++) {
+    makeField(seed);
+    // lo == hi: every threshold is lo, so the dither is a plain v > lo test
+    ditherField(frame, field, W, H, kThreshold, kThreshold);
+    memset(check, 0, kFrameBytes);
+    for (int y = 0; y < H; y++) {
+      for (int x = 0; x < W; x++) {
+        if (field[y * W + x] > kThreshold) check[x + (y / 8) * W] |= 1 << (y & 7);
+      }
+    }
+    if (memcmp(frame, check, kFrameBytes) != 0) mismatches++;
+    ditherField(frame, field, W, H, 0.0f, 256.0f, DitherMatrix::kBlueNoise);
+    ditherField(check, fixedField, W, H, 0, 65535, DitherMatrix::kBlueNoise);
+    int differing = 0;
+    for (int i = 0; i < kFrameBytes; i++) differing += frame[i] != check[i];
+    if (differing > kFrameBytes / 100) mismatches++;  // rounding at the thresholds only
+  }
+
+  makeField(1);
+  float glow = kThreshold * 0.4f;
+  double before = microsPerFrame(rounds, [&] { renderMetaballsLoop(gfx); });
+  printf("renderMetaballs loop   %7.1f us/frame\n", before);
+  struct { const char* name; DitherMatrix matrix; } kinds[] = {
+    {"bayer 4x4", DitherMatrix::kBayer4},
+    {"bayer 8x8", DitherMatrix::kBayer8},
+    {"blue noise", DitherMatrix::kBlueNoise},
+  };
+  for (auto& k : kinds) {
+    double f = microsPerFrame(rounds, [&] { ditherField(frame, field, W, H, glow, kThreshold, k.matrix); });
+    double q = microsPerFrame(rounds, [&] {
+      ditherField(frame, fixedField, W, H, glow * 256, kThreshold * 256, k.matrix);
+    });
+    printf("ditherField %-10s %7.1f us/frame float (%.1fx), %7.1f us/frame fixed (%.1fx)\n",
+           k.name, f, before / f, q, before / q);
+  }
+
+  printf("%d mismatching frames\n", mismatches);
+  delete gfx;
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+// Host check for dirty_flush.h. A recording Ssd1306Bus logs every
+// writeWindow() DirtyFlush makes; scripted damage is applied to a frame
+// and the log must hold exactly the expected column/page windows with the
+// expected byte counts, the bytes of the frame inside them, and one batch
+// per frame that sends anything. Covers the first full resend, unchanged
+// frames, invalidate(), and the damage-span overload.
+//
+//   g++ -O2 -std=gnu++11 -Isrc -Ibench/host bench/flush_bench.cpp src/dirty_flush.cpp src/ssd1306_bus.cpp -o flush_bench
+//   ./flush_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "dirty_flush.h"
+
+struct Window {
+  int col0, col1, page0, page1;
+  size_t len;
+};
+
+// Logs windows instead of framing them; commands() and data() outside a
+// window (none are expected from DirtyFlush) are counted as stray.
+class RecordingBus : public Ssd1306Bus {
+ public:
+  std::vector<Window> windows;
+  const uint8_t* frame = nullptr;  // the frame being flushed
+  int batches = 0;
+  int stray = 0;
+  bool contentOk = true;
+  bool open = false;
+
+  void commands(const uint8_t*, size_t) override { stray++; }
+  void data(const uint8_t*, size_t) override { stray++; }
+  void writeWindow(uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1,
+                   const uint8_t* bytes, size_t len) override {
+    windows.push_back({col0, col1, page0, page1, len});
+    // Horizontal addressing: rows of the window, one after another.
+    size_t at = 0;
+    for (int page = page0; page <= page1; page++) {
+      for (int col = col0; col <= col1; col++, at++) {
+        if (at >= len || bytes[at] != frame[page * kPanelWidth + col]) contentOk = false;
+      }
+    }
+    if (at != len) contentOk = false;
+    _transactions++;
+    _bytes += len;
+  }
+  void beginBatch() override {
+    if (open) stray++;
+    open = true;
+  }
+  void endBatch() override {
+    if (!open) stray++;
+    open = false;
+    batches++;
+  }
+  void reset() {
+    windows.clear();
+    batches = 0;
+    stray = 0;
+    contentOk = true;
+  }
+};
+
+static std::string describe(const std::vector<Window>& windows) {
+  std::string out;
+  char item[48];
+  for (const Window& w : windows) {
+    snprintf(item, sizeof(item), "%s[c%d-%d p%d-%d %uB]", out.empty() ? "" : " ", w.col0, w.col1,
+             w.page0, w.page1, (unsigned)w.len);
+    out += item;
+  }
+  return out.empty() ? "(none)" : out;
+}
+
+static void setPixel(uint8_t* frame, int x, int y, bool on) {
+  uint8_t bit = (uint8_t)(1 << (y & 7));
+  if (on) frame[x + (y / 8) * kPanelWidth] |= bit;
+  else frame[x + (y / 8) * kPanelWidth] &= ~bit;
+}
+
+static void fillRect(uint8_t* frame, int x, int y, int w, int h, bool on) {
+  for (int j = y; j < y + h; j++)
+    for (int i = x; i < x + w; i++) setPixel(frame, i, j, on);
+}
+
+struct Step {
+  const char* what;
+  std::vector<Window> want;
+  int batches;
+  uint32_t skipped;  // running total after the step
+};
+
+int main() {
+  RecordingBus bus;
+  DirtyFlush flusher(bus);
+  uint8_t frame[kFrameBytes];
+  memset(frame, 0, sizeof(frame));
+  int failures = 0;
+
+  // One damage span per page, for the overload.
+  uint8_t first[kPanelPages], last[kPanelPages];
+
+  auto run = [&](const Step& step, size_t sent) {
+    bool ok = describe(bus.windows) == describe(step.want) && bus.batches == step.batches &&
+              bus.stray == 0 && bus.contentOk && flusher.skipped() == step.skipped;
+    size_t want = 0;
+    for (const Window& w : step.want) want += w.len;
+    ok = ok && sent == want && flusher.lastFrameBytes() == want && bus.bytesSent() == want;
+    // firstCol/lastCol report the same windows, page by page.
+    for (int page = 0; page < kPanelPages && ok; page++) {
+      const Window* hit = nullptr;
+      for (const Window& w : step.want)
+        if (page >= w.page0 && page <= w.page1) hit = &w;
+      if (hit) ok = flusher.firstCol(page) == hit->col0 && flusher.lastCol(page) == hit->col1;
+      else ok = flusher.firstCol(page) > flusher.lastCol(page);
+    }
+    printf("%-40s %s", step.what, ok ? "ok" : "FAIL");
+    if (!ok) {
+      printf(": want %s, %d batch(es), %u skipped\n%-40s   got %s, %d batch(es), %u skipped, %u B sent%s%s",
+             describe(step.want).c_str(), step.batches, (unsigned)step.skipped, "",
+             describe(bus.windows).c_str(), bus.batches, (unsigned)flusher.skipped(), (unsigned)sent,
+             bus.contentOk ? "" : ", wrong bytes", bus.stray ? ", stray calls" : "");
+    }
+    printf("\n");
+    failures += !ok;
+    bus.reset();
+    bus.resetCounters();
+  };
+
+  auto flush = [&]() {
+    bus.frame = frame;
+    return flusher.flush(frame);
+  };
+  auto flushSpans = [&]() {
+    bus.frame = frame;
+    return flusher.flush(frame, first, last);
+  };
+
+  run({"first frame: full resend", {{0, 127, 0, 7, 1024}}, 0, 0}, flush());
+  run({"same frame: nothing sent", {}, 0, 1}, flush());
+
+  setPixel(frame, 10, 20, true);
+  run({"one pixel", {{10, 10, 2, 2, 1}}, 1, 1}, flush());
+
+  fillRect(frame, 30, 12, 8, 14, true);  // rows 12..25: pages 1..3
+  run({"rect over three pages", {{30, 37, 1, 1, 8}, {30, 37, 2, 2, 8}, {30, 37, 3, 3, 8}}, 1, 1},
+      flush());
+
+  setPixel(frame, 5, 36, true);
+  setPixel(frame, 100, 39, true);
+  run({"two changes on a page: one span", {{5, 100, 4, 4, 96}}, 1, 1}, flush());
+
+  // Cleared again: the diff is against what was sent, not against blank.
+  fillRect(frame, 30, 12, 8, 14, false);
+  setPixel(frame, 10, 20, true);  // already on
+  run({"rect erased", {{30, 37, 1, 1, 8}, {30, 37, 2, 2, 8}, {30, 37, 3, 3, 8}}, 1, 1}, flush());
+
+  // Bytes rewritten with the same value inside the damage are trimmed.
+  frame[6 * kPanelWidth + 70] = 0x81;
+  frame[6 * kPanelWidth + 72] = 0x18;
+  for (int page = 0; page < kPanelPages; page++) {
+    first[page] = 1;
+    last[page] = 0;
+  }
+  first[6] = 60;
+  last[6] = 90;
+  run({"damage spans: trimmed to change", {{70, 72, 6, 6, 3}}, 1, 1}, flushSpans());
+  run({"damage spans, nothing changed", {}, 0, 2}, flushSpans());
+
+  fillRect(frame, 0, 0, 128, 64, true);
+  run({"whole panel lit", {{0, 127, 0, 0, 128}, {0, 127, 1, 1, 128}, {0, 127, 2, 2, 128},
+                           {0, 127, 3, 3, 128}, {0, 127, 4, 4, 128}, {0, 127, 5, 5, 128},
+                           {0, 127, 6, 6, 128}, {0, 127, 7, 7, 128}}, 1, 2},
+      flush());
+
+  flusher.invalidate();
+  run({"invalidate: full resend of same frame", {{0, 127, 0, 7, 1024}}, 0, 2}, flush());
+  run({"then unchanged again", {}, 0, 3}, flush());
+
+  bool counted = flusher.frames() == 11 && flusher.totalBytes() == 1024 + 1 + 24 + 96 + 24 + 3 + 1024 + 1024;
+  printf("%-40s %s: %u frames, %u B\n", "totals", counted ? "ok" : "FAIL",
+         (unsigned)flusher.frames(), (unsigned)flusher.totalBytes());
+  failures += !counted;
+
+  printf("%d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
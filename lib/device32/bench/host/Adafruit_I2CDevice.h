@@ -0,0 +1,4 @@
+#pragma once
+
+// Empty: Adafruit_GFX.h includes it for the SPITFT classes, which the
+// benches do not build.
@@ -0,0 +1,77 @@
+#pragma once
+
+// Host stand-in for Adafruit_SSD1306: the command constants, and, when
+// Adafruit GFX is on the include path, the framebuffer half of the class
+// with drawPixel(), clearDisplay() and getBuffer() as the library ships
+// them. Nothing reaches a panel.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+
+#define SSD1306_MEMORYMODE 0x20
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+#define SSD1306_SETCONTRAST 0x81
+#define SSD1306_CHARGEPUMP 0x8D
+#define SSD1306_SEGREMAP 0xA0
+#define SSD1306_DISPLAYALLON_RESUME 0xA4
+#define SSD1306_NORMALDISPLAY 0xA6
+#define SSD1306_SETMULTIPLEX 0xA8
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+#define SSD1306_COMSCANDEC 0xC8
+#define SSD1306_SETDISPLAYOFFSET 0xD3
+#define SSD1306_SETDISPLAYCLOCKDIV 0xD5
+#define SSD1306_SETPRECHARGE 0xD9
+#define SSD1306_SETCOMPINS 0xDA
+#define SSD1306_SETVCOMDETECT 0xDB
+#define SSD1306_SETSTARTLINE 0x40
+#define SSD1306_DEACTIVATE_SCROLL 0x2E
+
+#define SSD1306_EXTERNALVCC 0x01
+#define SSD1306_SWITCHCAPVCC 0x02
+
+#if __has_include(<Adafruit_GFX.h>)
+#include <Adafruit_GFX.h>
+
+#ifndef _swap_int16_t
+#define _swap_int16_t(a, b) { int16_t t = a; a = b; b = t; }
+#endif
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+ public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h) : Adafruit_GFX(w, h) {
+    buffer = (uint8_t*)calloc(w * ((h + 7) / 8), 1);
+  }
+  ~Adafruit_SSD1306() { free(buffer); }
+
+  bool begin(uint8_t = SSD1306_SWITCHCAPVCC, uint8_t = 0) { return true; }
+  void display() {}
+  void clearDisplay() { memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8)); }
+  uint8_t* getBuffer() { return buffer; }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if ((x >= 0) && (x < width()) && (y >= 0) && (y < height())) {
+      switch (getRotation()) {
+        case 1: _swap_int16_t(x, y); x = WIDTH - x - 1; break;
+        case 2: x = WIDTH - x - 1; y = HEIGHT - y - 1; break;
+        case 3: _swap_int16_t(x, y); y = HEIGHT - y - 1; break;
+      }
+      switch (color) {
+        case SSD1306_WHITE: buffer[x + (y / 8) * WIDTH] |= (1 << (y & 7)); break;
+        case SSD1306_BLACK: buffer[x + (y / 8) * WIDTH] &= ~(1 << (y & 7)); break;
+        case SSD1306_INVERSE: buffer[x + (y / 8) * WIDTH] ^= (1 << (y & 7)); break;
+      }
+    }
+  }
+
+ protected:
+  uint8_t* buffer;
+};
+
+#endif
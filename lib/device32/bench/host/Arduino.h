@@ -0,0 +1,73 @@
+#pragma once
+
+// Host stand-in for the parts of the Arduino core the benches' library
+// sources use: fixed-width types, PROGMEM reads, min/max, the clock and
+// Print. micros() and millis() count from the first call.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "Print.h"
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_pointer(addr) ((void*)*(void* const*)(addr))
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+// String on std::string. Short strings stay inline as in the ESP32 core's
+// String, up to 15 characters here against 10 on the C3, so allocation
+// counts on the host are a lower bound.
+class String {
+ public:
+  String(const char* s = "") : _s(s) {}
+  String(int v) : _s(std::to_string(v)) {}
+  String(unsigned int v) : _s(std::to_string(v)) {}
+  String(long v) : _s(std::to_string(v)) {}
+  String(unsigned long v) : _s(std::to_string(v)) {}
+
+  const char* c_str() const { return _s.c_str(); }
+  unsigned int length() const { return _s.size(); }
+  String substring(unsigned int from) const { return substring(from, _s.size()); }
+  String substring(unsigned int from, unsigned int to) const {
+    String out;
+    if (to > _s.size()) to = _s.size();
+    if (from < to) out._s.assign(_s, from, to - from);
+    return out;
+  }
+  String& operator+=(const String& s) {
+    _s += s._s;
+    return *this;
+  }
+  bool operator==(const char* s) const { return _s == s; }
+
+ private:
+  std::string _s;
+};
+
+inline String operator+(String a, const String& b) { return a += b; }
+
+inline unsigned long micros() {
+  static const auto start = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start).count();
+}
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(unsigned int us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
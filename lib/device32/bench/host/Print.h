@@ -0,0 +1,45 @@
+#pragma once
+
+// Host stand-in for Arduino's Print: write() plus the print/printf calls
+// the library's stats use.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* bytes, size_t len) {
+    size_t n = 0;
+    while (len--) n += write(*bytes++);
+    return n;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(int v) { return print((long)v); }
+  size_t println(const char* s = "") { return print(s) + print("\n"); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    return write((const uint8_t*)buf, (size_t)len < sizeof(buf) ? (size_t)len : sizeof(buf) - 1);
+  }
+};
+
+// Print to stdout, for printStats() in the benches.
+class StdoutPrint : public Print {
+ public:
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  using Print::write;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+// Host stand-in for Arduino Wire: the TwoWire calls WireBus makes, all
+// dropped. Benches that need the traffic subclass Ssd1306Bus instead.
+
+#include <stddef.h>
+#include <stdint.h>
+
+class TwoWire {
+ public:
+  bool begin(int = -1, int = -1, uint32_t = 0) { return true; }
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t) {}
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t*, size_t len) { return len; }
+  uint8_t endTransmission(bool = true) { return 0; }
+};
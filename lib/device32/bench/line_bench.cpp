@@ -0,0 +1,136 @@
+// Host benchmark for pageLine() against a copy of the Adafruit_GFX
+// per-pixel line path (writeLine -> drawPixel with bounds and rotation
+// checks). Also checks that both paths produce the same framebuffer.
+//
+//   g++ -O2 -std=gnu++11 -Isrc bench/line_bench.cpp src/page_line.cpp -o line_bench
+//   ./line_bench
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "page_line.h"
+
+// Adafruit_SSD1306::drawPixel() and Adafruit_GFX::drawLine()/writeLine()
+// as shipped, for rotation 0. drawPixel is kept out of line, as it is when
+// called across translation units through the library's vtable.
+struct GfxLine {
+  uint8_t buffer[kFrameBytes];
+  uint8_t rotation = 0;
+
+  virtual ~GfxLine() {}
+  __attribute__((noinline)) virtual void drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || x >= kPanelWidth || y < 0 || y >= kPanelHeight) return;
+    switch (rotation) {
+      case 1: { int16_t t = x; x = kPanelWidth - y - 1; y = t; break; }
+      case 2: x = kPanelWidth - x - 1; y = kPanelHeight - y - 1; break;
+    }
+    switch (color) {
+      case kWhite: buffer[x + (y / 8) * kPanelWidth] |= (1 << (y & 7)); break;
+      case kBlack: buffer[x + (y / 8) * kPanelWidth] &= ~(1 << (y & 7)); break;
+      case kInverse: buffer[x + (y / 8) * kPanelWidth] ^= (1 << (y & 7)); break;
+    }
+  }
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    if (x0 == x1) {
+      if (y0 > y1) { int16_t t = y0; y0 = y1; y1 = t; }
+      for (int16_t y = y0; y <= y1; y++) drawPixel(x0, y, color);
+    } else if (y0 == y1) {
+      if (x0 > x1) { int16_t t = x0; x0 = x1; x1 = t; }
+      for (int16_t x = x0; x <= x1; x++) drawPixel(x, y0, color);
+    } else {
+      writeLine(x0, y0, x1, y1, color);
+    }
+  }
+  void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) { int16_t t = x0; x0 = y0; y0 = t; t = x1; x1 = y1; y1 = t; }
+    if (x0 > x1) { int16_t t = x0; x0 = x1; x1 = t; t = y0; y0 = y1; y1 = t; }
+    int16_t dx = x1 - x0, dy = abs(y1 - y0);
+    int16_t err = dx / 2;
+    int16_t ystep = y0 < y1 ? 1 : -1;
+    for (; x0 <= x1; x0++) {
+      if (steep) drawPixel(y0, x0, color);
+      else drawPixel(x0, y0, color);
+      err -= dy;
+      if (err < 0) {
+        y0 += ystep;
+        err += dx;
+      }
+    }
+  }
+};
+
+struct Segment {
+  int16_t x0, y0, x1, y1;
+};
+
+// Segments shaped like the scenes' output: marching-squares cell edges
+// (1-4 px), boid heads and trails (~4-8 px), and long lines that may cross
+// the screen edge.
+static std::vector<Segment> makeSegments(int kind, int count) {
+  std::vector<Segment> out;
+  for (int i = 0; i < count; i++) {
+    Segment s;
+    if (kind == 0) {
+      s.x0 = rand() % 126; s.y0 = rand() % 62;
+      s.x1 = s.x0 + rand() % 4; s.y1 = s.y0 + rand() % 4 - 1;
+      if (s.y1 < 0) s.y1 = 0;
+    } else if (kind == 1) {
+      s.x0 = 8 + rand() % 112; s.y0 = 8 + rand() % 48;
+      s.x1 = s.x0 + rand() % 17 - 8; s.y1 = s.y0 + rand() % 17 - 8;
+    } else {
+      s.x0 = rand() % 200 - 36; s.y0 = rand() % 120 - 28;
+      s.x1 = rand() % 200 - 36; s.y1 = rand() % 120 - 28;
+    }
+    out.push_back(s);
+  }
+  return out;
+}
+
+template <typename F>
+static double linesPerSecond(const std::vector<Segment>& segs, int rounds, F draw) {
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    for (const Segment& s : segs) draw(s, r);
+  }
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return segs.size() * (double)rounds / secs;
+}
+
+int main() {
+  static const char* kNames[] = {"short (1-4 px)", "boid (4-8 px)", "long, clipped"};
+  const int count = 4096, rounds = 200;
+  GfxLine* gfx = new GfxLine();
+  static uint8_t frame[kFrameBytes];
+  int mismatches = 0;
+
+  for (int kind = 0; kind < 3; kind++) {
+    std::vector<Segment> segs = makeSegments(kind, count);
+
+    for (const Segment& s : segs) {
+      for (uint16_t color = kBlack; color <= kInverse; color++) {
+        memset(gfx->buffer, 0x5A, kFrameBytes);
+        memset(frame, 0x5A, kFrameBytes);
+        gfx->drawLine(s.x0, s.y0, s.x1, s.y1, color);
+        pageLine(frame, s.x0, s.y0, s.x1, s.y1, color);
+        if (memcmp(frame, gfx->buffer, kFrameBytes) != 0) mismatches++;
+      }
+    }
+
+    double before = linesPerSecond(segs, rounds, [&](const Segment& s, int r) {
+      gfx->drawLine(s.x0, s.y0, s.x1, s.y1, r & 1 ? kWhite : kInverse);
+    });
+    double after = linesPerSecond(segs, rounds, [&](const Segment& s, int r) {
+      pageLine(frame, s.x0, s.y0, s.x1, s.y1, r & 1 ? kWhite : kInverse);
+    });
+    printf("%-16s gfx %6.1f M lines/s, pageLine %6.1f M lines/s (%.1fx)\n",
+           kNames[kind], before / 1e6, after / 1e6, after / before);
+  }
+
+  printf("%d mismatching lines\n", mismatches);
+  delete gfx;
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+// Host check for live_events.h against a stand-in browser. The "server"
+// side writes the response head and one event per frame the way the timer
+// example's /live handler does; the stand-in client parses the HTTP head
+// and the event stream from arbitrarily split TCP reads, decodes the
+// base64 tokens the way the /view page script does, and compares its
+// frame with the server's after every frame. A second viewer joins
+// halfway and must start from a keyframe.
+//
+//   g++ -O2 -std=gnu++11 -Isrc bench/live_bench.cpp src/live_events.cpp src/frame_mirror.cpp src/anim_stream.cpp -o live_bench
+//   ./live_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "live_events.h"
+
+static void setPixel(uint8_t* frame, int x, int y) {
+  if (x < 0 || x >= kPanelWidth || y < 0 || y >= kPanelHeight) return;
+  frame[x + (y / 8) * kPanelWidth] |= 1 << (y & 7);
+}
+
+static std::vector<uint8_t> starfield(int count) {
+  std::vector<uint8_t> frames((size_t)count * kFrameBytes);
+  struct Star { float x, y, z; } stars[100];
+  srand(3);
+  for (auto& s : stars) {
+    s.x = (rand() % 2000 - 1000) / 1000.0f;
+    s.y = (rand() % 2000 - 1000) / 1000.0f;
+    s.z = (100 + rand() % 900) / 1000.0f;
+  }
+  for (int n = 0; n < count; n++) {
+    uint8_t* frame = &frames[(size_t)n * kFrameBytes];
+    for (auto& s : stars) {
+      s.z -= 0.01f;
+      if (s.z <= 0.0f) s.z = 1.0f;
+      int sx = 64 + (int)(s.x / s.z * 50), sy = 32 + (int)(s.y / s.z * 50);
+      int size = s.z < 0.5f ? 2 : 1;
+      for (int dy = 0; dy < size; dy++)
+        for (int dx = 0; dx < size; dx++) setPixel(frame, sx + dx, sy + dy);
+    }
+  }
+  return frames;
+}
+
+// A countdown: a border, and a block of "digits" that changes once a
+// second at 20 frames per second, so most frames repeat the last.
+static std::vector<uint8_t> countdown(int count) {
+  std::vector<uint8_t> frames((size_t)count * kFrameBytes);
+  for (int n = 0; n < count; n++) {
+    uint8_t* frame = &frames[(size_t)n * kFrameBytes];
+    for (int x = 0; x < kPanelWidth; x++) {
+      setPixel(frame, x, 0);
+      setPixel(frame, x, kPanelHeight - 1);
+    }
+    int second = n / 20;
+    for (int bit = 0; bit < 16; bit++)
+      if ((second * 2654435761u) >> (bit + 8) & 1)
+        for (int y = 20; y < 44; y++)
+          for (int x = 0; x < 5; x++) setPixel(frame, 24 + bit * 5 + x, y);
+  }
+  return frames;
+}
+
+// Reads a server's bytes in whatever pieces TCP hands over.
+class StandInClient {
+ public:
+  StandInClient() { memset(frame, 0, sizeof(frame)); }
+
+  void receive(const char* p, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      if (!_headDone) {
+        _head += p[i];
+        if (_head.size() >= 4 && _head.compare(_head.size() - 4, 4, "\r\n\r\n") == 0) {
+          _headDone = true;
+          if (_head.compare(0, 12, "HTTP/1.1 200") != 0 ||
+              _head.find("\r\nContent-Type: text/event-stream\r\n") == std::string::npos) {
+            errors++;
+          }
+        }
+      } else if (p[i] == '\n') {
+        line();
+      } else {
+        _line += p[i];
+      }
+    }
+  }
+
+  uint8_t frame[kFrameBytes];
+  int events = 0;
+  int keyframes = 0;
+  int errors = 0;
+  bool keyed = false;  // saw a keyframe before any delta
+
+ private:
+  void line() {
+    if (_line.empty()) {
+      if (!_data.empty()) dispatch();
+      _event.clear();
+      _data.clear();
+    } else if (_line.compare(0, 7, "event: ") == 0) {
+      _event = _line.substr(7);
+    } else if (_line.compare(0, 6, "data: ") == 0) {
+      _data += _line.substr(6);
+    } else if (_line.compare(0, 7, "retry: ") != 0) {
+      errors++;
+    }
+    _line.clear();
+  }
+
+  // atob() and the token loop from the /view page.
+  void dispatch() {
+    std::string t;
+    uint32_t v = 0;
+    int bits = 0;
+    for (char c : _data) {
+      const char* at = strchr("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/", c);
+      if (c == '=' || !at) break;
+      v = v << 6 | (at - "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/");
+      if ((bits += 6) >= 8) t += (char)(v >> (bits -= 8));
+    }
+    bool key = _event == "k";
+    if (!key && _event != "d") errors++;
+    if (key) {
+      memset(frame, 0, sizeof(frame));
+      keyframes++;
+      keyed = keyed || events == 0;
+    }
+    size_t p = 0;
+    int i = 0;
+    while (i < kFrameBytes && p < t.size()) {
+      uint8_t k = t[p++];
+      int n = (k < 128 ? k : k & 63) + 1;
+      if (k < 128) {
+        i += n;
+      } else if (k < 192) {
+        while (n-- && i < kFrameBytes) frame[i++] ^= t[p++];
+      } else {
+        uint8_t b = t[p++];
+        while (n-- && i < kFrameBytes) frame[i++] ^= b;
+      }
+    }
+    if (i != kFrameBytes || p != t.size()) errors++;
+    events++;
+  }
+
+  std::string _head, _line, _event, _data;
+  bool _headDone = false;
+};
+
+struct Viewer {
+  LiveEvents events;
+  StandInClient client;
+  size_t sent = 0;
+  int mismatches = 0;
+
+  void connect() {
+    feed(kLiveResponseHead, strlen(kLiveResponseHead));
+    events.restart();
+  }
+
+  // Hand text over in random pieces, as TCP reads would.
+  void feed(const char* p, size_t len) {
+    while (len) {
+      size_t n = 1 + rand() % 200;
+      if (n > len) n = len;
+      client.receive(p, n);
+      p += n;
+      len -= n;
+    }
+  }
+
+  void present(const uint8_t* frame) {
+    static char event[kLiveMaxEvent];
+    size_t len = events.encode(frame, event);
+    if (len) {
+      feed(event, len);
+      events.commit(frame);
+      sent += len;
+    }
+    if (memcmp(client.frame, frame, kFrameBytes) != 0) mismatches++;
+  }
+};
+
+int main() {
+  struct {
+    const char* name;
+    std::vector<uint8_t> frames;
+  } clips[] = {
+    {"starfield", starfield(300)},
+    {"countdown", countdown(300)},
+  };
+  int failures = 0;
+  srand(11);
+
+  for (auto& clip : clips) {
+    int count = clip.frames.size() / kFrameBytes;
+    static Viewer first, late;
+    first = Viewer();
+    late = Viewer();
+    first.connect();
+    for (int n = 0; n < count; n++) {
+      const uint8_t* frame = &clip.frames[(size_t)n * kFrameBytes];
+      if (n == count / 2) late.connect();
+      first.present(frame);
+      if (n >= count / 2) late.present(frame);
+    }
+
+    printf("%-10s %3d frames, %3d events, %6.1f B/event (full frame in base64: %d B); late viewer %s\n",
+           clip.name, count, first.client.events, (double)first.sent / first.client.events,
+           (int)(4 * ((kFrameBytes + 2) / 3)), late.client.keyed ? "started on a keyframe" : "missed its keyframe");
+    int bad = first.mismatches + late.mismatches + first.client.errors + late.client.errors + !first.client.keyed +
+              !late.client.keyed;
+    if (bad) printf("%-10s %d mismatching frames, %d parse errors\n", "", first.mismatches + late.mismatches,
+                    first.client.errors + late.client.errors);
+    failures += bad;
+  }
+
+  printf("%d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+// Host round trip and compression check for frame_mirror.h. Runs recorded
+// frames (raw page-layout frames, 1024 bytes each, as tools/mirror_view
+// -r writes them) through MirrorEncoder and MirrorDecoder with console
+// text between packets and checks every decoded frame. Then feeds the same
+// stream with damaged packets and checks that the decoder rejects them and
+// comes back at the next keyframe. Without arguments it uses two synthetic
+// clips, a starfield and a scrolling checkerboard.
+//
+//   g++ -O2 -std=gnu++11 -Isrc bench/mirror_bench.cpp src/frame_mirror.cpp src/anim_stream.cpp -o mirror_bench
+//   ./mirror_bench [snake.raw caves.raw ...]
+//
+// Per clip it prints the mean packet size, the ratio to raw frames, and how
+// many frames per second a 115200 baud link carries at that size.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "frame_mirror.h"
+
+static void setPixel(uint8_t* frame, int x, int y) {
+  if (x < 0 || x >= kPanelWidth || y < 0 || y >= kPanelHeight) return;
+  frame[x + (y / 8) * kPanelWidth] |= 1 << (y & 7);
+}
+
+static std::vector<uint8_t> starfield(int count) {
+  std::vector<uint8_t> frames((size_t)count * kFrameBytes);
+  struct Star { float x, y, z; } stars[100];
+  srand(3);
+  for (auto& s : stars) {
+    s.x = (rand() % 2000 - 1000) / 1000.0f;
+    s.y = (rand() % 2000 - 1000) / 1000.0f;
+    s.z = (100 + rand() % 900) / 1000.0f;
+  }
+  for (int n = 0; n < count; n++) {
+    uint8_t* frame = &frames[(size_t)n * kFrameBytes];
+    for (auto& s : stars) {
+      s.z -= 0.01f;
+      if (s.z <= 0.0f) s.z = 1.0f;
+      int sx = 64 + (int)(s.x / s.z * 50), sy = 32 + (int)(s.y / s.z * 50);
+      int size = s.z < 0.5f ? 2 : 1;
+      for (int dy = 0; dy < size; dy++)
+        for (int dx = 0; dx < size; dx++) setPixel(frame, sx + dx, sy + dy);
+    }
+  }
+  return frames;
+}
+
+static std::vector<uint8_t> checkerboard(int count) {
+  std::vector<uint8_t> frames((size_t)count * kFrameBytes);
+  for (int n = 0; n < count; n++) {
+    uint8_t* frame = &frames[(size_t)n * kFrameBytes];
+    for (int y = 0; y < kPanelHeight; y++)
+      for (int x = 0; x < kPanelWidth; x++)
+        if ((((x + n) / 8) ^ ((y + n / 2) / 8)) & 1) setPixel(frame, x, y);
+  }
+  return frames;
+}
+
+static bool readFrames(const char* path, std::vector<uint8_t>& frames) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  uint8_t frame[kFrameBytes];
+  while (fread(frame, 1, kFrameBytes, f) == kFrameBytes) frames.insert(frames.end(), frame, frame + kFrameBytes);
+  fclose(f);
+  return !frames.empty();
+}
+
+struct Clip {
+  std::string name;
+  std::vector<uint8_t> frames;
+};
+
+int main(int argc, char** argv) {
+  std::vector<Clip> clips;
+  for (int i = 1; i < argc; i++) {
+    Clip clip;
+    clip.name = argv[i];
+    size_t slash = clip.name.rfind('/');
+    if (slash != std::string::npos) clip.name.erase(0, slash + 1);
+    if (!readFrames(argv[i], clip.frames)) {
+      printf("%s: no frames\n", argv[i]);
+      return 1;
+    }
+    clips.push_back(clip);
+  }
+  if (clips.empty()) {
+    Clip stars = {"starfield", starfield(300)};
+    Clip checks = {"checkerboard", checkerboard(300)};
+    clips.push_back(stars);
+    clips.push_back(checks);
+  }
+
+  const char* console = "async: waited 12 us, last send 3150 us\n";
+  const double linkBytesPerSecond = 115200 / 10.0;
+  int failures = 0;
+  static uint8_t packet[kMirrorMaxPacket];
+
+  for (const Clip& clip : clips) {
+    int count = clip.frames.size() / kFrameBytes;
+    MirrorEncoder encoder;
+    MirrorDecoder clean, damaged;
+    size_t total = 0, keyBytes = 0, keys = 0;
+    int mismatches = 0, outputs = 0, wrong = 0, recovered = -1;
+    srand(7);
+
+    for (int n = 0; n < count; n++) {
+      const uint8_t* frame = &clip.frames[(size_t)n * kFrameBytes];
+      size_t len = encoder.encode(frame, 33, packet);
+      encoder.commit(frame);
+      total += len;
+      if (packet[4] == 'K') {
+        keys++;
+        keyBytes += len;
+      }
+
+      for (const char* c = console; n % 10 == 0 && *c; c++) clean.push(*c);
+      bool updated = false;
+      for (size_t i = 0; i < len; i++) updated = clean.push(packet[i]);
+      if (!updated || memcmp(clean.frame(), frame, kFrameBytes) != 0) mismatches++;
+
+      // Flip a byte in every 50th packet, starting with a delta: the
+      // decoder must not show a wrong frame, and must be back in step by
+      // the next keyframe.
+      if (n % 50 == 25) packet[kMirrorHeaderBytes + rand() % (len - kMirrorHeaderBytes)] ^= 1 << (rand() % 8);
+      updated = false;
+      for (size_t i = 0; i < len; i++) updated = damaged.push(packet[i]);
+      if (updated) {
+        outputs++;
+        if (memcmp(damaged.frame(), frame, kFrameBytes) != 0) wrong++;
+      }
+      if (n == 25) recovered = 0;
+      if (recovered == 0 && updated && n > 25) recovered = n;
+    }
+
+    double mean = (double)total / count;
+    printf("%-16s %5d frames  %6.1f B/packet (%4.1f%% of raw; keyframes %.0f B, deltas %.1f B)  %5.1f fps at 115200\n",
+           clip.name.c_str(), count, mean, 100.0 * mean / kFrameBytes, keys ? (double)keyBytes / keys : 0.0,
+           count > (int)keys ? (double)(total - keyBytes) / (count - keys) : 0.0, linkBytesPerSecond / mean);
+    printf("%-16s damaged stream: %d/%d frames shown, %d wrong, %u corrupt packets, back at frame %d\n", "",
+           outputs, count, wrong, (unsigned)damaged.corrupt(), recovered);
+    failures += mismatches + wrong + (recovered == 0 && count > 60);
+    if (mismatches) printf("%-16s %d mismatching frames\n", "", mismatches);
+  }
+
+  printf("%d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+// Host check for page_renderer.h. Pong-style frames (round-rect border,
+// dashed net, paddles and ball as fillRects, a trail and an XOR sweep as
+// lines, the score as text, a size-2 opaque banner now and then) are drawn
+// through PageRenderer, whose pages are caught by a bus and reassembled,
+// and through an Adafruit_SSD1306-equivalent 1 KB buffer, in rotations 0
+// to 3. The frames must match byte for byte. A second pass gives the
+// renderer fewer op slots than a frame uses: the ops past capacity must be
+// counted as dropped, and the frame must match the reference drawn with
+// only the ops that fit. Mismatching frames are reported.
+//
+// Builds against the Adafruit GFX library PlatformIO fetched for an
+// example, e.g. examples/pong/.pio/libdeps/<env>/Adafruit GFX Library:
+//
+//   GFX="../../examples/pong/.pio/libdeps/seeed_xiao_esp32c3/Adafruit GFX Library"
+//   g++ -O2 -std=gnu++11 -DARDUINO=100 -Isrc -Ibench/host -I"$GFX" bench/page_bench.cpp src/page_renderer.cpp src/ssd1306_bus.cpp "$GFX/Adafruit_GFX.cpp" -o page_bench
+//   ./page_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "page_renderer.h"
+
+static const int kFrames = 400;
+
+// Reassembles the pages display() sends.
+class FrameBus : public Ssd1306Bus {
+ public:
+  uint8_t frame[kFrameBytes];
+  int windows = 0;
+  bool stray = false;
+
+  void commands(const uint8_t*, size_t) override {}
+  void data(const uint8_t*, size_t) override {}
+  void writeWindow(uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1,
+                   const uint8_t* bytes, size_t len) override {
+    windows++;
+    if (col0 != 0 || col1 != kPanelWidth - 1 || page0 != page1 || len != kPanelWidth) {
+      stray = true;
+      return;
+    }
+    memcpy(frame + page0 * kPanelWidth, bytes, len);
+  }
+};
+
+// Draw calls the reference may make: the renderer's capacity, refilled
+// when fillScreen(SSD1306_BLACK) empties the op list.
+struct Budget {
+  int capacity;
+  int left;
+  int dropped = 0;
+
+  explicit Budget(int cap) : capacity(cap), left(cap) {}
+  bool take() {
+    if (left > 0) {
+      left--;
+      return true;
+    }
+    dropped++;
+    return false;
+  }
+  void clear() { left = capacity; }
+  int kept() const { return capacity - left; }
+};
+
+struct Pong {
+  int w, h;
+  int ballX, ballY, velX = 2, velY = 2;
+  int left, right;
+  int score[2] = {0, 0};
+  static const int kPaddleW = 4, kPaddleH = 16, kBall = 4;
+
+  Pong(int width, int height) : w(width), h(height), ballX(width / 2), ballY(height / 2) {
+    left = right = (height - kPaddleH) / 2;
+  }
+
+  // The pong example's loop(), with a deterministic serve.
+  void step(int frame) {
+    int& paddle = velX < 0 ? left : right;
+    if (paddle + kPaddleH / 2 < ballY) paddle++;
+    else if (paddle + kPaddleH / 2 > ballY) paddle--;
+    left = left < 0 ? 0 : left > h - kPaddleH ? h - kPaddleH : left;
+    right = right < 0 ? 0 : right > h - kPaddleH ? h - kPaddleH : right;
+    int nx = ballX + velX, ny = ballY + velY;
+    // Miss now and then so the ball leaves the court and clips.
+    bool miss = frame % 97 > 80;
+    if (!miss && nx < kPaddleW && ballY < left + kPaddleH && ballY + kBall > left) {
+      velX = -velX;
+      nx = ballX + velX;
+    }
+    if (!miss && nx + kBall > w - kPaddleW && ballY < right + kPaddleH && ballY + kBall > right) {
+      velX = -velX;
+      nx = ballX + velX;
+    }
+    if (ny < 0 || ny + kBall > h) {
+      velY = -velY;
+      ny = ballY + velY;
+    }
+    ballX = nx;
+    ballY = ny;
+    // Served again before it is wholly off the panel: the renderer culls
+    // such ops without using or dropping a slot, which Budget doesn't model.
+    if (ballX <= -kBall || ballX >= w) {
+      score[ballX < 0 ? 1 : 0]++;
+      ballX = w / 2;
+      ballY = h / 2;
+      velX = frame & 1 ? 2 : -2;
+      velY = frame & 2 ? 3 : -2;
+    }
+  }
+};
+
+template <class Gfx>
+static void print(Gfx& g, const char* text, Budget& ops) {
+  for (; *text; text++)
+    if (ops.take()) g.write(*text);
+}
+
+// One pong frame. Gfx is the concrete type so the renderer's own
+// drawRoundRect()/drawChar() are used, as they are in the sketch.
+template <class Gfx>
+static void drawFrame(Gfx& g, const Pong& p, int frame, Budget& ops) {
+  int w = g.width(), h = g.height();
+  g.clearDisplay();
+  ops.clear();
+  if (ops.take()) g.drawRoundRect(0, 0, w, h, 3, SSD1306_WHITE);
+  for (int y = 2; y < h; y += 8)
+    if (ops.take()) g.drawFastVLine(w / 2, y, 4, SSD1306_WHITE);
+  if (ops.take()) g.fillRect(0, p.left, Pong::kPaddleW, Pong::kPaddleH, SSD1306_WHITE);
+  if (ops.take()) g.fillRect(w - Pong::kPaddleW, p.right, Pong::kPaddleW, Pong::kPaddleH, SSD1306_WHITE);
+  if (ops.take()) g.fillRect(p.ballX, p.ballY, Pong::kBall, Pong::kBall, SSD1306_WHITE);
+  // Trail behind the ball, and a sweep that crosses everything and runs
+  // off both edges.
+  int cx = p.ballX + Pong::kBall / 2, cy = p.ballY + Pong::kBall / 2;
+  if (ops.take()) g.drawLine(cx, cy, cx - 5 * p.velX, cy - 5 * p.velY, SSD1306_WHITE);
+  if (ops.take()) g.drawLine(-10, frame % h, w + 10, h - 1 - frame % h, SSD1306_INVERSE);
+  char text[16];
+  g.setTextSize(1);
+  g.setTextColor(SSD1306_WHITE);
+  g.setCursor(w / 2 - 15, 4);
+  snprintf(text, sizeof(text), "%d  %d", p.score[0] % 100, p.score[1] % 100);
+  print(g, text, ops);
+  if (frame % 50 >= 40) {
+    // A cleared screen drops everything drawn so far; draw a banner over it.
+    g.fillScreen(SSD1306_BLACK);
+    ops.clear();
+    if (ops.take()) g.fillRect(4, h / 2 - 10, w - 8, 20, SSD1306_WHITE);
+    g.setTextSize(2);
+    g.setTextColor(SSD1306_BLACK, SSD1306_WHITE);
+    g.setCursor(8, h / 2 - 8);
+    print(g, w > h ? "SERVE" : "GO", ops);
+    if (ops.take()) g.drawRoundRect(1, h / 2 - 13, w - 2, 26, 5, SSD1306_INVERSE);
+  }
+}
+
+struct Result {
+  int mismatched = 0;
+  int first = -1;
+  int page = 0, col = 0;
+  uint8_t want = 0, got = 0;
+  bool countsOk = true;
+};
+
+static Result run(uint8_t rotation, int capacity) {
+  FrameBus bus;
+  PageRenderer display(bus, (uint16_t)capacity);
+  Adafruit_SSD1306 reference(kPanelWidth, kPanelHeight);
+  display.begin();
+  display.setRotation(rotation);
+  reference.setRotation(rotation);
+
+  Result r;
+  Pong pong(display.width(), display.height());
+  for (int frame = 0; frame < kFrames; frame++) {
+    pong.step(frame);
+    Budget all(1 << 30), fits(capacity);
+    uint32_t dropped = display.droppedOps();
+    drawFrame(display, pong, frame, all);
+    drawFrame(reference, pong, frame, fits);
+    bus.windows = 0;
+    display.display();
+    // Every op is either kept or counted as dropped.
+    uint32_t lost = display.droppedOps() - dropped;
+    if (bus.windows != kPanelPages || bus.stray || (int)lost != fits.dropped ||
+        display.opCount() != fits.kept())
+      r.countsOk = false;
+    if (memcmp(bus.frame, reference.getBuffer(), kFrameBytes) != 0) {
+      if (r.first < 0) {
+        r.first = frame;
+        for (int i = 0; i < kFrameBytes; i++) {
+          if (bus.frame[i] == reference.getBuffer()[i]) continue;
+          r.page = i / kPanelWidth;
+          r.col = i % kPanelWidth;
+          r.want = reference.getBuffer()[i];
+          r.got = bus.frame[i];
+          break;
+        }
+      }
+      r.mismatched++;
+    }
+  }
+  return r;
+}
+
+int main() {
+  int failures = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    int capacity = pass == 0 ? 64 : 8;  // 8 is what the pong sketch reserves
+    for (uint8_t rotation = 0; rotation < 4; rotation++) {
+      Result r = run(rotation, capacity);
+      char what[48];
+      snprintf(what, sizeof(what), "rotation %u, %d ops%s", rotation, capacity,
+               pass ? " (overflowing)" : "");
+      bool ok = r.mismatched == 0 && r.countsOk;
+      printf("%-40s %s: %d of %d frames differ", what, ok ? "ok" : "FAIL", r.mismatched, kFrames);
+      if (r.first >= 0)
+        printf(", first frame %d page %d col %d: want %02x got %02x", r.first, r.page, r.col,
+               r.want, r.got);
+      if (!r.countsOk) printf(", op or window counts wrong");
+      printf("\n");
+      failures += !ok;
+    }
+  }
+  printf("%d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+// Host benchmark for SpriteLayer against starfield's clear-and-redraw
+// loop (clearDisplay, then one fillRect per star, which Adafruit_GFX turns
+// into a drawFastVLine per column). Runs the starfield simulation for 100
+// and 500 stars and times a frame: step, draw, and DirtyFlush's diff of
+// the whole frame or of the damaged spans only. Also checks that both
+// paths leave the same frame every step, and reports frame bytes touched,
+// bytes diffed and bytes that go to the panel.
+//
+//   g++ -O2 -std=gnu++11 -Isrc bench/sprite_bench.cpp src/sprite_layer.cpp -o sprite_bench
+//   ./sprite_bench
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "sprite_layer.h"
+
+// Adafruit_GFX::fillRect() -> Adafruit_SSD1306::drawFastVLine() as
+// shipped, for rotation 0 and WHITE, with the virtual call kept out of line.
+struct GfxPanel {
+  uint8_t buffer[kFrameBytes];
+
+  virtual ~GfxPanel() {}
+  __attribute__((noinline)) virtual void drawFastVLine(int16_t x, int16_t y, int16_t h) {
+    if (x < 0 || x >= kPanelWidth) return;
+    if (y < 0) { h += y; y = 0; }
+    if (y + h > kPanelHeight) h = kPanelHeight - y;
+    for (; h > 0; h--, y++) buffer[x + (y / 8) * kPanelWidth] |= 1 << (y & 7);
+  }
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+    for (int16_t i = x; i < x + w; i++) drawFastVLine(i, y, h);
+  }
+};
+
+struct Star {
+  float x, y, z;
+};
+
+static const float kSpeed = 0.01f, kScale = 50.0f;
+
+static float unit() { return (rand() % 2000 - 1000) / 1000.0f; }
+
+static void step(std::vector<Star>& stars) {
+  for (Star& s : stars) {
+    s.z -= kSpeed;
+    if (s.z <= 0.0f) {
+      s.x = unit();
+      s.y = unit();
+      s.z = 1.0f;
+    }
+  }
+}
+
+template <typename Draw>
+static void project(const std::vector<Star>& stars, Draw draw) {
+  for (size_t i = 0; i < stars.size(); i++) {
+    const Star& s = stars[i];
+    int sx = kPanelWidth / 2 + (int)(s.x / s.z * kScale);
+    int sy = kPanelHeight / 2 + (int)(s.y / s.z * kScale);
+    draw(i, sx, sy, s.z < 0.5f ? 2 : 1);
+  }
+}
+
+static void clearAndRedraw(GfxPanel* gfx, const std::vector<Star>& stars) {
+  memset(gfx->buffer, 0, kFrameBytes);
+  project(stars, [&](size_t, int sx, int sy, int size) {
+    if (sx >= 0 && sx < kPanelWidth && sy >= 0 && sy < kPanelHeight) gfx->fillRect(sx, sy, size, size);
+  });
+}
+
+static void incremental(SpriteLayer& sprites, const std::vector<Star>& stars) {
+  sprites.eraseAll();
+  project(stars, [&](size_t i, int sx, int sy, int size) {
+    sprites.select(i);
+    if (sx >= 0 && sx < kPanelWidth && sy >= 0 && sy < kPanelHeight) sprites.fillRect(sx, sy, size, size);
+  });
+}
+
+// DirtyFlush::flush()'s page scan with the bus left out. Returns the bytes
+// it would send.
+static size_t diff(const uint8_t* frame, uint8_t* shadow, const uint8_t* firstCol, const uint8_t* lastCol) {
+  size_t sent = 0;
+  for (int page = 0; page < kPanelPages; page++) {
+    const uint8_t* row = frame + page * kPanelWidth;
+    uint8_t* old = shadow + page * kPanelWidth;
+    int first = firstCol[page], last = lastCol[page];
+    while (first <= last && row[first] == old[first]) first++;
+    if (first > last) continue;
+    while (row[last] == old[last]) last--;
+    memcpy(old + first, row + first, last - first + 1);
+    sent += last - first + 1;
+  }
+  return sent;
+}
+
+static const uint8_t kWholeFirst[kPanelPages] = {0, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t kWholeLast[kPanelPages] = {127, 127, 127, 127, 127, 127, 127, 127};
+
+static std::vector<Star> makeStars(int count, int seed) {
+  srand(seed);
+  std::vector<Star> stars(count);
+  for (Star& s : stars) {
+    s.x = unit();
+    s.y = unit();
+    s.z = (100 + rand() % 900) / 1000.0f;
+  }
+  return stars;
+}
+
+int main() {
+  const int frames = 20000;
+  GfxPanel* gfx = new GfxPanel();
+  static uint8_t frame[kFrameBytes], shadowA[kFrameBytes], shadowB[kFrameBytes];
+  int mismatches = 0;
+
+  for (int count : {100, 500}) {
+    std::vector<SpriteFootprint> slots(count);
+    SpriteLayer sprites(slots.data(), count);
+    memset(frame, 0, kFrameBytes);
+    memset(shadowA, 0, kFrameBytes);
+    memset(shadowB, 0, kFrameBytes);
+    sprites.attach(frame);
+
+    // Equality, touched, diffed and sent bytes over a run.
+    std::vector<Star> stars = makeStars(count, 1);
+    size_t touched = 0, damaged = 0, sentA = 0, sentB = 0;
+    for (int f = 0; f < 1000; f++) {
+      step(stars);
+      clearAndRedraw(gfx, stars);
+      sentA += diff(gfx->buffer, shadowA, kWholeFirst, kWholeLast);
+      sprites.clearDamage();
+      incremental(sprites, stars);
+      sentB += diff(frame, shadowB, sprites.firstCols(), sprites.lastCols());
+      if (memcmp(frame, gfx->buffer, kFrameBytes) != 0) mismatches++;
+      touched += sprites.touchedBytes();
+      for (int page = 0; page < kPanelPages; page++) {
+        int first = sprites.firstCols()[page], last = sprites.lastCols()[page];
+        if (first <= last) damaged += last - first + 1;
+      }
+    }
+    if (sentA != sentB) mismatches++;
+
+    // Time whole frames on identical star sets.
+    std::vector<Star> a = makeStars(count, 2), b = a;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) {
+      step(a);
+      clearAndRedraw(gfx, a);
+      diff(gfx->buffer, shadowA, kWholeFirst, kWholeLast);
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) {
+      step(b);
+      sprites.clearDamage();
+      incremental(sprites, b);
+      diff(frame, shadowB, sprites.firstCols(), sprites.lastCols());
+    }
+    auto end = std::chrono::steady_clock::now();
+    double before = std::chrono::duration<double, std::micro>(mid - start).count() / frames;
+    double after = std::chrono::duration<double, std::micro>(end - mid).count() / frames;
+
+    printf("%3d stars: clear+redraw %6.2f us/frame, sprites %6.2f us/frame (%.1fx)\n",
+           count, before, after, before / after);
+    printf("           touched %4zu B vs %d, diffed %4zu B vs %d, sent %4zu B\n",
+           touched / 1000, kFrameBytes, damaged / 1000, kFrameBytes, sentB / 1000);
+  }
+
+  printf("%d mismatching frames\n", mismatches);
+  delete gfx;
+  return mismatches == 0 ? 0 : 1;
+}
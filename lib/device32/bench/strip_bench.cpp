@@ -0,0 +1,376 @@
+// Host bench for text_strip.h, on wifi_scanner's frames. The list and
+// detail views are drawn the way the sketch drew them before TextStrip
+// (String slicing, getTextBounds() and bold by printing twice) and the way
+// it draws them now (strips rendered once, blitted every frame), into an
+// Adafruit_SSD1306-equivalent buffer in rotation 1. With the scroll offset
+// at 0 every list selection, every detail row of each AP and the scanning
+// screen must come out byte for byte the same. Then each view is run for
+// a few thousand frames both ways, counting heap allocations (global
+// operator new) and time per frame.
+//
+// Builds against the Adafruit GFX library PlatformIO fetched for an
+// example, e.g. examples/wifi_scanner/.pio/libdeps/<env>/Adafruit GFX Library:
+//
+//   GFX="../../examples/wifi_scanner/.pio/libdeps/seeed_xiao_esp32c3/Adafruit GFX Library"
+//   g++ -O2 -std=gnu++11 -DARDUINO=100 -Isrc -Ibench/host -I"$GFX" bench/strip_bench.cpp src/text_strip.cpp src/glyph_blit.cpp "$GFX/Adafruit_GFX.cpp" -o strip_bench
+//   ./strip_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <new>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "text_strip.h"
+
+static unsigned long allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+
+#define GAME_WIDTH 64
+#define GAME_HEIGHT 128
+#define MARQUEE_CHARS 9
+
+enum {
+  WIFI_AUTH_OPEN,
+  WIFI_AUTH_WEP,
+  WIFI_AUTH_WPA_PSK,
+  WIFI_AUTH_WPA2_PSK,
+  WIFI_AUTH_WPA_WPA2_PSK,
+  WIFI_AUTH_WPA2_ENTERPRISE,
+  WIFI_AUTH_WPA3_PSK,
+  WIFI_AUTH_WPA2_WPA3_PSK,
+  WIFI_AUTH_WAPI_PSK,
+};
+
+struct AP {
+  String ssid;
+  String bssid;
+  int rssi;
+  int channel;
+  int enc;
+};
+
+// The sketch's AP now also carries its SSID strip.
+struct StripAP : AP {
+  TextStrip ssid_strip;
+};
+
+struct View {
+  bool is_scanning;
+  int state;  // 0: list, 1: detail
+  int current_index;
+  int start_index;
+  int detail_index;
+  int scroll_pos;  // characters before, pixels now
+};
+
+// wifi_scanner's frame before TextStrip, from the clear to the last print.
+static void drawOld(Adafruit_SSD1306& display, const std::vector<AP>& aps, const View& v) {
+  display.clearDisplay();
+  display.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
+
+  if (v.is_scanning) {
+    display.setTextSize(1);
+    display.setTextColor(SSD1306_WHITE);
+    display.setTextWrap(false);
+    String scan_msg = "Scanning..";
+    int16_t x1, y1;
+    uint16_t w, h;
+    display.getTextBounds(scan_msg, 0, 0, &x1, &y1, &w, &h);
+    int center_x = (GAME_WIDTH - w) / 2;
+    int center_y = (GAME_HEIGHT - h) / 2;
+    display.setCursor(center_x, center_y);
+    display.printf("%s", scan_msg.c_str());
+    return;
+  }
+
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+  display.setTextWrap(false);
+
+  if (v.state == 0) {  // List view
+    int y = 5;
+    String aps_line = "APs: " + String((unsigned long)aps.size());
+    display.setCursor(5, y);
+    display.printf("%s", aps_line.c_str());
+    display.setCursor(6, y);  // offset for bold
+    display.printf("%s", aps_line.c_str());
+    y += 10;
+
+    int num_to_show = 10;
+    int total_items = aps.size() + 1;
+    for (int i = 0; i < num_to_show && v.start_index + i < total_items; ++i) {
+      int idx = v.start_index + i;
+      display.setCursor(5, y);
+      if (idx < (int)aps.size()) {
+        String ssid = aps[idx].ssid;
+        if (idx == v.current_index) {
+          String display_ssid;
+          if (ssid.length() > 9) {
+            display_ssid = ssid.substring(v.scroll_pos, v.scroll_pos + 9);
+          } else {
+            display_ssid = ssid;
+          }
+          display.printf(">%s", display_ssid.c_str());
+        } else {
+          if (ssid.length() > 9) ssid = ssid.substring(0, 9);
+          display.printf(" %s", ssid.c_str());
+        }
+      } else {
+        // Rescan option
+        const char* line = idx == v.current_index ? ">* Rescan" : " * Rescan";
+        display.setCursor(5, y);
+        display.printf("%s", line);
+        display.setCursor(6, y);
+        display.printf("%s", line);
+      }
+      y += 10;
+    }
+  } else if (v.current_index < (int)aps.size()) {  // Detail view
+    AP ap = aps[v.current_index];
+    String enc_str;
+    switch (ap.enc) {
+      case WIFI_AUTH_OPEN: enc_str = "Open"; break;
+      case WIFI_AUTH_WEP: enc_str = "WEP"; break;
+      case WIFI_AUTH_WPA_PSK: enc_str = "WPA"; break;
+      case WIFI_AUTH_WPA2_PSK: enc_str = "WPA2"; break;
+      case WIFI_AUTH_WPA_WPA2_PSK: enc_str = "WPA+WPA2"; break;
+      case WIFI_AUTH_WPA2_ENTERPRISE: enc_str = "WPA2-EAP"; break;
+      case WIFI_AUTH_WPA3_PSK: enc_str = "WPA3"; break;
+      case WIFI_AUTH_WPA2_WPA3_PSK: enc_str = "WPA2+WPA3"; break;
+      case WIFI_AUTH_WAPI_PSK: enc_str = "WAPI"; break;
+      default: enc_str = "Unknown"; break;
+    }
+    // The sketch spelled the five rows out; same calls, in a loop.
+    static const char* labels[5] = {"SSID", "BSSID", "RSSI", "Channel", "Encryption"};
+    String values[5] = {ap.ssid, ap.bssid, String(ap.rssi), String(ap.channel), enc_str};
+    int y = 5;
+    int16_t x1, y1;
+    uint16_t w, h;
+    int center_x;
+    for (int i = 0; i < 5; i++) {
+      String label = v.detail_index == i ? ">" + String(labels[i]) : String(labels[i]);
+      display.getTextBounds(label, 0, 0, &x1, &y1, &w, &h);
+      center_x = (GAME_WIDTH - w) / 2;
+      display.setCursor(center_x, y);
+      display.printf("%s", label.c_str());
+      display.setCursor(center_x + 1, y);
+      display.printf("%s", label.c_str());
+      y += 10;
+      display.setCursor(5, y);
+      String value = values[i];
+      String shown = (v.detail_index == i && value.length() > 9)
+                         ? value.substring(v.scroll_pos, v.scroll_pos + 9)
+                         : value;
+      display.getTextBounds(shown, 0, 0, &x1, &y1, &w, &h);
+      center_x = (GAME_WIDTH - w) / 2;
+      display.setCursor(center_x, y);
+      display.printf("%s", shown.c_str());
+      y += 10;
+    }
+  }
+}
+
+// The strips wifi_scanner keeps, rendered the way it renders them.
+struct Strips {
+  TextStrip aps_strip;
+  TextStrip marker_strip;
+  TextStrip bold_marker_strip;
+  TextStrip rescan_strip;
+  TextStrip scan_strip;
+  TextStrip label_strips[5];
+  TextStrip detail_strips[5];
+
+  Strips() {
+    static const char* labels[5] = {"SSID", "BSSID", "RSSI", "Channel", "Encryption"};
+    for (int i = 0; i < 5; i++) label_strips[i].render(labels[i], 1, true);
+    marker_strip.render(">", 1);
+    bold_marker_strip.render(">", 1, true);
+    rescan_strip.render("* Rescan", 1, true);
+    scan_strip.render("Scanning..", 1);
+  }
+
+  void renderList(std::vector<StripAP>& aps) {
+    char line[16];
+    snprintf(line, sizeof(line), "APs: %u", (unsigned)aps.size());
+    aps_strip.render(line, 1, true);
+    for (StripAP& ap : aps) ap.ssid_strip.render(ap.ssid.c_str(), 1);
+  }
+
+  void renderDetail(const AP& ap) {
+    static const char* names[] = {"Open", "WEP", "WPA", "WPA2", "WPA+WPA2",
+                                  "WPA2-EAP", "WPA3", "WPA2+WPA3", "WAPI"};
+    char num[12];
+    detail_strips[0].render(ap.ssid.c_str(), 1);
+    detail_strips[1].render(ap.bssid.c_str(), 1);
+    snprintf(num, sizeof(num), "%d", ap.rssi);
+    detail_strips[2].render(num, 1);
+    snprintf(num, sizeof(num), "%d", ap.channel);
+    detail_strips[3].render(num, 1);
+    detail_strips[4].render(ap.enc >= 0 && ap.enc <= WIFI_AUTH_WAPI_PSK ? names[ap.enc] : "Unknown", 1);
+  }
+};
+
+// wifi_scanner's frame now.
+static void drawNew(Adafruit_SSD1306& display, const std::vector<StripAP>& aps, const Strips& s,
+                    const View& v) {
+  display.clearDisplay();
+  display.drawRoundRect(0, 0, GAME_WIDTH, GAME_HEIGHT, 4, SSD1306_WHITE);
+
+  if (v.is_scanning) {
+    int center_x = (GAME_WIDTH - s.scan_strip.textWidth()) / 2;
+    int center_y = (GAME_HEIGHT - 8) / 2;
+    s.scan_strip.blit(display, center_x, center_y);
+  } else if (v.state == 0) {  // List view
+    int y = 5;
+    s.aps_strip.blit(display, 5, y);
+    y += 10;
+
+    int num_to_show = 10;
+    int total_items = aps.size() + 1;
+    for (int i = 0; i < num_to_show && v.start_index + i < total_items; ++i) {
+      int idx = v.start_index + i;
+      bool selected = idx == v.current_index;
+      if (idx < (int)aps.size()) {
+        if (selected) s.marker_strip.blit(display, 5, y);
+        aps[idx].ssid_strip.blit(display, 11, y, selected ? v.scroll_pos : 0, MARQUEE_CHARS * 6);
+      } else {
+        // Rescan option
+        if (selected) s.bold_marker_strip.blit(display, 5, y);
+        s.rescan_strip.blit(display, 11, y);
+      }
+      y += 10;
+    }
+  } else if (v.current_index < (int)aps.size()) {  // Detail view
+    int y = 5;
+    for (int i = 0; i < 5; i++) {
+      bool selected = v.detail_index == i;
+      const TextStrip& label = s.label_strips[i];
+      int label_w = (label.length() + (selected ? 1 : 0)) * 6;
+      int label_x = (GAME_WIDTH - label_w) / 2;
+      if (selected) {
+        s.bold_marker_strip.blit(display, label_x, y);
+        label_x += 6;
+      }
+      label.blit(display, label_x, y);
+      y += 10;
+
+      const TextStrip& value = s.detail_strips[i];
+      bool marquee = selected && value.length() > MARQUEE_CHARS;
+      int value_w = marquee ? MARQUEE_CHARS * 6 : value.textWidth();
+      value.blit(display, (GAME_WIDTH - value_w) / 2, y, marquee ? v.scroll_pos : 0,
+                 marquee ? MARQUEE_CHARS * 6 : 0);
+      y += 10;
+    }
+  }
+}
+
+static int startFor(int current) {
+  return current > 9 ? current - 9 : 0;
+}
+
+struct Cost {
+  double allocs;
+  double micros;
+};
+
+template <class Draw>
+static Cost measure(int frames, Draw draw) {
+  unsigned long before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; f++) draw(f);
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  return {(double)(allocations - before) / frames, us / frames};
+}
+
+int main() {
+  // 12 APs with 22-character SSIDs, as a busy scan finds them.
+  std::vector<AP> aps;
+  for (int i = 0; i < 12; i++) {
+    char ssid[32], mac[18];
+    snprintf(ssid, sizeof(ssid), "Neighbourhood-Wifi-%03d", 7 * i + 3);
+    snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", 0x3C, 0x71, 0xBF, i, 0x10 + i, 0xA0 + i);
+    aps.push_back({ssid, mac, -40 - 4 * i, 1 + i % 13, i % 10});
+  }
+  std::vector<StripAP> stripAps(aps.size());
+  for (size_t i = 0; i < aps.size(); i++) static_cast<AP&>(stripAps[i]) = aps[i];
+
+  Adafruit_SSD1306 before(128, 64), after(128, 64);
+  before.setRotation(1);
+  after.setRotation(1);
+  Strips strips;
+  strips.renderList(stripAps);
+  int failures = 0;
+
+  // Scroll offset 0: old and new frames must match.
+  auto compare = [&](const View& v, int* differ) {
+    drawOld(before, aps, v);
+    drawNew(after, stripAps, strips, v);
+    if (memcmp(before.getBuffer(), after.getBuffer(), kFrameBytes) != 0) (*differ)++;
+  };
+  int frames = 0, differ = 0;
+  for (int current = 0; current <= (int)aps.size(); current++, frames++)
+    compare({false, 0, current, startFor(current), 0, 0}, &differ);
+  printf("%-40s %s: %d of %d frames differ\n", "list view, scroll offset 0", differ ? "FAIL" : "ok",
+         differ, frames);
+  failures += differ != 0;
+
+  frames = differ = 0;
+  for (int current = 0; current < (int)aps.size(); current++) {
+    strips.renderDetail(aps[current]);
+    for (int row = 0; row < 5; row++, frames++) compare({false, 1, current, 0, row, 0}, &differ);
+  }
+  printf("%-40s %s: %d of %d frames differ\n", "detail view, scroll offset 0", differ ? "FAIL" : "ok",
+         differ, frames);
+  failures += differ != 0;
+
+  differ = 0;
+  compare({true, 0, 0, 0, 0, 0}, &differ);
+  printf("%-40s %s\n", "scanning screen", differ ? "FAIL" : "ok");
+  failures += differ != 0;
+
+  // Cost per frame, with the selection moving and the marquee stepping.
+  const int kRuns = 20000;
+  const int kSsidSteps = 22 - MARQUEE_CHARS;
+  volatile uint8_t sink = 0;
+  Cost listOld = measure(kRuns, [&](int f) {
+    int current = f / 50 % aps.size();
+    drawOld(before, aps, {false, 0, current, startFor(current), 0, f % (kSsidSteps + 1)});
+    sink += before.getBuffer()[f % kFrameBytes];
+  });
+  Cost listNew = measure(kRuns, [&](int f) {
+    int current = f / 50 % aps.size();
+    drawNew(after, stripAps, strips, {false, 0, current, startFor(current), 0, f % (kSsidSteps * 6 + 1)});
+    sink += after.getBuffer()[f % kFrameBytes];
+  });
+  strips.renderDetail(aps[5]);
+  Cost detailOld = measure(kRuns, [&](int f) {
+    drawOld(before, aps, {false, 1, 5, 0, f / 50 % 5, f % (kSsidSteps + 1)});
+    sink += before.getBuffer()[f % kFrameBytes];
+  });
+  Cost detailNew = measure(kRuns, [&](int f) {
+    drawNew(after, stripAps, strips, {false, 1, 5, 0, f / 50 % 5, f % (kSsidSteps * 6 + 1)});
+    sink += after.getBuffer()[f % kFrameBytes];
+  });
+  printf("list view:   %5.1f -> %.1f allocations/frame, %6.1f -> %5.1f us/frame\n", listOld.allocs,
+         listNew.allocs, listOld.micros, listNew.micros);
+  printf("detail view: %5.1f -> %.1f allocations/frame, %6.1f -> %5.1f us/frame\n", detailOld.allocs,
+         detailNew.allocs, detailOld.micros, detailNew.micros);
+  bool ok = listNew.allocs == 0 && detailNew.allocs == 0;
+  printf("%-40s %s\n", "strip frames allocate nothing", ok ? "ok" : "FAIL");
+  failures += !ok;
+
+  printf("%d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
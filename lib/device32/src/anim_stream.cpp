@@ -0,0 +1,199 @@
+#include "anim_stream.h"
+
+#include <string.h>
+
+#if !defined(ESP32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const uint8_t kMagic[4] = {'D', '3', '2', 'A'};
+static const uint8_t kVersion = 1;
+
+static void put16(uint8_t* p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+  put16(p, v);
+  put16(p + 2, v >> 16);
+}
+
+static uint16_t get16(const uint8_t* p) { return p[0] | p[1] << 8; }
+static uint32_t get32(const uint8_t* p) { return get16(p) | (uint32_t)get16(p + 2) << 16; }
+
+void animWriteHeader(const AnimHeader& header, uint8_t* out) {
+  memcpy(out, kMagic, 4);
+  out[4] = kVersion;
+  out[5] = kPanelWidth;
+  out[6] = kPanelHeight;
+  out[7] = 0;
+  put16(out + 8, header.frames);
+  put16(out + 10, header.delayMs);
+  put32(out + 12, header.loopOffset);
+  put32(out + 16, header.size);
+}
+
+size_t animEncodeDelta(const uint8_t* prev, const uint8_t* next, uint8_t* out) {
+  uint8_t* o = out;
+  int i = 0;
+  auto delta = [&](int k) { return (uint8_t)(prev[k] ^ next[k]); };
+  auto repeats = [&](int k) {
+    int n = 1;
+    while (k + n < kFrameBytes && n < 64 && delta(k + n) == delta(k)) n++;
+    return n;
+  };
+
+  while (i < kFrameBytes) {
+    if (delta(i) == 0) {
+      int n = 1;
+      while (i + n < kFrameBytes && n < 128 && delta(i + n) == 0) n++;
+      *o++ = n - 1;
+      i += n;
+      continue;
+    }
+    int n = repeats(i);
+    if (n >= 2) {
+      *o++ = 0xC0 | (n - 1);
+      *o++ = delta(i);
+      i += n;
+      continue;
+    }
+    // Literal run up to the next stretch worth its own token: two unchanged
+    // bytes or three repeats.
+    int start = i;
+    n = 0;
+    while (i + n < kFrameBytes && n < 64) {
+      int k = i + n;
+      if (delta(k) == 0 && k + 1 < kFrameBytes && delta(k + 1) == 0) break;
+      if (delta(k) != 0 && repeats(k) >= 3) break;
+      n++;
+    }
+    *o++ = 0x80 | (n - 1);
+    for (int k = start; k < start + n; k++) *o++ = delta(k);
+    i += n;
+  }
+  return o - out;
+}
+
+const uint8_t* animApplyDelta(const uint8_t* p, const uint8_t* end, uint8_t* frame) {
+  int i = 0;
+  while (i < kFrameBytes) {
+    if (p == end) return nullptr;
+    uint8_t c = *p++;
+    int n = (c < 0x80 ? c : c & 0x3F) + 1;
+    if (i + n > kFrameBytes) return nullptr;
+    if (c < 0x80) {
+      i += n;
+    } else if (c < 0xC0) {
+      if (end - p < n) return nullptr;
+      for (uint8_t* f = frame + i; n--; i++) *f++ ^= *p++;
+    } else {
+      if (p == end) return nullptr;
+      uint8_t b = *p++;
+      for (uint8_t* f = frame + i; n--; i++) *f++ ^= b;
+    }
+  }
+  return p;
+}
+
+bool AnimPlayer::begin(const uint8_t* stream, size_t size) {
+  _stream = nullptr;
+  if (size < kAnimHeaderBytes || memcmp(stream, kMagic, 4) != 0 || stream[4] != kVersion ||
+      stream[5] != kPanelWidth || stream[6] != kPanelHeight) {
+    return false;
+  }
+  _header.frames = get16(stream + 8);
+  _header.delayMs = get16(stream + 10);
+  _header.loopOffset = get32(stream + 12);
+  _header.size = get32(stream + 16);
+  if (_header.frames == 0 || _header.size > size || _header.loopOffset >= _header.size ||
+      _header.loopOffset < kAnimHeaderBytes) {
+    return false;
+  }
+  _stream = stream;
+  rewind();
+  return true;
+}
+
+void AnimPlayer::rewind() {
+  _pos = kAnimHeaderBytes;
+  _index = 0;
+  _delta = 0;
+}
+
+bool AnimPlayer::next(uint8_t* frame) {
+  if (!_stream) return false;
+  const uint8_t* p = animApplyDelta(_stream + _pos, _stream + _header.size, frame);
+  if (!p) return false;
+
+  // Delta k produces frame k; delta frames() leads back to frame 0, after
+  // which playback carries on from delta 1 at loopOffset.
+  if (_delta == _header.frames) {
+    _index = 0;
+    _delta = 1;
+    _pos = _header.loopOffset;
+  } else {
+    _index = _delta++;
+    _pos = p - _stream;
+  }
+  return true;
+}
+
+#if defined(ESP32)
+
+bool AnimSource::open(const char* name) {
+  close();
+  const esp_partition_t* part =
+      esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, name);
+  if (!part) return false;
+  const void* mapped;
+  if (esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &mapped, &_handle) != ESP_OK) {
+    return false;
+  }
+  _data = static_cast<const uint8_t*>(mapped);
+  _size = part->size;
+  return true;
+}
+
+void AnimSource::close() {
+  if (!_data) return;
+  spi_flash_munmap(_handle);
+  _data = nullptr;
+  _size = 0;
+}
+
+#else
+
+bool AnimSource::open(const char* name) {
+  close();
+  int fd = ::open(name, O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  void* mapped = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  if (mapped == MAP_FAILED) {
+    ::close(fd);
+    return false;
+  }
+  _fd = fd;
+  _data = static_cast<const uint8_t*>(mapped);
+  _size = st.st_size;
+  return true;
+}
+
+void AnimSource::close() {
+  if (!_data) return;
+  munmap(const_cast<uint8_t*>(_data), _size);
+  ::close(_fd);
+  _fd = -1;
+  _data = nullptr;
+  _size = 0;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "panel.h"
+
+#if defined(ESP32)
+#include <esp_partition.h>
+#endif
+
+// 1bpp animation stream for a 128x64 SSD1306, made to be played straight
+// out of memory-mapped flash. Every frame is stored as the XOR of it with
+// the frame before (black before the first), in SSD1306 page order, and
+// run-length coded:
+//
+//   0x00-0x7F  n + 1 bytes unchanged
+//   0x80-0xBF  n + 1 bytes follow, XOR them in
+//   0xC0-0xFF  one byte follows, XOR it into the next n + 1 bytes
+//
+// A frame's tokens cover exactly kFrameBytes. After the last frame comes
+// one more delta that leads back to the first, so playback loops without
+// a keyframe. Header, little-endian:
+//
+//   0  "D32A"      4  version (1), width, height, 0
+//   8  frames u16  10 delay per frame in ms, u16
+//   12 offset of frame 1 from the start of the stream, u32
+//   16 total stream size in bytes, u32
+constexpr size_t kAnimHeaderBytes = 20;
+
+struct AnimHeader {
+  uint16_t frames;
+  uint16_t delayMs;
+  uint32_t loopOffset;
+  uint32_t size;
+};
+
+// Write the header into out (kAnimHeaderBytes).
+void animWriteHeader(const AnimHeader& header, uint8_t* out);
+
+// Encode the XOR delta from prev to next into out, which must hold the
+// worst case of kFrameBytes + kFrameBytes / 64 bytes. Returns the bytes
+// written.
+size_t animEncodeDelta(const uint8_t* prev, const uint8_t* next, uint8_t* out);
+
+// XOR one frame's tokens, starting at p, into frame. Returns the first byte
+// after them, or nullptr if they run past end or overshoot the frame.
+const uint8_t* animApplyDelta(const uint8_t* p, const uint8_t* end, uint8_t* frame);
+
+// Plays a stream in place. next() XORs the following delta straight into
+// the caller's frame (e.g. display.getBuffer()); there is no decode
+// buffer, so the frame must hold the previous frame of the animation,
+// black before the first call.
+class AnimPlayer {
+ public:
+  // Check the header and point at the first frame. Returns false if the
+  // data is not a stream for this panel or is shorter than it claims.
+  bool begin(const uint8_t* stream, size_t size);
+
+  // Apply the next delta to frame, looping at the end. Returns false (and
+  // leaves the frame half-decoded) if the stream is corrupt.
+  bool next(uint8_t* frame);
+
+  // Rewind to the first frame; the caller clears its frame.
+  void rewind();
+
+  uint16_t frames() const { return _header.frames; }
+  uint16_t delayMs() const { return _header.delayMs; }
+  // Index of the frame the last next() produced.
+  uint16_t frameIndex() const { return _index; }
+  bool valid() const { return _stream != nullptr; }
+
+ private:
+  const uint8_t* _stream = nullptr;
+  AnimHeader _header = {};
+  size_t _pos = 0;
+  uint16_t _index = 0;
+  uint16_t _delta = 0;  // next delta to apply, 0..frames()
+};
+
+// Read-only memory map of an animation. On the ESP32 name is the label of
+// a data partition, mapped with esp_partition_mmap(); on host builds it is
+// a file path, mapped with mmap(), as a stand-in for the partition.
+class AnimSource {
+ public:
+  ~AnimSource() { close(); }
+
+  bool open(const char* name);
+  void close();
+
+  const uint8_t* data() const { return _data; }
+  size_t size() const { return _size; }
+
+ private:
+  const uint8_t* _data = nullptr;
+  size_t _size = 0;
+#if defined(ESP32)
+  spi_flash_mmap_handle_t _handle = 0;
+#else
+  int _fd = -1;
+#endif
+};
@@ -0,0 +1,138 @@
+#include "async_flush.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+// _front is only written here, on the loop's side, so comparing against it
+// while the task sends it is safe.
+bool AsyncFlush::unchanged(const uint8_t* frame) {
+  if (_presented && memcmp(_front, frame, kFrameBytes) == 0) {
+    _skipped++;
+    return true;
+  }
+  _presented = true;
+  return false;
+}
+
+void AsyncFlush::invalidate() {
+  fence();
+  _flusher.invalidate();
+  _presented = false;
+}
+
+void AsyncFlush::sendPending() {
+  uint32_t start = micros();
+  _flusher.flush(_front);
+  _sendMicros = micros() - start;
+}
+
+#if defined(ESP32)
+
+void AsyncFlush::taskEntry(void* arg) {
+  static_cast<AsyncFlush*>(arg)->run();
+}
+
+void AsyncFlush::run() {
+  for (;;) {
+    xSemaphoreTake(_kick, portMAX_DELAY);
+    sendPending();
+    xSemaphoreGive(_done);
+  }
+}
+
+bool AsyncFlush::begin() {
+  _kick = xSemaphoreCreateBinary();
+  _done = xSemaphoreCreateBinary();
+  if (_kick == nullptr || _done == nullptr) return false;
+  xSemaphoreGive(_done);
+  // One priority above loop() so a presented frame starts sending right
+  // away; the task sleeps inside the I2C driver while bytes shift out.
+  _started = xTaskCreate(taskEntry, "flush", 3072, this, 2, nullptr) == pdPASS;
+  return _started;
+}
+
+void AsyncFlush::present(const uint8_t* frame) {
+  if (unchanged(frame)) return;
+  if (!_started) {
+    memcpy(_front, frame, kFrameBytes);
+    sendPending();
+    return;
+  }
+  uint32_t start = micros();
+  xSemaphoreTake(_done, portMAX_DELAY);
+  _waitMicros = micros() - start;
+  memcpy(_front, frame, kFrameBytes);
+  xSemaphoreGive(_kick);
+}
+
+void AsyncFlush::fence() {
+  if (!_started) return;
+  xSemaphoreTake(_done, portMAX_DELAY);
+  xSemaphoreGive(_done);
+}
+
+bool AsyncFlush::busy() {
+  return _started && uxSemaphoreGetCount(_done) == 0;
+}
+
+#else
+
+// Host builds run the sender on a std::thread so ordering and overlap can
+// be exercised against a mock Ssd1306Bus.
+void AsyncFlush::run() {
+  std::unique_lock<std::mutex> guard(_lock);
+  for (;;) {
+    _changed.wait(guard, [this] { return _pending || _stop; });
+    if (_stop) return;
+    guard.unlock();
+    sendPending();
+    guard.lock();
+    _pending = false;
+    _changed.notify_all();
+  }
+}
+
+bool AsyncFlush::begin() {
+  _thread = std::thread(&AsyncFlush::run, this);
+  _started = true;
+  return true;
+}
+
+AsyncFlush::~AsyncFlush() {
+  if (!_started) return;
+  fence();
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _stop = true;
+  }
+  _changed.notify_all();
+  _thread.join();
+}
+
+void AsyncFlush::present(const uint8_t* frame) {
+  if (unchanged(frame)) return;
+  if (!_started) {
+    memcpy(_front, frame, kFrameBytes);
+    sendPending();
+    return;
+  }
+  uint32_t start = micros();
+  std::unique_lock<std::mutex> guard(_lock);
+  _changed.wait(guard, [this] { return !_pending; });
+  _waitMicros = micros() - start;
+  memcpy(_front, frame, kFrameBytes);
+  _pending = true;
+  _changed.notify_all();
+}
+
+void AsyncFlush::fence() {
+  std::unique_lock<std::mutex> guard(_lock);
+  _changed.wait(guard, [this] { return !_pending; });
+}
+
+bool AsyncFlush::busy() {
+  std::lock_guard<std::mutex> guard(_lock);
+  return _pending;
+}
+
+#endif
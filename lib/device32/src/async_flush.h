@@ -0,0 +1,77 @@
+#pragma once
+
+#include "dirty_flush.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// Double-buffered flush: present() copies the finished frame into a send
+// buffer and returns, and a background task pushes it through DirtyFlush
+// while the scene renders the next frame. The scene keeps drawing into the
+// display buffer, which is never on the bus; only the send buffer is.
+//
+// present() waits for the previous frame to finish before reusing the send
+// buffer. A frame the same as the last one presented is dropped at once,
+// with no wait and no wake of the task, and counted as skipped. Anything
+// else that talks to the panel directly (display.display(),
+// ssd1306_command(), dim()) must call fence() first.
+class AsyncFlush {
+ public:
+  explicit AsyncFlush(DirtyFlush& flusher) : _flusher(flusher) {}
+#if !defined(ESP32)
+  ~AsyncFlush();
+#endif
+
+  // Start the sender task. Returns false if it could not be created, in
+  // which case present() flushes synchronously.
+  bool begin();
+
+  void present(const uint8_t* frame);
+
+  // Block until the last presented frame is on the panel.
+  void fence();
+  bool busy();
+  // Resend the whole next frame, even one equal to the last, e.g. after
+  // the panel was drawn to directly.
+  void invalidate();
+
+  // Time present() spent waiting for the previous transfer, and how long
+  // that transfer took. A wait near zero means rendering fully hides the
+  // flush.
+  uint32_t lastWaitMicros() const { return _waitMicros; }
+  uint32_t lastSendMicros() const { return _sendMicros; }
+  // Frames present() dropped as unchanged.
+  uint32_t skipped() const { return _skipped; }
+
+ private:
+  bool unchanged(const uint8_t* frame);
+  void sendPending();
+  void run();
+
+  DirtyFlush& _flusher;
+  uint8_t _front[kFrameBytes];
+  bool _started = false;
+  bool _presented = false;  // _front holds the last frame presented
+  uint32_t _skipped = 0;
+  volatile uint32_t _waitMicros = 0;
+  volatile uint32_t _sendMicros = 0;
+
+#if defined(ESP32)
+  static void taskEntry(void* arg);
+  SemaphoreHandle_t _kick = nullptr;
+  SemaphoreHandle_t _done = nullptr;
+#else
+  std::thread _thread;
+  std::mutex _lock;
+  std::condition_variable _changed;
+  bool _pending = false;
+  bool _stop = false;
+#endif
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+// Ordered-dither ranks, the usual recursive Bayer matrices (each 2x2 block
+// visits 0, 2, 3, 1). The rank of (x, y) is the bits of x ^ y and y
+// interleaved and reversed, so the matrices are computed rather than typed
+// out, and every user sees the same ordering.
+constexpr uint8_t bayer4(int x, int y) {
+  return (uint8_t)(((x ^ y) & 1) << 3 | (y & 1) << 2 | ((x ^ y) & 2) | (y & 2) >> 1);
+}
+
+constexpr uint8_t bayer8(int x, int y) {
+  return (uint8_t)(((x ^ y) & 1) << 5 | (y & 1) << 4 | ((x ^ y) & 2) << 2 | (y & 2) << 1 |
+                   ((x ^ y) & 4) >> 1 | (y & 4) >> 2);
+}
+
+#define DEVICE32_BAYER4_ROW(y) bayer4(0, y), bayer4(1, y), bayer4(2, y), bayer4(3, y)
+#define DEVICE32_BAYER8_ROW(y)                                            \
+  bayer8(0, y), bayer8(1, y), bayer8(2, y), bayer8(3, y), bayer8(4, y), \
+      bayer8(5, y), bayer8(6, y), bayer8(7, y)
+
+// The same ranks tabulated row by row: kBayer4[y * 4 + x], kBayer8[y * 8 + x].
+constexpr uint8_t kBayer4[16] = {
+  DEVICE32_BAYER4_ROW(0), DEVICE32_BAYER4_ROW(1), DEVICE32_BAYER4_ROW(2), DEVICE32_BAYER4_ROW(3),
+};
+constexpr uint8_t kBayer8[64] = {
+  DEVICE32_BAYER8_ROW(0), DEVICE32_BAYER8_ROW(1), DEVICE32_BAYER8_ROW(2), DEVICE32_BAYER8_ROW(3),
+  DEVICE32_BAYER8_ROW(4), DEVICE32_BAYER8_ROW(5), DEVICE32_BAYER8_ROW(6), DEVICE32_BAYER8_ROW(7),
+};
+
+#undef DEVICE32_BAYER4_ROW
+#undef DEVICE32_BAYER8_ROW
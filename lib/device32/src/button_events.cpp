@@ -0,0 +1,107 @@
+#include "button_events.h"
+
+void ButtonRecognizer::setTimes(uint16_t debounceMs, uint16_t longMs, uint16_t doubleMs) {
+  _debounce = debounceMs;
+  _long = longMs;
+  _double = doubleMs;
+}
+
+void ButtonRecognizer::edge(bool down, uint32_t atMs) {
+  if (_locked && atMs - _lockedAt >= _debounce) poll(atMs);
+  if (down == _raw) return;
+  _raw = down;
+  if (_locked) {
+    _bounces++;
+    return;
+  }
+  if (down != _level) accept(down, atMs);
+}
+
+void ButtonRecognizer::poll(uint32_t nowMs) {
+  if (_locked && nowMs - _lockedAt >= _debounce) {
+    _locked = false;
+    // The contacts settled away from the level taken at the window's start.
+    if (_raw != _level) accept(_raw, _lockedAt + _debounce);
+  }
+  if ((_state == kPressed || _state == kSecond) && nowMs - _pressAt >= _long) {
+    if (_state == kSecond) emit(ButtonEventKind::kTap, _releaseAt);
+    emit(ButtonEventKind::kLongPress, _pressAt + _long);
+    _state = kHeld;
+  }
+  if (_state == kReleased && nowMs - _releaseAt >= _double) {
+    emit(ButtonEventKind::kTap, _releaseAt);
+    _state = kIdle;
+  }
+}
+
+uint32_t ButtonRecognizer::msUntilDue(uint32_t nowMs) const {
+  uint32_t wait = UINT32_MAX;
+  auto until = [&](uint32_t from, uint32_t ms) {
+    uint32_t gone = nowMs - from;
+    uint32_t left = gone >= ms ? 0 : ms - gone;
+    if (left < wait) wait = left;
+  };
+  if (_locked) until(_lockedAt, _debounce);
+  if (_state == kPressed || _state == kSecond) until(_pressAt, _long);
+  if (_state == kReleased) until(_releaseAt, _double);
+  return wait;
+}
+
+void ButtonRecognizer::accept(bool down, uint32_t atMs) {
+  _level = down;
+  _locked = true;
+  _lockedAt = atMs;
+
+  if (down) {
+    // A tap whose double-tap window ran out before anyone polled.
+    if (_state == kReleased && atMs - _releaseAt >= _double) {
+      emit(ButtonEventKind::kTap, _releaseAt);
+      _state = kIdle;
+    }
+    _state = _state == kReleased ? kSecond : kPressed;
+    _pressAt = atMs;
+    emit(ButtonEventKind::kDown, atMs);
+    return;
+  }
+
+  // Released. A press that reached longMs is a long press even if nobody
+  // polled in time to see it held.
+  if ((_state == kPressed || _state == kSecond) && atMs - _pressAt >= _long) {
+    if (_state == kSecond) emit(ButtonEventKind::kTap, _releaseAt);
+    emit(ButtonEventKind::kLongPress, _pressAt + _long);
+    _state = kIdle;
+  } else if (_state == kPressed) {
+    if (_double) {
+      _state = kReleased;
+      _releaseAt = atMs;
+    } else {
+      emit(ButtonEventKind::kTap, atMs);
+      _state = kIdle;
+    }
+  } else if (_state == kSecond) {
+    emit(ButtonEventKind::kDoubleTap, atMs);
+    _state = kIdle;
+  } else {
+    _state = kIdle;
+  }
+}
+
+void ButtonRecognizer::emit(ButtonEventKind kind, uint32_t atMs) {
+  if (_count == kMaxEvents) {
+    _head = (_head + 1) % kMaxEvents;
+    _count--;
+    _lost++;
+  }
+  ButtonEvent& e = _events[(_head + _count) % kMaxEvents];
+  e.kind = kind;
+  e.atMs = atMs;
+  _count++;
+}
+
+bool ButtonRecognizer::next(ButtonEvent& event) {
+  if (_count == 0) return false;
+  event = _events[_head];
+  _head = (_head + 1) % kMaxEvents;
+  _count--;
+  return true;
+}
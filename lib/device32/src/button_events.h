@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+
+// Gesture recognizer for one push button, fed with timestamped edges rather
+// than polled levels, so it can be driven from an interrupt queue (see
+// button_input.h) or from a script on the host (bench/button_bench.cpp).
+//
+// Debounce is leading-edge: the first edge after a quiet spell counts at
+// once and the contacts are ignored for debounceMs after it. If they have
+// settled the other way by then, that level is taken when the window ends,
+// so a release that bounced is not lost.
+//
+// Events, all stamped with the time of the edge that decided them:
+//   kDown       on every press, before the gesture is known
+//   kTap        press and release within longMs; when double taps are on,
+//               reported only once doubleMs passes without a second press
+//   kDoubleTap  second press within doubleMs of a tap's release (reported
+//               on its release)
+//   kLongPress  held for longMs, reported while still held
+enum class ButtonEventKind : uint8_t { kDown, kTap, kDoubleTap, kLongPress };
+
+struct ButtonEvent {
+  ButtonEventKind kind;
+  uint32_t atMs;
+};
+
+class ButtonRecognizer {
+ public:
+  // doubleMs 0 turns double taps off, so taps are not held back.
+  explicit ButtonRecognizer(uint16_t debounceMs = 20, uint16_t longMs = 1000, uint16_t doubleMs = 0)
+    : _debounce(debounceMs), _long(longMs), _double(doubleMs) {}
+
+  void setTimes(uint16_t debounceMs, uint16_t longMs, uint16_t doubleMs);
+
+  // A raw edge: the pin read pressed (down) or released at atMs. Edges must
+  // come in time order; repeats of the same level are ignored.
+  void edge(bool down, uint32_t atMs);
+  // Let time pass: settle a bounced level, and time out long presses and
+  // double-tap windows. Call before taking events.
+  void poll(uint32_t nowMs);
+
+  // Milliseconds from nowMs until poll() has something to time out (a
+  // debounce window, a hold, a double-tap window), 0 if it is overdue, or
+  // UINT32_MAX if nothing can happen before the next edge.
+  uint32_t msUntilDue(uint32_t nowMs) const;
+
+  // Oldest pending event, if any. Up to kMaxEvents are held; past that the
+  // oldest is dropped and counted.
+  bool next(ButtonEvent& event);
+
+  // Debounced state.
+  bool down() const { return _level; }
+  // Edges thrown away as bounce, and events lost to a full queue.
+  uint32_t bounces() const { return _bounces; }
+  uint32_t lost() const { return _lost; }
+
+  static constexpr int kMaxEvents = 8;
+
+ private:
+  enum State : uint8_t { kIdle, kPressed, kHeld, kReleased, kSecond };
+
+  void accept(bool down, uint32_t atMs);
+  void emit(ButtonEventKind kind, uint32_t atMs);
+
+  uint16_t _debounce;
+  uint16_t _long;
+  uint16_t _double;
+
+  bool _level = false;      // debounced
+  bool _raw = false;        // last edge seen
+  bool _locked = false;     // inside a debounce window
+  uint32_t _lockedAt = 0;   // start of that window
+  State _state = kIdle;
+  uint32_t _pressAt = 0;
+  uint32_t _releaseAt = 0;
+
+  ButtonEvent _events[kMaxEvents];
+  uint8_t _head = 0;
+  uint8_t _count = 0;
+  uint32_t _bounces = 0;
+  uint32_t _lost = 0;
+};
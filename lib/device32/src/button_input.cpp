@@ -0,0 +1,112 @@
+#include "button_input.h"
+
+#include <Arduino.h>
+#include <atomic>
+
+void ButtonInput::begin() {
+  pinMode(_pin, INPUT_PULLUP);
+  _last = digitalRead(_pin) == LOW;
+  if (_last) _recognizer.edge(true, millis());
+#if defined(ESP32)
+  _edge = xSemaphoreCreateBinary();
+  attachInterruptArg(_pin, onEdge, this, CHANGE);
+#endif
+}
+
+// The interrupt is attached from the loop's core, so it and update() never
+// run at once; a compiler fence is enough to publish the slot before the
+// index that hands it over.
+#if defined(ESP32)
+void IRAM_ATTR ButtonInput::onEdge(void* arg) {
+  ButtonInput* self = static_cast<ButtonInput*>(arg);
+  uint8_t head = self->_head;
+  uint8_t next = (head + 1) % kRingSize;
+  if (next == self->_tail) {
+    self->_overflowed = true;
+    return;
+  }
+  self->_ring[head].atMs = millis();
+  self->_ring[head].down = digitalRead(self->_pin) == LOW;
+  std::atomic_signal_fence(std::memory_order_release);
+  self->_head = next;
+  if (self->_edge) {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(self->_edge, &woken);
+    if (woken) portYIELD_FROM_ISR();
+  }
+}
+#else
+void ButtonInput::onEdge(void*) {}
+#endif
+
+void ButtonInput::update() {
+#if defined(ESP32)
+  // Take the head before the time, so every edge in the ring is older.
+  uint8_t tail = _tail;
+  uint8_t head = _head;
+  std::atomic_signal_fence(std::memory_order_acquire);
+  uint32_t now = millis();
+  while (tail != head) {
+    const Edge& e = _ring[tail];
+    if (now - e.atMs > _worstLag) _worstLag = now - e.atMs;
+    _recognizer.edge(e.down, e.atMs);
+    _edges++;
+    tail = (tail + 1) % kRingSize;
+  }
+  _tail = tail;
+  if (_overflowed) {
+    _overflowed = false;
+    _overflows++;
+    _recognizer.edge(digitalRead(_pin) == LOW, now);
+  }
+#else
+  uint32_t now = millis();
+  bool level = digitalRead(_pin) == LOW;
+  if (level != _last) {
+    _last = level;
+    _recognizer.edge(level, now);
+    _edges++;
+  }
+#endif
+  _recognizer.poll(now);
+}
+
+// An edge waiting in the ring, or a level change update() has not seen.
+bool ButtonInput::pending() {
+#if defined(ESP32)
+  return _head != _tail || _overflowed;
+#else
+  return (digitalRead(_pin) == LOW) != _last;
+#endif
+}
+
+uint32_t ButtonInput::wait(uint32_t maxMs) {
+  uint32_t start = millis();
+  uint32_t due = _recognizer.msUntilDue(start);
+  if (due < maxMs) maxMs = due;
+  if (maxMs == 0 || pending()) return 0;
+#if defined(ESP32)
+  // Clear a give left by an edge update() has already taken, then check
+  // the ring again so an edge in between is not slept through.
+  xSemaphoreTake(_edge, 0);
+  if (pending()) return 0;
+  if (xSemaphoreTake(_edge, pdMS_TO_TICKS(maxMs)) == pdTRUE) _wakes++;
+#else
+  for (uint32_t slept = 0; slept < maxMs && !pending();) {
+    uint32_t step = maxMs - slept < 10 ? maxMs - slept : 10;
+    delay(step);
+    slept += step;
+  }
+  if (pending()) _wakes++;
+#endif
+  uint32_t slept = millis() - start;
+  _idle += slept;
+  return slept;
+}
+
+void ButtonInput::printStats(Print& out) const {
+  out.printf("button: %lu edges, %lu bounces, %lu overflows, worst lag %lu ms, idle %lu ms (%lu woken)\n",
+             (unsigned long)_edges, (unsigned long)_recognizer.bounces(),
+             (unsigned long)_overflows, (unsigned long)_worstLag,
+             (unsigned long)_idle, (unsigned long)_wakes);
+}
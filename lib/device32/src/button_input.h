@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Print.h>
+#include <stdint.h>
+
+#include "button_events.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+// Push button on a pulled-up, active-low pin, read by a GPIO interrupt. The
+// interrupt stamps each edge with millis() and puts it in a small
+// single-producer ring; update() hands the edges to a ButtonRecognizer, so
+// taps and holds are timed from when they happened, not from when the loop
+// got round to looking, and nothing is missed while a frame is busy.
+//
+//   ButtonInput button(BUTTON_PIN, BUTTON_TAP_TIME, 3000);
+//   button.begin();                  // in setup()
+//   ...
+//   button.update();                 // once per loop() pass
+//   ButtonEvent e;
+//   while (button.next(e)) { ... }
+//
+// A loop with nothing to draw can sleep in wait() instead of delay(); the
+// interrupt wakes it at the next edge.
+//
+// Without ESP32 there is no interrupt and update() samples the pin instead.
+class ButtonInput {
+ public:
+  ButtonInput(uint8_t pin, uint16_t debounceMs, uint16_t longMs, uint16_t doubleMs = 0)
+    : _pin(pin), _recognizer(debounceMs, longMs, doubleMs) {}
+
+  void begin();
+
+  // Move queued edges into the recognizer and let it time out holds and
+  // double-tap windows.
+  void update();
+  bool next(ButtonEvent& event) { return _recognizer.next(event); }
+  bool down() const { return _recognizer.down(); }
+
+  // Sleep until an edge comes in, the recognizer has a hold or window to
+  // time out, or maxMs pass, whichever is first. Returns the time slept.
+  // Without the interrupt it polls the pin every 10 ms.
+  uint32_t wait(uint32_t maxMs);
+
+  ButtonRecognizer& recognizer() { return _recognizer; }
+
+  uint32_t edges() const { return _edges; }
+  // Times the ring filled up; the level is read again to resync.
+  uint32_t overflows() const { return _overflows; }
+  // Longest an edge sat in the ring before update() took it.
+  uint32_t worstLagMs() const { return _worstLag; }
+  // Time spent in wait(), and waits an edge cut short.
+  uint32_t idleMillis() const { return _idle; }
+  uint32_t wakes() const { return _wakes; }
+
+  void printStats(Print& out) const;
+
+  static constexpr int kRingSize = 16;
+
+ private:
+  struct Edge {
+    uint32_t atMs;
+    bool down;
+  };
+
+  static void onEdge(void* arg);
+  bool pending();
+
+  uint8_t _pin;
+  ButtonRecognizer _recognizer;
+  Edge _ring[kRingSize];
+  volatile uint8_t _head = 0;  // written by the interrupt
+  volatile uint8_t _tail = 0;  // written by update()
+  volatile bool _overflowed = false;
+  bool _last = false;  // last level sampled, without an interrupt
+  uint32_t _edges = 0;
+  uint32_t _overflows = 0;
+  uint32_t _worstLag = 0;
+  uint32_t _idle = 0;
+  uint32_t _wakes = 0;
+#if defined(ESP32)
+  SemaphoreHandle_t _edge = nullptr;  // given by the interrupt, taken by wait()
+#endif
+};
@@ -0,0 +1,87 @@
+#include "cell_canvas.h"
+
+#include <Adafruit_SSD1306.h>
+#include <string.h>
+
+// Four source rows to one panel byte at scale 2 (bit n -> bits 2n, 2n+1).
+static const uint8_t kSpread2[16] = {
+  0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F,
+  0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF,
+};
+// Two source rows to one panel byte at scale 4.
+static const uint8_t kSpread4[4] = {0x00, 0x0F, 0xF0, 0xFF};
+
+// Clamp a dimension so the upscaled canvas fits the panel, which also
+// keeps the cells within kMaxCells.
+static int16_t fit(int16_t cells, int16_t panel, uint8_t scale) {
+  int16_t most = panel / (scale == 4 ? 4 : 2);
+  return cells < 0 ? 0 : cells > most ? most : cells;
+}
+
+CellCanvas::CellCanvas(int16_t width, int16_t height, uint8_t scale)
+  : Adafruit_GFX(fit(width, kPanelWidth, scale), fit(height, kPanelHeight, scale)),
+    _scale(scale == 4 ? 4 : 2) {
+  static_assert(kPanelWidth / 2 * ((kPanelHeight / 2 + 7) / 8) <= kMaxCells,
+                "the largest canvas must fit the cell array");
+}
+
+void CellCanvas::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
+  uint8_t& b = _cells[x + (y >> 3) * WIDTH];
+  uint8_t bit = 1 << (y & 7);
+  switch (color) {
+    case SSD1306_WHITE: b |= bit; break;
+    case SSD1306_BLACK: b &= ~bit; break;
+    case SSD1306_INVERSE: b ^= bit; break;
+  }
+}
+
+void CellCanvas::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  int x0 = max<int>(x, 0), x1 = min<int>(x + w, WIDTH);
+  int y0 = max<int>(y, 0), y1 = min<int>(y + h, HEIGHT);
+  if (x0 >= x1 || y0 >= y1) return;
+  // One byte mask per column per page the span touches.
+  for (int page = y0 >> 3; page <= (y1 - 1) >> 3; page++) {
+    int top = max(y0, page * 8), bottom = min(y1, page * 8 + 8);
+    uint8_t mask = (uint8_t)((0xFF << (top & 7)) & (0xFF >> (7 - ((bottom - 1) & 7))));
+    uint8_t* row = _cells + page * WIDTH;
+    for (int i = x0; i < x1; i++) {
+      switch (color) {
+        case SSD1306_WHITE: row[i] |= mask; break;
+        case SSD1306_BLACK: row[i] &= ~mask; break;
+        case SSD1306_INVERSE: row[i] ^= mask; break;
+      }
+    }
+  }
+}
+
+void CellCanvas::fillScreen(uint16_t color) {
+  if (color == SSD1306_INVERSE) {
+    fillRect(0, 0, WIDTH, HEIGHT, color);
+    return;
+  }
+  memset(_cells, color == SSD1306_WHITE ? 0xFF : 0x00, sizeof(_cells));
+}
+
+void CellCanvas::blit(uint8_t* frame) const {
+  int srcPages = (HEIGHT + 7) >> 3;
+  int destPages = min<int>((HEIGHT * _scale + 7) >> 3, kPanelPages);
+  // Each source page covers _scale panel pages; part k of a source byte
+  // becomes panel page sp * _scale + k.
+  for (int sp = 0; sp < srcPages; sp++) {
+    const uint8_t* src = _cells + sp * WIDTH;
+    for (int k = 0; k < _scale; k++) {
+      int dp = sp * _scale + k;
+      if (dp >= destPages) return;
+      uint8_t* dst = frame + dp * kPanelWidth;
+      if (_scale == 2) {
+        // Columns land on even offsets of an aligned buffer.
+        uint16_t* out = reinterpret_cast<uint16_t*>(dst);
+        for (int x = 0; x < WIDTH; x++) out[x] = kSpread2[(src[x] >> (k * 4)) & 0x0F] * 0x0101u;
+      } else {
+        uint32_t* out = reinterpret_cast<uint32_t*>(dst);
+        for (int x = 0; x < WIDTH; x++) out[x] = kSpread4[(src[x] >> (k * 2)) & 0x03] * 0x01010101u;
+      }
+    }
+  }
+}
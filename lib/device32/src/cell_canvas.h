@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+
+#include "panel.h"
+
+// Low-resolution Adafruit_GFX target for grid scenes: one bit per cell,
+// stored in SSD1306 page order (byte x + (y / 8) * width, bit y & 7).
+// blit() upscales it by an integer factor of 2 or 4 straight into an
+// SSD1306 framebuffer: a byte table expands each source bit into a 2- or
+// 4-row run, and each expanded byte is written to 2 or 4 columns with a
+// single 16- or 32-bit store.
+//
+// A 64x32 board at scale 2 is 256 source bytes and 512 word stores,
+// where drawing it with fillRect() is up to 2048 calls into the per-pixel
+// GFX path.
+class CellCanvas : public Adafruit_GFX {
+ public:
+  // scale is 2 or 4. width * scale and height * scale must fit the panel,
+  // so at most 64x32 cells at scale 2 and 32x16 at scale 4 (kMaxCells
+  // bytes); larger dimensions are clamped to those.
+  CellCanvas(int16_t width, int16_t height, uint8_t scale);
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+    fillRect(x, y, w, 1, color);
+  }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+    fillRect(x, y, 1, h, color);
+  }
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+    fillRect(x, y, w, 1, color);
+  }
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+    fillRect(x, y, 1, h, color);
+  }
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+    fillRect(x, y, w, h, color);
+  }
+
+  // Unchecked cell write for tight loops that already stay in bounds.
+  void set(int16_t x, int16_t y, bool on) {
+    uint8_t& b = _cells[x + (y >> 3) * WIDTH];
+    uint8_t bit = 1 << (y & 7);
+    b = on ? (b | bit) : (b & ~bit);
+  }
+  bool get(int16_t x, int16_t y) const {
+    return _cells[x + (y >> 3) * WIDTH] & (1 << (y & 7));
+  }
+
+  // Overwrite the top-left width*scale x height*scale pixels of a 128x64
+  // SSD1306 framebuffer (4-byte aligned, e.g. Adafruit_SSD1306::getBuffer()).
+  void blit(uint8_t* frame) const;
+
+ private:
+  static constexpr int kMaxCells = kFrameBytes / 4;  // 64x32 at scale 2
+
+  uint8_t _scale;
+  uint8_t _cells[kMaxCells] = {};
+};
@@ -0,0 +1,78 @@
+#include "compositor.h"
+
+#include <Adafruit_SSD1306.h>
+#include <string.h>
+
+Overlay::Overlay() : Adafruit_GFX(kPanelWidth, kPanelHeight) {
+  clear();
+}
+
+void Overlay::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || x >= width() || y < 0 || y >= height()) return;
+  switch (rotation) {
+    case 1: _swap_int16_t(x, y); x = WIDTH - x - 1; break;
+    case 2: x = WIDTH - x - 1; y = HEIGHT - y - 1; break;
+    case 3: _swap_int16_t(x, y); y = HEIGHT - y - 1; break;
+  }
+  int i = x + (y >> 3) * kPanelWidth;
+  uint8_t bit = 1 << (y & 7);
+  uint8_t& b = reinterpret_cast<uint8_t*>(_bits)[i];
+  switch (color) {
+    case SSD1306_WHITE: b |= bit; break;
+    case SSD1306_BLACK: b &= ~bit; break;
+    case SSD1306_INVERSE: b ^= bit; break;
+    default: return;
+  }
+  reinterpret_cast<uint8_t*>(_mask)[i] |= bit;
+  uint8_t page = y >> 3;
+  if (_col0 > _col1) {
+    _col0 = _col1 = x;
+    _page0 = _page1 = page;
+    return;
+  }
+  if (x < _col0) _col0 = x;
+  if (x > _col1) _col1 = x;
+  if (page < _page0) _page0 = page;
+  if (page > _page1) _page1 = page;
+}
+
+void Overlay::clear() {
+  memset(_bits, 0, sizeof(_bits));
+  memset(_mask, 0, sizeof(_mask));
+  _col0 = 1;
+  _col1 = 0;
+  _page0 = _page1 = 0;
+}
+
+void Compositor::setBackground(const uint8_t* frame) {
+  memcpy(_background, frame, kFrameBytes);
+  _hasBackground = true;
+}
+
+bool Compositor::addOverlay(Overlay& overlay) {
+  if (_overlayCount == kMaxOverlays) return false;
+  _overlays[_overlayCount++] = &overlay;
+  return true;
+}
+
+void Compositor::compose(const uint8_t* scene, uint8_t* out) const {
+  const uint32_t* in = reinterpret_cast<const uint32_t*>(scene);
+  uint32_t* words = reinterpret_cast<uint32_t*>(out);
+  if (_hasBackground) {
+    for (int i = 0; i < kFrameBytes / 4; i++) words[i] = in[i] | _background[i];
+  } else if (out != scene) {
+    memcpy(out, scene, kFrameBytes);
+  }
+
+  const int pageWords = kPanelWidth / 4;
+  for (int n = 0; n < _overlayCount; n++) {
+    const Overlay& o = *_overlays[n];
+    if (!o._visible || o._col0 > o._col1) continue;
+    int w0 = o._col0 / 4, w1 = o._col1 / 4;
+    for (int page = o._page0; page <= o._page1; page++) {
+      for (int w = page * pageWords + w0; w <= page * pageWords + w1; w++) {
+        words[w] = (words[w] & ~o._mask[w]) | o._bits[w];
+      }
+    }
+  }
+}
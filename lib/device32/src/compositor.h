@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+
+#include "panel.h"
+
+// Full-panel 1bpp layer with a coverage mask, drawn on top of the scene.
+// WHITE and BLACK pixels are both opaque, so a badge is a BLACK fillRect
+// with WHITE text on it; undrawn pixels let the scene through. Rotation is
+// handled like Adafruit_SSD1306, so an overlay can follow the scene's
+// setRotation(). Only the column span and pages touched since clear() are
+// merged.
+class Overlay : public Adafruit_GFX {
+ public:
+  Overlay();
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+
+  // Make every pixel transparent again.
+  void clear();
+
+  void setVisible(bool visible) { _visible = visible; }
+  bool visible() const { return _visible; }
+
+ private:
+  friend class Compositor;
+
+  uint32_t _bits[kFrameBytes / 4];
+  uint32_t _mask[kFrameBytes / 4];
+  uint8_t _col0, _col1, _page0, _page1;  // empty when _col0 > _col1
+  bool _visible = true;
+};
+
+// Builds each frame from layers: a static background captured once, the
+// scene the caller drew this frame, and overlays in the order they were
+// added. compose() merges them 32 bits at a time:
+//
+//   out = scene | background
+//   out = (out & ~overlay mask) | overlay bits   for each visible overlay
+//
+// Static chrome such as borders and label boxes is drawn once, through the
+// normal display calls, and captured with setBackground(). After that it
+// costs one OR per word per frame instead of being rasterised again.
+class Compositor {
+ public:
+  static constexpr int kMaxOverlays = 4;
+
+  // Copy frame (SSD1306 page layout) as the background layer.
+  void setBackground(const uint8_t* frame);
+  void clearBackground() { _hasBackground = false; }
+
+  // Overlays stay owned by the caller. Returns false when full.
+  bool addOverlay(Overlay& overlay);
+
+  // Merge the layers over scene into out; both are 4-byte aligned frames
+  // (e.g. Adafruit_SSD1306::getBuffer()) and out may be scene.
+  void compose(const uint8_t* scene, uint8_t* out) const;
+
+ private:
+  uint32_t _background[kFrameBytes / 4];
+  bool _hasBackground = false;
+  Overlay* _overlays[kMaxOverlays];
+  int _overlayCount = 0;
+};
@@ -0,0 +1,108 @@
+#include "coop_task.h"
+
+#include <Arduino.h>
+
+bool CoopTask::resume() {
+  if (_sleeping) {
+    if (!due(millis())) return true;
+    _sleeping = false;
+  }
+  return run();
+}
+
+void CoopTask::restart() {
+  _line = 0;
+  _sleeping = false;
+}
+
+void CoopTask::sleepFor(uint32_t ms) {
+  _wake = millis() + ms;
+  _sleeping = true;
+}
+
+bool PeriodicTask::run() {
+  _fn();
+  sleepFor(_period);
+  return true;
+}
+
+bool Scheduler::add(CoopTask& task) {
+  if (contains(task)) return true;
+  if (_count == kMaxTasks) return false;
+  _tasks[_count++] = &task;
+  return true;
+}
+
+void Scheduler::remove(CoopTask& task) {
+  for (int i = 0; i < _count; i++) {
+    if (_tasks[i] != &task) continue;
+    for (int j = i + 1; j < _count; j++) _tasks[j - 1] = _tasks[j];
+    _tasks[--_count] = nullptr;
+    return;
+  }
+}
+
+bool Scheduler::contains(const CoopTask& task) const {
+  for (int i = 0; i < _count; i++)
+    if (_tasks[i] == &task) return true;
+  return false;
+}
+
+void Scheduler::runOnce() {
+  uint32_t passStart = micros();
+  int i = 0;
+  while (i < _count) {
+    CoopTask* task = _tasks[i];
+    if (!task->due(millis())) {
+      i++;
+      continue;
+    }
+    uint32_t start = micros();
+    bool more = task->resume();
+    uint32_t slice = micros() - start;
+    if (slice > _worstSlice) {
+      _worstSlice = slice;
+      _worstTask = task->name();
+    }
+    // The task may have added or removed tasks; carry on after it.
+    int at = -1;
+    for (int j = 0; j < _count; j++)
+      if (_tasks[j] == task) at = j;
+    if (at < 0) continue;  // removed itself; i is already the next one
+    if (more) {
+      i = at + 1;
+    } else {
+      remove(*task);
+      i = at;
+    }
+  }
+  uint32_t pass = micros() - passStart;
+  if (pass > _worstPass) _worstPass = pass;
+  _passes++;
+}
+
+void Scheduler::idle(uint32_t maxMs) {
+  uint32_t now = millis();
+  uint32_t wait = maxMs;
+  for (int i = 0; i < _count; i++) {
+    if (_tasks[i]->due(now)) return;
+    uint32_t left = _tasks[i]->wakeMillis() - now;
+    if (left < wait) wait = left;
+  }
+  delay(wait);
+  _idle += wait;
+}
+
+void Scheduler::printStats(Print& out) const {
+  out.printf("tasks: %d running, %lu passes, longest slice %lu us (%s), longest pass %lu us, idle %lu ms\n",
+             _count, (unsigned long)_passes, (unsigned long)_worstSlice, _worstTask,
+             (unsigned long)_worstPass, (unsigned long)_idle);
+}
+
+void Scheduler::resetStats() {
+  _passes = 0;
+  _worstSlice = 0;
+  _worstTask = "";
+  _worstPass = 0;
+  _idle = 0;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <Print.h>
+#include <stdint.h>
+
+// Cooperative tasks for jobs that take longer than a frame: drawing a cave
+// over five seconds, waiting for WiFi, serving DNS and HTTP next to a
+// button. A task is a protothread. run() is entered from the top on every
+// resume and the TASK_ macros jump to where it last yielded, so a long job
+// reads as straight-line code but hands the loop back at each yield:
+//
+//   bool run() override {
+//     TASK_BEGIN();
+//     WiFi.begin(ssid, pass);
+//     while (WiFi.status() != WL_CONNECTED) {
+//       drawDots(_step++);
+//       TASK_SLEEP(500);
+//     }
+//     TASK_END();
+//   }
+//
+// Locals do not survive a yield; keep state in members. The macros are
+// cases of one switch, so the body cannot use a switch of its own across a
+// yield, and two of them cannot share a source line.
+class CoopTask {
+ public:
+  explicit CoopTask(const char* name) : _name(name) {}
+  virtual ~CoopTask() {}
+
+  // Run to the next yield unless asleep. Returns false once the body has
+  // reached TASK_END(); the next resume starts it over.
+  bool resume();
+  // Start over from the top on the next resume.
+  void restart();
+  // Cut a sleep short, e.g. when input changes what the task would draw;
+  // it is due on the next pass.
+  void wake() { _sleeping = false; }
+
+  // Not asleep, or its sleep is up, at millis() now.
+  bool due(uint32_t now) const { return !_sleeping || (int32_t)(now - _wake) >= 0; }
+  bool sleeping() const { return _sleeping; }
+  uint32_t wakeMillis() const { return _wake; }
+  const char* name() const { return _name; }
+
+ protected:
+  virtual bool run() = 0;
+  void sleepFor(uint32_t ms);
+
+  int _line = 0;  // where run() picks up, a __LINE__ of the last yield
+
+ private:
+  const char* _name;
+  bool _sleeping = false;
+  uint32_t _wake = 0;  // millis()
+};
+
+#define TASK_BEGIN() switch (_line) { case 0:
+// Give the loop back and carry on from here next pass.
+#define TASK_YIELD() do { _line = __LINE__; return true; case __LINE__:; } while (0)
+// Yield until cond holds; it is tested again on every resume. The task
+// counts as awake meanwhile, so the scheduler does not idle; wait on
+// something slow with TASK_SLEEP in a loop instead.
+#define TASK_WAIT_UNTIL(cond) do { _line = __LINE__; case __LINE__: if (!(cond)) return true; } while (0)
+// Yield and stay out of the scheduler's way for ms.
+#define TASK_SLEEP(ms) do { sleepFor(ms); _line = __LINE__; return true; case __LINE__:; } while (0)
+#define TASK_END() } _line = 0; return false
+
+// Calls fn every periodMs, for work that is one short call each time
+// (polling a button, answering DNS) and needs no protothread of its own.
+class PeriodicTask : public CoopTask {
+ public:
+  PeriodicTask(const char* name, void (*fn)(), uint32_t periodMs)
+    : CoopTask(name), _fn(fn), _period(periodMs) {}
+
+ protected:
+  bool run() override;
+
+ private:
+  void (*_fn)();
+  uint32_t _period;
+};
+
+// Round robin over up to kMaxTasks tasks in the order they were added.
+// loop() becomes
+//
+//   scheduler.runOnce();
+//   scheduler.idle(10);
+//
+// so nothing waits longer than one pass for its turn; how long a pass
+// takes is the longest slices of the tasks in it, which the stats report.
+class Scheduler {
+ public:
+  static constexpr int kMaxTasks = 8;
+
+  // Returns false when full. A task that is already in is left where it is.
+  bool add(CoopTask& task);
+  void remove(CoopTask& task);
+  bool contains(const CoopTask& task) const;
+
+  // Resume every task that is due, once. Finished tasks are removed.
+  void runOnce();
+  // Sleep with delay() until the next task wakes, at most maxMs; returns at
+  // once if a task is awake.
+  void idle(uint32_t maxMs);
+
+  uint32_t passes() const { return _passes; }
+  // Longest a single task held the loop between yields, and which one; the
+  // input latency every other task can see.
+  uint32_t worstSliceMicros() const { return _worstSlice; }
+  const char* worstSliceTask() const { return _worstTask; }
+  // Longest runOnce().
+  uint32_t worstPassMicros() const { return _worstPass; }
+  // Time spent in idle().
+  uint32_t idleMillis() const { return _idle; }
+
+  void printStats(Print& out) const;
+  void resetStats();
+
+ private:
+  CoopTask* _tasks[kMaxTasks] = {};
+  int _count = 0;
+  uint32_t _passes = 0;
+  uint32_t _worstSlice = 0;
+  const char* _worstTask = "";
+  uint32_t _worstPass = 0;
+  uint32_t _idle = 0;
+};
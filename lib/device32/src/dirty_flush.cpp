@@ -0,0 +1,68 @@
+#include "dirty_flush.h"
+
+#include <string.h>
+
+size_t DirtyFlush::flush(const uint8_t* frame) {
+  static const uint8_t kFirst[kPanelPages] = {0, 0, 0, 0, 0, 0, 0, 0};
+  static const uint8_t kLast[kPanelPages] = {127, 127, 127, 127, 127, 127, 127, 127};
+  return flush(frame, kFirst, kLast);
+}
+
+size_t DirtyFlush::flush(const uint8_t* frame, const uint8_t* firstCol, const uint8_t* lastCol) {
+  size_t sent = 0;
+
+  if (!_valid) {
+    _bus.writeWindow(0, kPanelWidth - 1, 0, kPanelPages - 1, frame, kFrameBytes);
+    memcpy(_shadow, frame, kFrameBytes);
+    for (int page = 0; page < kPanelPages; page++) {
+      _first[page] = 0;
+      _last[page] = kPanelWidth - 1;
+    }
+    _valid = true;
+    sent = kFrameBytes;
+  } else {
+    bool batching = false;
+    for (int page = 0; page < kPanelPages; page++) {
+      const uint8_t* row = frame + page * kPanelWidth;
+      uint8_t* shadow = _shadow + page * kPanelWidth;
+
+      int first = firstCol[page];
+      int last = lastCol[page];
+      while (first <= last && row[first] == shadow[first]) first++;
+      if (first > last) {
+        _first[page] = 1;
+        _last[page] = 0;
+        continue;
+      }
+      while (row[last] == shadow[last]) last--;
+
+      size_t len = last - first + 1;
+      if (!batching) {
+        _bus.beginBatch();
+        batching = true;
+      }
+      _bus.writeWindow(first, last, page, page, row + first, len);
+      memcpy(shadow + first, row + first, len);
+      _first[page] = first;
+      _last[page] = last;
+      sent += len;
+    }
+    if (batching) {
+      _bus.endBatch();
+    } else {
+      _skipped++;
+    }
+  }
+
+  _lastBytes = sent;
+  _totalBytes += sent;
+  _frames++;
+  return sent;
+}
+
+void DirtyFlush::printStats(Print& out) const {
+  out.printf("flush: %lu frames (%lu unchanged), last %u B, avg %lu B/frame, bus %lu B in %lu transactions\n",
+             (unsigned long)_frames, (unsigned long)_skipped, (unsigned)_lastBytes,
+             (unsigned long)(_frames ? _totalBytes / _frames : 0),
+             (unsigned long)_bus.bytesSent(), (unsigned long)_bus.transactions());
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Print.h>
+
+#include "panel.h"
+#include "ssd1306_bus.h"
+
+// Flushes only what changed since the last frame that went to the panel.
+// Each page is diffed against a shadow copy of the sent frame; the changed
+// column span of each page is sent through its own address window, so a
+// frame that moves a 4x4 snake cell costs a couple of dozen bytes instead
+// of the full 1 KB. A frame with nothing changed sends nothing at all,
+// not even an empty batch, and is counted as skipped.
+class DirtyFlush {
+ public:
+  explicit DirtyFlush(Ssd1306Bus& bus) : _bus(bus) {}
+
+  // Send the changed spans of frame (kFrameBytes, SSD1306 page layout).
+  // Returns the number of framebuffer bytes sent.
+  size_t flush(const uint8_t* frame);
+
+  // Same, but only looks inside first[page]..last[page] of each page (empty
+  // when first > last), for callers that track their own damage such as
+  // SpriteLayer. Everything outside those spans must match the last frame.
+  size_t flush(const uint8_t* frame, const uint8_t* first, const uint8_t* last);
+
+  // Forget what the panel shows; the next flush sends the whole frame.
+  void invalidate() { _valid = false; }
+
+  // Damage found by the last flush: column span per page, empty when
+  // firstCol > lastCol.
+  uint8_t firstCol(int page) const { return _first[page]; }
+  uint8_t lastCol(int page) const { return _last[page]; }
+
+  size_t lastFrameBytes() const { return _lastBytes; }
+  uint32_t frames() const { return _frames; }
+  // Frames that matched the panel and were not sent.
+  uint32_t skipped() const { return _skipped; }
+  uint32_t totalBytes() const { return _totalBytes; }
+
+  void printStats(Print& out) const;
+
+ private:
+  Ssd1306Bus& _bus;
+  uint8_t _shadow[kFrameBytes];
+  uint8_t _first[kPanelPages];
+  uint8_t _last[kPanelPages];
+  bool _valid = false;
+  size_t _lastBytes = 0;
+  uint32_t _frames = 0;
+  uint32_t _skipped = 0;
+  uint32_t _totalBytes = 0;
+};
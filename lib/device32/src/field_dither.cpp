@@ -0,0 +1,132 @@
+#include "field_dither.h"
+
+#include "bayer.h"
+
+// Threshold ranks. The Bayer matrices come from bayer.h; the blue-noise
+// tile was generated offline with Ulichney's void-and-cluster method
+// (sigma 1.9, wrapping at 16).
+static constexpr uint8_t kBlueNoise16[256] = {
+  203, 231, 121, 145, 174, 62, 136, 187, 157, 21, 130, 75, 12, 99, 17, 83,
+  160, 22, 1, 217, 87, 229, 11, 79, 50, 219, 240, 167, 204, 142, 53, 178,
+  93, 242, 68, 189, 44, 117, 165, 236, 101, 195, 30, 118, 45, 188, 253, 115,
+  42, 129, 169, 106, 247, 150, 19, 207, 125, 147, 63, 89, 214, 4, 70, 220,
+  151, 208, 80, 32, 197, 57, 73, 180, 40, 8, 176, 246, 154, 105, 138, 26,
+  61, 237, 13, 141, 221, 96, 133, 250, 109, 82, 225, 131, 35, 199, 233, 171,
+  112, 193, 51, 122, 162, 6, 230, 25, 213, 166, 192, 20, 55, 76, 92, 18,
+  222, 85, 175, 254, 39, 185, 90, 153, 48, 67, 98, 119, 161, 249, 183, 127,
+  158, 2, 102, 69, 205, 114, 58, 202, 139, 0, 241, 206, 144, 10, 211, 46,
+  245, 143, 232, 27, 148, 78, 239, 172, 124, 228, 86, 41, 177, 31, 104, 65,
+  186, 36, 198, 128, 215, 9, 23, 100, 33, 182, 156, 59, 113, 224, 134, 81,
+  15, 116, 60, 91, 164, 248, 135, 194, 74, 218, 14, 255, 72, 196, 235, 163,
+  209, 170, 226, 43, 107, 181, 54, 234, 47, 120, 103, 140, 173, 5, 49, 94,
+  251, 137, 7, 191, 71, 16, 152, 84, 168, 200, 28, 210, 88, 123, 149, 24,
+  108, 77, 155, 243, 212, 126, 111, 223, 3, 146, 244, 56, 38, 190, 216, 64,
+  34, 184, 52, 97, 29, 201, 37, 252, 95, 66, 179, 110, 227, 159, 238, 132
+};
+
+// Every matrix is expanded to a 16x16 tile of thresholds in field units,
+// so the packing loop is one compare per pixel whatever the matrix.
+static const int kTile = 16;
+
+static int rank(DitherMatrix matrix, int x, int y, int* levels) {
+  switch (matrix) {
+    case DitherMatrix::kBayer4: *levels = 16; return kBayer4[(y & 3) * 4 + (x & 3)];
+    case DitherMatrix::kBlueNoise: *levels = 256; return kBlueNoise16[y * kTile + x];
+    default: *levels = 64; return kBayer8[(y & 7) * 8 + (x & 7)];
+  }
+}
+
+static void thresholds(float* thr, DitherMatrix matrix, float lo, float hi) {
+  for (int y = 0; y < kTile; y++) {
+    for (int x = 0; x < kTile; x++) {
+      int levels;
+      int r = rank(matrix, x, y, &levels);
+      thr[y * kTile + x] = lo + (hi - lo) * (r + 0.5f) / levels;
+    }
+  }
+}
+
+static void thresholds(uint16_t* thr, DitherMatrix matrix, uint16_t lo, uint16_t hi) {
+  if (hi < lo) hi = lo;
+  for (int y = 0; y < kTile; y++) {
+    for (int x = 0; x < kTile; x++) {
+      int levels;
+      int r = rank(matrix, x, y, &levels);
+      thr[y * kTile + x] = lo + (uint32_t)(hi - lo) * (2 * r + 1) / (2 * levels);
+    }
+  }
+}
+
+// Walk the area a page at a time: each of the page's 8 rows is compared in
+// runs of 16 against one row of the threshold tile and ORed into a column
+// accumulator as a single bit plane, then every byte is stored once. Rows
+// are read in order and the 16-wide inner loop has no index wrap, so the
+// compiler can unroll or vectorise it. row(y) returns w samples for row y.
+template <typename T, typename Row>
+static void pack(uint8_t* frame, int w, int h, const T* thr, bool merge, Row row) {
+  if (w > kPanelWidth) w = kPanelWidth;
+  if (h > kPanelHeight) h = kPanelHeight;
+  for (int page = 0; page * 8 < h; page++) {
+    int y0 = page * 8;
+    int rows = h - y0 < 8 ? h - y0 : 8;
+    uint8_t acc[kPanelWidth] = {};
+    for (int j = 0; j < rows; j++) {
+      const T* v = row(y0 + j);
+      const T* t = thr + ((y0 + j) & (kTile - 1)) * kTile;
+      int x = 0;
+      for (; x + kTile <= w; x += kTile) {
+        for (int i = 0; i < kTile; i++) acc[x + i] |= (v[x + i] > t[i]) << j;
+      }
+      for (int i = 0; x + i < w; i++) acc[x + i] |= (v[x + i] > t[i]) << j;
+    }
+    uint8_t mask = rows == 8 ? 0xFF : (1 << rows) - 1;
+    uint8_t keep = merge ? 0xFF : ~mask;
+    uint8_t* dst = frame + page * kPanelWidth;
+    for (int x = 0; x < w; x++) dst[x] = (dst[x] & keep) | acc[x];
+  }
+}
+
+// Non-negative IEEE floats order the same as their bit patterns read as
+// signed integers, and negative ones read as negative integers. With all
+// thresholds >= 0 the float field can therefore be compared as int32,
+// which avoids a soft-float call per pixel on FPU-less parts (ESP32-C3).
+typedef int32_t __attribute__((may_alias)) FloatBits;
+
+void ditherField(uint8_t* frame, const float* field, int w, int h, float lo, float hi,
+                 DitherMatrix matrix, bool merge) {
+  float thr[kTile * kTile];
+  thresholds(thr, matrix, lo, hi);
+  if (lo >= 0.0f && hi >= 0.0f) {
+    const FloatBits* bits = reinterpret_cast<const FloatBits*>(field);
+    pack(frame, w, h, reinterpret_cast<const FloatBits*>(thr), merge,
+         [=](int y) { return bits + y * w; });
+  } else {
+    pack(frame, w, h, thr, merge, [=](int y) { return field + y * w; });
+  }
+}
+
+void ditherField(uint8_t* frame, const uint16_t* field, int w, int h, uint16_t lo, uint16_t hi,
+                 DitherMatrix matrix, bool merge) {
+  uint16_t thr[kTile * kTile];
+  thresholds(thr, matrix, lo, hi);
+  pack(frame, w, h, thr, merge, [=](int y) { return field + y * w; });
+}
+
+void ditherCells(uint8_t* frame, const float* cells, int cw, int ch, float lo, float hi,
+                 DitherMatrix matrix, bool merge) {
+  float thr[kTile * kTile];
+  thresholds(thr, matrix, lo, hi);
+  // Expand each grid row to panel width once; a cell row covers several
+  // panel rows.
+  float line[kPanelWidth];
+  int last = -1;
+  pack(frame, kPanelWidth, kPanelHeight, thr, merge, [&](int y) -> const float* {
+    int cy = y * ch / kPanelHeight;
+    if (cy != last) {
+      const float* src = cells + cy * cw;
+      for (int x = 0; x < kPanelWidth; x++) line[x] = src[x * cw / kPanelWidth];
+      last = cy;
+    }
+    return line;
+  });
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "panel.h"
+
+// Threshold matrix for the dither functions below. The Bayer matrices tile
+// every 4 or 8 pixels and keep a visible cross-hatch; blue noise is a
+// 16x16 void-and-cluster tile that reads as even grain.
+enum class DitherMatrix : uint8_t { kBayer4, kBayer8, kBlueNoise };
+
+// Ordered-dither a row-major scalar field straight into an SSD1306 page
+// buffer, building each page byte from 8 samples and storing it once.
+// Pixel (x, y) of the top-left w x h area lights when its value passes
+// lo + (hi - lo) * threshold(x, y): lo and below stays dark, hi and above is
+// solid, and values between come out as a proportion of lit pixels.
+// Without merge the area is overwritten; with merge lit pixels are ORed
+// over what the frame already holds.
+void ditherField(uint8_t* frame, const float* field, int w, int h, float lo, float hi,
+                 DitherMatrix matrix = DitherMatrix::kBayer8, bool merge = false);
+
+// Fixed-point field (any unsigned 16-bit scale, e.g. Q8.8).
+void ditherField(uint8_t* frame, const uint16_t* field, int w, int h, uint16_t lo, uint16_t hi,
+                 DitherMatrix matrix = DitherMatrix::kBayer8, bool merge = false);
+
+// Coarse cw x ch grid stretched over the whole panel, each pixel taking the
+// value of the cell it falls in (e.g. a 12x24 temperature grid).
+void ditherCells(uint8_t* frame, const float* cells, int cw, int ch, float lo, float hi,
+                 DitherMatrix matrix = DitherMatrix::kBayer4, bool merge = false);
@@ -0,0 +1,68 @@
+#include "frame_clock.h"
+
+#include <Arduino.h>
+
+void FrameClock::restart() {
+  _next = micros();
+  _wake = _next;
+  _started = true;
+}
+
+void FrameClock::setStep(uint32_t stepMicros) {
+  _step = stepMicros;
+  restart();
+}
+
+int FrameClock::steps() {
+  uint32_t now = micros();
+  if (!_started) {
+    _next = now;
+    _started = true;
+  }
+  _wake = now;
+  int32_t behind = (int32_t)(now - _next);
+  if (behind < 0) return 0;
+
+  uint32_t due = (uint32_t)behind / _step + 1;
+  uint32_t run = due < _maxSteps ? due : _maxSteps;
+  _next += due * _step;
+  _dropped += due - run;
+  _skipped += run - 1;
+  _frames++;
+  return (int)run;
+}
+
+float FrameClock::alpha() const {
+  float a = (float)(micros() - (_next - _step)) / _step;
+  return a < 0.0f ? 0.0f : (a > 1.0f ? 1.0f : a);
+}
+
+void FrameClock::sleep() {
+  uint32_t now = micros();
+  if (now - _wake > _peakBusy) _peakBusy = now - _wake;
+  int32_t left = (int32_t)(_next - now);
+  if (left <= 0) {
+    _missed++;
+    if ((uint32_t)-left > _worstLate) _worstLate = -left;
+    return;
+  }
+  if (left > 2000) delay((left - 1000) / 1000);
+  while ((int32_t)(_next - micros()) > 0) {
+  }
+}
+
+void FrameClock::printStats(Print& out) const {
+  out.printf("clock: %lu frames of %lu us, %lu missed (worst %lu us late), %lu steps skipped, %lu dropped, peak busy %lu us\n",
+             (unsigned long)_frames, (unsigned long)_step, (unsigned long)_missed,
+             (unsigned long)_worstLate, (unsigned long)_skipped, (unsigned long)_dropped,
+             (unsigned long)_peakBusy);
+}
+
+void FrameClock::resetStats() {
+  _frames = 0;
+  _missed = 0;
+  _skipped = 0;
+  _dropped = 0;
+  _peakBusy = 0;
+  _worstLate = 0;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Print.h>
+#include <stdint.h>
+
+// Fixed-timestep clock for a scene's main loop. The simulation advances in
+// steps of a fixed length of wall time, so it runs at the same speed
+// however long drawing and flushing take:
+//
+//   void loop() {
+//     for (int n = frameClock.steps(); n > 0; n--) update();
+//     draw();
+//     frameClock.sleep();
+//   }
+//
+// When a frame overruns its step, the next loop runs the steps it missed
+// before drawing once, skipping the frames in between; past maxSteps the
+// backlog is dropped and the simulation slows down instead of spiralling.
+// sleep() replaces a fixed delay(): it waits out what is left of the step,
+// so the loop period no longer depends on how long the frame took.
+class FrameClock {
+ public:
+  explicit FrameClock(uint32_t stepMicros, uint8_t maxSteps = 4)
+    : _step(stepMicros), _maxSteps(maxSteps) {}
+
+  // Start counting from now, e.g. after a blocking pause such as a game
+  // over screen, so the pause is not caught up afterwards.
+  void restart();
+  void setStep(uint32_t stepMicros);
+  uint32_t step() const { return _step; }
+
+  // Simulation steps due since the last call, at most maxSteps; 0 if the
+  // loop came round before the next step was due.
+  int steps();
+
+  // micros() when the next step is due. Work slipped in after the frame
+  // and before sleep() should be done by then.
+  uint32_t nextMicros() const { return _next; }
+
+  // How far the clock is into the next step, 0 to 1, for drawing moving
+  // things between their last position and the next one.
+  float alpha() const;
+
+  // Sleep until the next step is due: the bulk with delay(), the last
+  // millisecond spinning on micros(). A deadline that has already passed
+  // counts as missed.
+  void sleep();
+
+  uint32_t frames() const { return _frames; }
+  // Frames that were not done when the next step came due.
+  uint32_t missed() const { return _missed; }
+  // Steps run without drawing, to catch up.
+  uint32_t skipped() const { return _skipped; }
+  // Steps thrown away past maxSteps.
+  uint32_t dropped() const { return _dropped; }
+  // Most time a frame spent between steps() and sleep(), and the latest a
+  // deadline was missed by; size a scene so the first stays under step().
+  uint32_t peakBusyMicros() const { return _peakBusy; }
+  uint32_t worstLateMicros() const { return _worstLate; }
+
+  void printStats(Print& out) const;
+  void resetStats();
+
+ private:
+  uint32_t _step;
+  uint8_t _maxSteps;
+  bool _started = false;
+  uint32_t _next = 0;  // micros() when the next step is due
+  uint32_t _wake = 0;
+  uint32_t _frames = 0;
+  uint32_t _missed = 0;
+  uint32_t _skipped = 0;
+  uint32_t _dropped = 0;
+  uint32_t _peakBusy = 0;
+  uint32_t _worstLate = 0;
+};
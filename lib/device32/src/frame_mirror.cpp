@@ -0,0 +1,105 @@
+#include "frame_mirror.h"
+
+#include <string.h>
+
+#include "anim_stream.h"
+
+static const uint8_t kMagic[4] = {'D', '3', '2', 'M'};
+
+static void put16(uint8_t* p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+static uint16_t get16(const uint8_t* p) { return p[0] | p[1] << 8; }
+
+// Sums stay inside 32 bits for a whole packet, so reduce once at the end.
+static uint16_t fletcher16(const uint8_t* p, size_t len) {
+  uint32_t a = 0, b = 0;
+  while (len--) {
+    a += *p++;
+    b += a;
+  }
+  return (uint16_t)((b % 255) << 8 | a % 255);
+}
+
+size_t MirrorEncoder::encode(const uint8_t* frame, uint16_t elapsedMs, uint8_t* out) {
+  static const uint8_t kBlack[kFrameBytes] = {};
+  _key = !_valid || _sinceKey >= _every;
+  size_t len = animEncodeDelta(_key ? kBlack : _sent, frame, out + kMirrorHeaderBytes);
+  memcpy(out, kMagic, 4);
+  out[4] = _key ? 'K' : 'D';
+  out[5] = _seq;
+  put16(out + 6, elapsedMs);
+  put16(out + 8, len);
+  put16(out + kMirrorHeaderBytes + len, fletcher16(out + 4, kMirrorHeaderBytes - 4 + len));
+  return kMirrorHeaderBytes + len + 2;
+}
+
+void MirrorEncoder::commit(const uint8_t* frame) {
+  memcpy(_sent, frame, kFrameBytes);
+  _valid = true;
+  _seq++;
+  _sinceKey = _key ? 1 : _sinceKey + 1;
+}
+
+MirrorDecoder::MirrorDecoder() { memset(_frame, 0, kFrameBytes); }
+
+bool MirrorDecoder::push(uint8_t b) {
+  if (_have < 4) {
+    // Hunt for the magic; a mismatch may itself start the next one.
+    if (b == kMagic[_have]) {
+      _packet[_have++] = b;
+    } else {
+      _have = b == kMagic[0];
+    }
+    return false;
+  }
+
+  _packet[_have++] = b;
+  if (_have == kMirrorHeaderBytes) {
+    size_t len = get16(_packet + 8);
+    if (len > kMirrorMaxPayload || (_packet[4] != 'K' && _packet[4] != 'D')) {
+      _corrupt++;
+      _have = 0;
+      return false;
+    }
+    _need = kMirrorHeaderBytes + len + 2;
+  }
+  if (_have < _need) return false;
+
+  bool updated = finish();
+  _have = 0;
+  _need = kMirrorHeaderBytes;
+  return updated;
+}
+
+bool MirrorDecoder::finish() {
+  size_t len = _need - kMirrorHeaderBytes - 2;
+  const uint8_t* payload = _packet + kMirrorHeaderBytes;
+  if (fletcher16(_packet + 4, kMirrorHeaderBytes - 4 + len) != get16(payload + len)) {
+    _corrupt++;
+    return false;
+  }
+
+  bool key = _packet[4] == 'K';
+  uint8_t seq = _packet[5];
+  if (!key && (!_synced || seq != (uint8_t)(_seq + 1))) {
+    _synced = false;
+    _unsynced++;
+    return false;
+  }
+  if (key) memset(_frame, 0, kFrameBytes);
+  if (animApplyDelta(payload, payload + len, _frame) != payload + len) {
+    _synced = false;
+    _corrupt++;
+    return false;
+  }
+
+  _synced = true;
+  _key = key;
+  _seq = seq;
+  _elapsedMs = get16(_packet + 6);
+  _frames++;
+  return true;
+}
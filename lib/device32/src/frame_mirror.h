@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "panel.h"
+
+// Packets for mirroring presented frames over a slow byte link (the serial
+// console). The payload is the anim_stream.h token format: the XOR of the
+// frame with the last one sent, run-length coded. A keyframe is coded
+// against black, so a viewer that attaches late, or loses a packet, picks
+// the picture up again at the next one. Little-endian:
+//
+//   0  "D32M"
+//   4  'K' keyframe or 'D' delta     5  sequence number, u8
+//   6  ms since the previous packet, u16 (saturates)
+//   8  payload length, u16           10 payload
+//   10 + length  Fletcher-16 of bytes 4 .. 10 + length
+//
+// The magic and checksum let the decoder find packets between ordinary
+// console output.
+constexpr size_t kMirrorHeaderBytes = 10;
+constexpr size_t kMirrorMaxPayload = kFrameBytes + kFrameBytes / 64;
+constexpr size_t kMirrorMaxPacket = kMirrorHeaderBytes + kMirrorMaxPayload + 2;
+
+class MirrorEncoder {
+ public:
+  // A keyframe goes out first and then every keyframeEvery packets (0 or
+  // 1: only keyframes).
+  explicit MirrorEncoder(uint16_t keyframeEvery = 60) : _every(keyframeEvery) {}
+
+  // Code frame as the next packet into out (kMirrorMaxPacket bytes) and
+  // return its length. Nothing changes until commit(), so a packet the
+  // link has no room for can be dropped and the next frame is coded
+  // against the last one that went out.
+  size_t encode(const uint8_t* frame, uint16_t elapsedMs, uint8_t* out);
+
+  // The packet from the last encode() of frame was sent.
+  void commit(const uint8_t* frame);
+
+  void forceKeyframe() { _valid = false; }
+
+ private:
+  uint8_t _sent[kFrameBytes];
+  bool _valid = false;
+  bool _key = false;  // last encode() made a keyframe
+  uint16_t _every;
+  uint16_t _sinceKey = 0;
+  uint8_t _seq = 0;
+};
+
+// Byte-at-a-time parser for the other end. Anything that is not a whole,
+// well-formed packet is skipped; deltas that do not follow the frame on
+// hand are ignored until the next keyframe.
+class MirrorDecoder {
+ public:
+  MirrorDecoder();
+
+  // Returns true when b completes a packet that updated frame().
+  bool push(uint8_t b);
+
+  const uint8_t* frame() const { return _frame; }
+  // Time since the previous packet, as stamped by the encoder.
+  uint16_t elapsedMs() const { return _elapsedMs; }
+  bool keyframe() const { return _key; }
+
+  uint32_t frames() const { return _frames; }
+  // Packets with a bad checksum or payload.
+  uint32_t corrupt() const { return _corrupt; }
+  // Good deltas dropped for want of the frame they apply to.
+  uint32_t unsynced() const { return _unsynced; }
+
+ private:
+  bool finish();
+
+  uint8_t _packet[kMirrorMaxPacket];
+  size_t _have = 0;
+  size_t _need = kMirrorHeaderBytes;
+  uint8_t _frame[kFrameBytes];
+  bool _synced = false;
+  bool _key = false;
+  uint8_t _seq = 0;
+  uint16_t _elapsedMs = 0;
+  uint32_t _frames = 0;
+  uint32_t _corrupt = 0;
+  uint32_t _unsynced = 0;
+};
@@ -0,0 +1,136 @@
+#include "glyph_blit.h"
+
+#include <string.h>
+
+// static const unsigned char font[]: five column bytes per character.
+#include <glcdfont.c>
+
+namespace {
+
+// Records the glyph Adafruit_GFX::drawChar() draws into a 6x8 cell.
+class GlyphCapture : public Adafruit_GFX {
+ public:
+  GlyphCapture() : Adafruit_GFX(6, 8) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t) override {
+    if (x >= 0 && x < 5 && y >= 0 && y < 8) {
+      columns[x] |= 1 << y;
+      rows[y] |= 1 << x;
+    }
+  }
+
+  uint8_t columns[5];
+  uint8_t rows[8];
+};
+
+}  // namespace
+
+const uint8_t* GlyphFont::columns(uint8_t c) {
+  return font + c * 5;
+}
+
+void GlyphFont::rows(uint8_t c, uint8_t rows[8]) {
+  const uint8_t* cols = columns(c);
+  for (int r = 0; r < 8; r++) {
+    rows[r] = (uint8_t)(((cols[0] >> r) & 1) | ((cols[1] >> r) & 1) << 1 |
+                        ((cols[2] >> r) & 1) << 2 | ((cols[3] >> r) & 1) << 3 |
+                        ((cols[4] >> r) & 1) << 4);
+  }
+}
+
+void GlyphFont::capture(uint8_t c, uint8_t columns[5], uint8_t rows[8]) {
+  GlyphCapture capture;
+  memset(capture.columns, 0, sizeof(capture.columns));
+  memset(capture.rows, 0, sizeof(capture.rows));
+  capture.drawChar(0, 0, c, 1, 1, 1);
+  memcpy(columns, capture.columns, 5);
+  memcpy(rows, capture.rows, 8);
+}
+
+// Doubles every bit of a byte: bit n -> bits 2n and 2n + 1.
+static const uint8_t kDouble[16] = {
+  0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F,
+  0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF,
+};
+
+static inline uint32_t scaleBits(uint8_t bits, uint8_t size) {
+  if (size == 1) return bits;
+  return kDouble[bits & 0x0F] | (uint32_t)kDouble[bits >> 4] << 8;
+}
+
+static inline void apply(uint8_t* p, uint8_t mask, uint16_t color) {
+  switch (color) {
+    case SSD1306_WHITE: *p |= mask; break;
+    case SSD1306_BLACK: *p &= ~mask; break;
+    case SSD1306_INVERSE: *p ^= mask; break;
+  }
+}
+
+// Write bits (bit n = panel row row0 + n) into panel column col. cell marks
+// the rows the glyph covers, for the background.
+static void writeColumn(uint8_t* frame, int col, int row0, uint32_t bits, uint32_t cell,
+                        uint16_t color, uint16_t bg, bool opaque) {
+  if (col < 0 || col >= kPanelWidth) return;
+  int page = row0 >> 3;
+  int shift = row0 & 7;
+  bits <<= shift;
+  cell <<= shift;
+  for (; cell && page < kPanelPages; page++, bits >>= 8, cell >>= 8) {
+    if (page < 0) continue;
+    uint8_t* p = frame + col + page * kPanelWidth;
+    if (opaque) apply(p, (uint8_t)(cell & ~bits), bg);
+    if (bits & 0xFF) apply(p, (uint8_t)bits, color);
+  }
+}
+
+bool blitGlyph(uint8_t* frame, uint8_t rotation, int16_t x, int16_t y, uint8_t c,
+               uint8_t size, uint16_t color, uint16_t bg) {
+  if ((rotation != 0 && rotation != 1) || (size != 1 && size != 2) || !GlyphFont::has(c)) {
+    return false;
+  }
+  bool opaque = bg != color;
+
+  if (rotation == 0) {
+    // Glyph columns are panel columns; the sixth is spacing.
+    uint32_t cell = size == 1 ? 0xFF : 0xFFFF;
+    const uint8_t* cols = GlyphFont::columns(c);
+    for (int i = 0; i < 6; i++) {
+      uint32_t bits = i < 5 ? scaleBits(cols[i], size) : 0;
+      if (!bits && !opaque) continue;
+      for (int k = 0; k < size; k++) {
+        writeColumn(frame, x + i * size + k, y, bits, cell, color, bg, opaque);
+      }
+    }
+  } else {
+    // Rotation 1: logical row r is panel column 127 - r and logical column
+    // n is panel row n, so each glyph row is one column write.
+    uint32_t cell = size == 1 ? 0x3F : 0xFFF;
+    uint8_t rows[8];
+    GlyphFont::rows(c, rows);
+    for (int r = 0; r < 8; r++) {
+      uint32_t bits = scaleBits(rows[r], size);
+      if (!bits && !opaque) continue;
+      for (int k = 0; k < size; k++) {
+        writeColumn(frame, kPanelWidth - 1 - (y + r * size + k), x, bits, cell, color, bg, opaque);
+      }
+    }
+  }
+  return true;
+}
+
+size_t GlyphDisplay::write(uint8_t c) {
+  // Newlines, custom fonts and anything outside the tables take the stock
+  // path, which handles the cursor the same way.
+  if (gfxFont || textsize_x != textsize_y || !GlyphFont::has(c)) {
+    return Adafruit_SSD1306::write(c);
+  }
+  if (wrap && ((cursor_x + textsize_x * 6) > _width)) {
+    cursor_x = 0;
+    cursor_y += textsize_y * 8;
+  }
+  if (!blitGlyph(getBuffer(), rotation, cursor_x, cursor_y, c, textsize_x, textcolor, textbgcolor)) {
+    drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x, textsize_y);
+  }
+  cursor_x += textsize_x * 6;
+  return 1;
+}
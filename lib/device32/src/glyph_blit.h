@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+
+#include "panel.h"
+
+// Column-native text for the built-in 5x7 GFX font. Each glyph column is
+// already an SSD1306 page byte, so a glyph becomes 6 column ORs (12 at
+// text size 2) instead of a drawPixel or fillRect per font pixel. Rows that
+// do not start on a page boundary are shifted across two pages (three at
+// size 2). Portrait scenes (rotation 1) turn each glyph into eight row
+// bytes as it is drawn; each row lands on a panel column.
+//
+// Glyphs cover printable ASCII and are read from the GFX library's own
+// font table (glcdfont.c, in flash), the bytes drawChar() draws, so they
+// always match the library's font.
+class GlyphFont {
+ public:
+  static constexpr uint8_t kFirst = 0x20;
+  static constexpr uint8_t kLast = 0x7E;
+
+  static bool has(uint8_t c) { return c >= kFirst && c <= kLast; }
+  // Five column bytes, bit n = glyph row n.
+  static const uint8_t* columns(uint8_t c);
+  // Eight row bytes, bit n = glyph column n.
+  static void rows(uint8_t c, uint8_t rows[8]);
+
+  // Capture any character straight from drawChar(), for callers that
+  // need glyphs outside printable ASCII.
+  static void capture(uint8_t c, uint8_t columns[5], uint8_t rows[8]);
+};
+
+// Draw one glyph into a 128x64 page buffer the way Adafruit_GFX::drawChar()
+// would with the given rotation. Handles rotation 0 and 1, sizes 1 and 2,
+// and printable ASCII; returns false without drawing anything otherwise so
+// the caller can fall back to drawChar(). bg == color draws no background.
+bool blitGlyph(uint8_t* frame, uint8_t rotation, int16_t x, int16_t y, uint8_t c,
+               uint8_t size, uint16_t color, uint16_t bg);
+
+// Adafruit_SSD1306 whose print()/println() use blitGlyph() for the built-in
+// font and fall back to the stock path for custom fonts, other sizes and
+// rotations. A drop-in for the display object.
+class GlyphDisplay : public Adafruit_SSD1306 {
+ public:
+  using Adafruit_SSD1306::Adafruit_SSD1306;
+
+  size_t write(uint8_t c) override;
+  using Print::write;
+};
@@ -0,0 +1,264 @@
+#include "grey_panel.h"
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bayer.h"
+
+// A depth is dropped after this many one-second windows below 90% of the
+// slot rate it needs.
+static const uint8_t kShortWindowLimit = 2;
+
+bool GreyPanel::allocate() {
+  _back = (uint8_t*)calloc(4 * _bits, kFrameBytes);
+  if (_back == nullptr) return false;
+  _spare = _back + _bits * kFrameBytes;
+  _front = _spare + _bits * kFrameBytes;
+  _shown = _front + _bits * kFrameBytes;
+  return true;
+}
+
+GreyPanel::GreyPanel(DirtyFlush& flusher, uint8_t bits, uint8_t cycleHz)
+  : Adafruit_GFX(kPanelWidth, kPanelHeight), _flusher(flusher),
+    _bits(bits < 1 ? 1 : bits > kMaxBits ? (uint8_t)kMaxBits : bits),
+    _cycleHz(cycleHz ? cycleHz : 1), _active(_bits) {}
+
+void GreyPanel::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (_back == nullptr || x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
+  if (color > maxLevel()) color = maxLevel();
+  int i = x + (y >> 3) * kPanelWidth;
+  uint8_t bit = 1 << (y & 7);
+  for (int k = 0; k < _bits; k++) {
+    uint8_t& b = backPlane(k)[i];
+    b = (color >> k) & 1 ? (b | bit) : (b & ~bit);
+  }
+}
+
+void GreyPanel::fillScreen(uint16_t color) {
+  if (_back == nullptr) return;
+  if (color > maxLevel()) color = maxLevel();
+  for (int k = 0; k < _bits; k++) {
+    memset(backPlane(k), (color >> k) & 1 ? 0xFF : 0x00, kFrameBytes);
+  }
+}
+
+// Fill dst with the top `bits` planes of the back buffer, or with a 4x4
+// Bayer dither of the full levels when only one plane is shown.
+void GreyPanel::compose(uint8_t* dst, uint8_t bits) {
+  if (bits > 1) {
+    memcpy(dst, backPlane(_bits - bits), bits * kFrameBytes);
+    return;
+  }
+  int max = maxLevel();
+  for (int i = 0; i < kFrameBytes; i++) {
+    const uint8_t* threshold = kBayer4 + (i & 3);
+    uint8_t out = 0;
+    for (int j = 0; j < 8; j++) {
+      int level = 0;
+      for (int k = 0; k < _bits; k++) level |= ((_back[k * kFrameBytes + i] >> j) & 1) << k;
+      // lit when level / max beats the cell's threshold (n + 0.5) / 16
+      if (level * 16 > threshold[(j & 3) * 4] * max + max / 2) out |= 1 << j;
+    }
+    dst[i] = out;
+  }
+}
+
+// One full greyscale cycle: plane k is sent once and held for 2^k slots.
+void GreyPanel::runCycle() {
+#if defined(ESP32)
+  xSemaphoreTake(_lock, portMAX_DELAY);
+#else
+  _lock.lock();
+#endif
+  if (_fresh) {
+    uint8_t* planes = _shown;
+    _shown = _front;
+    _front = planes;
+    _shownBits = _frontBits;
+    _fresh = false;
+  }
+#if defined(ESP32)
+  xSemaphoreGive(_lock);
+#else
+  _lock.unlock();
+#endif
+
+  uint32_t slots = (1 << _shownBits) - 1;
+  uint32_t slotMicros = 1000000UL / (_cycleHz * slots);
+  _requiredHz = _cycleHz * slots;
+  for (int k = _shownBits - 1; k >= 0; k--) {
+    uint32_t start = micros();
+    _flusher.flush(_shown + k * kFrameBytes);
+    _windowSendMicros += micros() - start;
+    _windowSends++;
+    for (int r = 0; r < (1 << k); r++) {
+      _deadline += slotMicros;
+      waitUntil(_deadline);
+      _windowSlots++;
+      measure(micros());
+    }
+  }
+}
+
+// A slot whose plane is still being sent when it should end is a miss; the
+// schedule restarts from now instead of trying to catch up.
+void GreyPanel::waitUntil(uint32_t deadline) {
+  int32_t left = (int32_t)(deadline - micros());
+  if (left < 0) {
+    _missed++;
+    _deadline = micros();
+    return;
+  }
+#if defined(ESP32)
+  // The one-shot keeps slot lengths even below the 1 kHz tick without
+  // holding the CPU; without it, sleep whole ticks, rounded up.
+  if (_slotTimer && esp_timer_start_once(_slotTimer, left) == ESP_OK) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  } else {
+    vTaskDelay((left + 999) / 1000 / portTICK_PERIOD_MS);
+  }
+#else
+  std::this_thread::sleep_for(std::chrono::microseconds(left));
+#endif
+}
+
+void GreyPanel::measure(uint32_t now) {
+  uint32_t elapsed = now - _windowStart;
+  if (elapsed < 1000000UL) return;
+  _achievedHz = (uint64_t)_windowSlots * 1000000UL / elapsed;
+  bool keepingUp = _achievedHz * 10 >= _requiredHz * 9;
+  if (_sinceRaise != 0xFFFF) _sinceRaise++;
+  // Only judge a depth once the task is showing it.
+  if (_active == _shownBits) {
+    if (_active > 1 && !keepingUp) {
+      _goodWindows = 0;
+      if (++_shortWindows >= kShortWindowLimit) {
+        _active = _active - 1;
+        _shortWindows = 0;
+        _drops++;
+        // The depth just raised to did not hold: wait longer before trying
+        // it again.
+        if (_sinceRaise < 2 * _raiseWait && _raiseWait < kMaxRaiseWindows) _raiseWait *= 2;
+        _sinceRaise = 0xFFFF;
+      }
+    } else {
+      _shortWindows = 0;
+      // One more plane fits when a send takes under 80% of the shortest
+      // slot the next depth would have.
+      uint32_t nextSlot = 1000000UL / (_cycleHz * ((2UL << _active) - 1));
+      uint32_t send = _windowSends ? _windowSendMicros / _windowSends : 0;
+      if (_active < _bits && keepingUp && send * 5 < nextSlot * 4) {
+        if (++_goodWindows >= _raiseWait) {
+          _active = _active + 1;
+          _goodWindows = 0;
+          _sinceRaise = 0;
+          _raises++;
+        }
+      } else {
+        _goodWindows = 0;
+      }
+    }
+  }
+  _windowStart = now;
+  _windowSlots = 0;
+  _windowSendMicros = 0;
+  _windowSends = 0;
+}
+
+void GreyPanel::printStats(Print& out) const {
+  out.printf("grey: %u-bit of %u, %u/%u slots/s, %lu missed, %lu drops, %lu raises\n",
+             (unsigned)_active, (unsigned)_bits, (unsigned)_achievedHz,
+             (unsigned)_requiredHz, (unsigned long)_missed,
+             (unsigned long)_drops, (unsigned long)_raises);
+}
+
+#if defined(ESP32)
+
+void GreyPanel::taskEntry(void* arg) {
+  static_cast<GreyPanel*>(arg)->run();
+}
+
+void GreyPanel::onSlotTimer(void* arg) {
+  xTaskNotifyGive(static_cast<GreyPanel*>(arg)->_task);
+}
+
+void GreyPanel::run() {
+  _deadline = _windowStart = micros();
+  for (;;) runCycle();
+}
+
+bool GreyPanel::begin() {
+  if (!allocate()) return false;
+  _lock = xSemaphoreCreateMutex();
+  // Created before the task, which preempts loop() as soon as it exists.
+  esp_timer_create_args_t args = {};
+  args.callback = onSlotTimer;
+  args.arg = this;
+  args.name = "grey slot";
+  if (esp_timer_create(&args, &_slotTimer) != ESP_OK) _slotTimer = nullptr;
+  // One priority above loop() like AsyncFlush; the task sleeps in the I2C
+  // driver and on the slot timer, so it only holds the CPU to send.
+  _started = _lock != nullptr &&
+             xTaskCreate(taskEntry, "grey", 3072, this, 2, &_task) == pdPASS;
+  if (!_started) _active = 1;
+  return true;
+}
+
+// Compose outside the lock, which only covers the pointer swap, so the
+// task never waits on a copy or a dither to start its next cycle.
+void GreyPanel::commit() {
+  if (_back == nullptr) return;
+  if (!_started) {
+    compose(_front, 1);
+    _flusher.flush(_front);
+    return;
+  }
+  uint8_t bits = _active;
+  compose(_spare, bits);
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  uint8_t* planes = _front;
+  _front = _spare;
+  _spare = planes;
+  _frontBits = bits;
+  _fresh = true;
+  xSemaphoreGive(_lock);
+}
+
+#else
+
+// Host builds run the refresh loop on a std::thread so the schedule and
+// the fallback can be exercised against a mock Ssd1306Bus.
+void GreyPanel::run() {
+  _deadline = _windowStart = micros();
+  while (!_stop) runCycle();
+}
+
+bool GreyPanel::begin() {
+  if (!allocate()) return false;
+  _thread = std::thread(&GreyPanel::run, this);
+  _started = true;
+  return true;
+}
+
+GreyPanel::~GreyPanel() {
+  if (_started) {
+    _stop = true;
+    _thread.join();
+  }
+  free(_back);
+}
+
+void GreyPanel::commit() {
+  if (_back == nullptr) return;
+  uint8_t bits = _active;
+  compose(_spare, bits);
+  std::lock_guard<std::mutex> guard(_lock);
+  uint8_t* planes = _front;
+  _front = _spare;
+  _spare = planes;
+  _frontBits = bits;
+  _fresh = true;
+}
+
+#endif
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+#include <Print.h>
+
+#include "dirty_flush.h"
+#include "panel.h"
+
+#if defined(ESP32)
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <chrono>
+#include <mutex>
+#include <thread>
+#endif
+
+// Temporal greyscale for the monochrome panel. The scene draws intensity
+// levels 0..maxLevel() (the GFX colour is the level) and commit()s the
+// frame; a refresh task shows it by cycling bit-planes through the panel at
+// a fixed cadence. Plane k stays up for 2^k slots, so a pixel is lit for
+// level / maxLevel() of each cycle. Back-to-back slots of the same plane
+// send nothing, and DirtyFlush skips the columns two planes share.
+//
+// The task compares the slot rate it achieves with the rate the cadence
+// needs. When it keeps falling short it drops the lowest plane; at one
+// plane it shows a 4x4 ordered dither of the levels instead, so a bus that
+// cannot keep up costs shades rather than flicker. Once every plane has
+// gone out well inside the slot the next depth would have, for long
+// enough, it takes the plane back; a depth that is raised and soon dropped
+// again makes the next try wait twice as long. Landscape only; the task
+// owns the bus once begin() succeeds.
+//
+// Between slots the task sleeps on an esp_timer one-shot rather than
+// spinning, so the time it leaves goes to loop().
+class GreyPanel : public Adafruit_GFX {
+ public:
+  static constexpr uint8_t kMaxBits = 4;
+
+  // bits is 1..kMaxBits; cycleHz is how often every level completes its
+  // on/off cycle (about 30 is flicker-free, 15 shimmers).
+  GreyPanel(DirtyFlush& flusher, uint8_t bits, uint8_t cycleHz);
+#if !defined(ESP32)
+  ~GreyPanel();
+#endif
+
+  // Allocate the planes and start the refresh task. Returns false if the
+  // planes could not be allocated. If only the task could not be started,
+  // commit() sends the dithered frame itself.
+  bool begin();
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+
+  uint16_t maxLevel() const { return (1 << _bits) - 1; }
+
+  // Hand the drawn frame to the refresh task. Drawing can continue at once;
+  // the task picks the new frame up at the start of its next cycle.
+  void commit();
+
+  // Slots per second the cadence needs at the current depth, and the rate
+  // measured over the last second. Each slot is one plane on screen.
+  uint16_t requiredHz() const { return _requiredHz; }
+  uint16_t achievedHz() const { return _achievedHz; }
+  uint8_t activeBits() const { return _active; }
+  uint32_t missedSlots() const { return _missed; }
+  uint32_t drops() const { return _drops; }
+  uint32_t raises() const { return _raises; }
+
+  void printStats(Print& out) const;
+
+ private:
+  static const uint8_t kRaiseWindows = 10;
+  static const uint8_t kMaxRaiseWindows = 16 * kRaiseWindows;
+
+  uint8_t* backPlane(int k) { return _back + k * kFrameBytes; }
+  bool allocate();
+  void compose(uint8_t* dst, uint8_t bits);
+  void runCycle();
+  void waitUntil(uint32_t deadline);
+  void measure(uint32_t now);
+  void run();
+
+  DirtyFlush& _flusher;
+  uint8_t _bits;
+  uint8_t _cycleHz;
+  uint8_t* _back = nullptr;   // drawn by the scene, _bits planes
+  uint8_t* _spare = nullptr;  // commit() composes here, outside the lock
+  uint8_t* _front = nullptr;  // last commit, waiting for the task
+  uint8_t* _shown = nullptr;  // planes the task is cycling
+  uint8_t _frontBits = 1;
+  uint8_t _shownBits = 1;
+  bool _fresh = false;
+  bool _started = false;
+
+  volatile uint8_t _active;
+  volatile uint16_t _requiredHz = 0;
+  volatile uint16_t _achievedHz = 0;
+  volatile uint32_t _missed = 0;
+  uint32_t _deadline = 0;
+  uint32_t _windowStart = 0;
+  uint32_t _windowSlots = 0;
+  uint32_t _windowSendMicros = 0;  // plane sends this window
+  uint32_t _windowSends = 0;
+  uint8_t _shortWindows = 0;
+  uint8_t _goodWindows = 0;
+  uint8_t _raiseWait = kRaiseWindows;
+  uint16_t _sinceRaise = 0xFFFF;  // windows since the last raise
+  uint32_t _drops = 0;
+  uint32_t _raises = 0;
+
+#if defined(ESP32)
+  static void taskEntry(void* arg);
+  static void onSlotTimer(void* arg);
+  SemaphoreHandle_t _lock = nullptr;
+  TaskHandle_t _task = nullptr;
+  esp_timer_handle_t _slotTimer = nullptr;
+#else
+  std::thread _thread;
+  std::mutex _lock;
+  volatile bool _stop = false;
+#endif
+};
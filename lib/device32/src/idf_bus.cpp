@@ -0,0 +1,91 @@
+#include "idf_bus.h"
+
+#include <Adafruit_SSD1306.h>
+#include <Wire.h>
+#include <string.h>
+
+bool IdfBus::begin(int sda, int scl) {
+#if defined(ESP32)
+  esp_err_t err = i2c_driver_install((i2c_port_t)_port, I2C_MODE_MASTER, 0, 0, 0);
+  if (err == ESP_FAIL) {
+    // Wire owns the port: change the clock through it, so its own
+    // bookkeeping and lock stay in step with the driver.
+#if SOC_I2C_NUM > 1
+    TwoWire& wire = _port == 0 ? Wire : Wire1;
+#else
+    TwoWire& wire = Wire;
+#endif
+    wire.setClock(_clock);
+    return true;
+  }
+  if (err != ESP_OK) return false;
+  i2c_config_t conf = {};
+  conf.mode = I2C_MODE_MASTER;
+  conf.sda_io_num = sda;
+  conf.scl_io_num = scl;
+  conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
+  conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
+  conf.master.clk_speed = _clock;
+  return i2c_param_config((i2c_port_t)_port, &conf) == ESP_OK;
+#else
+  (void)sda;
+  (void)scl;
+  return true;
+#endif
+}
+
+void IdfBus::queue(uint8_t control, const uint8_t* bytes, size_t len) {
+#if defined(ESP32)
+  if (!_cmd) _cmd = i2c_cmd_link_create_static(_link, sizeof(_link));
+  i2c_master_start(_cmd);
+  i2c_master_write_byte(_cmd, (uint8_t)(_addr << 1) | I2C_MASTER_WRITE, true);
+  i2c_master_write_byte(_cmd, control, true);
+  if (len) i2c_master_write(_cmd, bytes, len, true);
+#else
+  (void)control;
+  (void)bytes;
+  _open = true;
+#endif
+  _bytes += 1 + len;
+}
+
+void IdfBus::submit() {
+#if defined(ESP32)
+  if (!_cmd) return;
+  i2c_master_stop(_cmd);
+  if (i2c_master_cmd_begin((i2c_port_t)_port, _cmd, pdMS_TO_TICKS(100)) != ESP_OK) _errors++;
+  i2c_cmd_link_delete_static(_cmd);
+  _cmd = nullptr;
+#else
+  if (!_open) return;
+  _open = false;
+#endif
+  _transactions++;
+  _windows = 0;
+}
+
+void IdfBus::commands(const uint8_t* cmds, size_t len) {
+  queue(0x00, cmds, len);
+  if (!_batching) submit();
+}
+
+void IdfBus::data(const uint8_t* bytes, size_t len) {
+  queue(0x40, bytes, len);
+  if (!_batching) submit();
+}
+
+void IdfBus::writeWindow(uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1,
+                         const uint8_t* bytes, size_t len) {
+  if (_windows == kMaxBatch) submit();
+  uint8_t* cmds = _window[_windows++];
+  const uint8_t window[] = {SSD1306_COLUMNADDR, col0, col1, SSD1306_PAGEADDR, page0, page1};
+  memcpy(cmds, window, sizeof(window));
+  queue(0x00, cmds, sizeof(window));
+  queue(0x40, bytes, len);
+  if (!_batching) submit();
+}
+
+void IdfBus::endBatch() {
+  _batching = false;
+  submit();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ssd1306_bus.h"
+
+#if defined(ESP32)
+#include <driver/i2c.h>
+#endif
+
+// SSD1306 transport straight on the ESP-IDF I2C master driver. WireBus
+// sends every address window as its own transaction and then the data in
+// Wire-buffer-sized chunks, each with a start, address and 0x40 control
+// byte, and each a separate round trip through the driver. Here a window
+// is queued as
+//
+//   START addr 0x00 cmds...  RESTART addr 0x40 data...
+//
+// and a batch (DirtyFlush brackets each flush with one) queues all its
+// windows into the same command link, ending in one STOP. The driver gets
+// a single submission per frame and streams from the caller's buffers
+// without copying. Data is never split, so a full frame is one transfer.
+//
+// Arduino Wire on Arduino-ESP32 2.x is itself built on this driver, so the
+// bus shares the port with the display object: display.begin() and anything
+// else on Wire keep working, and only the flushes handed to IdfBus take
+// this path. The clock is the port's, not the bus's: begin() sets it through
+// Wire.setClock() when Wire owns the port, so every Wire transfer runs at it
+// too. Adafruit_SSD1306 sets its own clock around each of its transfers and
+// puts back its restore clock afterwards, so a display.* call after begin()
+// leaves the port at that clock until begin() is called again.
+//
+// On host builds nothing is sent; the framing and counters are the same,
+// as a model of the bus. transactions() counts submissions (start to
+// stop), bytesSent() control, command and data bytes.
+class IdfBus : public Ssd1306Bus {
+ public:
+  static constexpr int kMaxBatch = 8;  // windows per submission
+
+  // clock in Hz; up to 1 MHz (fast-mode plus) where panel and wiring allow.
+  explicit IdfBus(int port = 0, uint8_t addr = 0x3C, uint32_t clock = 1000000)
+    : _port(port), _addr(addr), _clock(clock) {}
+
+  // Set the port to the clock, installing and configuring the driver for
+  // sda/scl if Wire has not already. Returns false if the driver reports
+  // an error.
+  bool begin(int sda, int scl);
+
+  void commands(const uint8_t* cmds, size_t len) override;
+  void data(const uint8_t* bytes, size_t len) override;
+  void writeWindow(uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1,
+                   const uint8_t* bytes, size_t len) override;
+  void beginBatch() override { _batching = true; }
+  void endBatch() override;
+
+  uint32_t clock() const { return _clock; }
+  // Submissions that failed or timed out on the bus.
+  uint32_t errors() const { return _errors; }
+
+ private:
+  // Append one addressed segment (START addr control bytes...) to the link.
+  void queue(uint8_t control, const uint8_t* bytes, size_t len);
+  void submit();
+
+  int _port;
+  uint8_t _addr;
+  uint32_t _clock;
+  uint32_t _errors = 0;
+  bool _batching = false;
+  int _windows = 0;
+  uint8_t _window[kMaxBatch][6];  // address commands, alive until submit()
+#if defined(ESP32)
+  i2c_cmd_handle_t _cmd = nullptr;
+  // Each window is two addressed segments plus control bytes.
+  uint8_t _link[I2C_LINK_RECOMMENDED_SIZE(3 * kMaxBatch)];
+#else
+  bool _open = false;
+#endif
+};
@@ -0,0 +1,51 @@
+#include "live_events.h"
+
+#include <string.h>
+
+const char kLiveResponseHead[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "retry: 1000\n\n";
+
+static const char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static char* base64(const uint8_t* p, size_t len, char* out) {
+  for (; len >= 3; p += 3, len -= 3) {
+    uint32_t v = (uint32_t)p[0] << 16 | p[1] << 8 | p[2];
+    *out++ = kBase64[v >> 18];
+    *out++ = kBase64[v >> 12 & 63];
+    *out++ = kBase64[v >> 6 & 63];
+    *out++ = kBase64[v & 63];
+  }
+  if (len) {
+    uint32_t v = (uint32_t)p[0] << 16 | (len == 2 ? p[1] << 8 : 0);
+    *out++ = kBase64[v >> 18];
+    *out++ = kBase64[v >> 12 & 63];
+    *out++ = len == 2 ? kBase64[v >> 6 & 63] : '=';
+    *out++ = '=';
+  }
+  return out;
+}
+
+size_t LiveEvents::encode(const uint8_t* frame, char* out) {
+  _encoder.encode(frame, 0, _packet);
+  const uint8_t* payload = _packet + kMirrorHeaderBytes;
+  size_t len = _packet[8] | _packet[9] << 8;
+  bool key = _packet[4] == 'K';
+  // An unchanged frame codes as nothing but 128-byte skips.
+  if (!key && len == kFrameBytes / 128) {
+    bool same = true;
+    for (size_t i = 0; i < len; i++) same = same && payload[i] == 0x7F;
+    if (same) return 0;
+  }
+
+  char* o = out;
+  memcpy(o, key ? "event: k\ndata: " : "event: d\ndata: ", kLiveEventPrefix);
+  o = base64(payload, len, o + kLiveEventPrefix);
+  *o++ = '\n';
+  *o++ = '\n';
+  return o - out;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "frame_mirror.h"
+
+// Server-sent events carrying the framebuffer to a browser. Each event is
+// the payload of a frame_mirror.h packet, base64 coded:
+//
+//   event: k          keyframe, XOR into a black frame
+//   event: d          delta, XOR into the frame on hand
+//   data: <base64 anim_stream.h tokens>
+//
+// One LiveEvents per connection, since each has its own reference frame.
+// Events are built in a caller's fixed buffer, so a stream costs no heap
+// after the connection is accepted. A new connection starts with a
+// keyframe; TCP keeps the rest in order, so later keyframes are rare.
+constexpr size_t kLiveEventPrefix = 15;  // "event: k\ndata: "
+constexpr size_t kLiveMaxEvent = kLiveEventPrefix + 4 * ((kMirrorMaxPayload + 2) / 3) + 2;
+
+// HTTP response head for a raw client that has been taken over from the
+// web server, ending in the blank line; events follow directly.
+extern const char kLiveResponseHead[];
+
+class LiveEvents {
+ public:
+  explicit LiveEvents(uint16_t keyframeEvery = 600) : _encoder(keyframeEvery) {}
+
+  // Build the event for frame into out (kLiveMaxEvent bytes) and return
+  // its length, or 0 if the frame is the one last sent and no keyframe is
+  // due. commit() once it is written.
+  size_t encode(const uint8_t* frame, char* out);
+  void commit(const uint8_t* frame) { _encoder.commit(frame); }
+
+  // Start over with a keyframe, e.g. for a new connection on this slot.
+  void restart() { _encoder.forceKeyframe(); }
+
+ private:
+  MirrorEncoder _encoder;
+  uint8_t _packet[kMirrorMaxPacket];
+};
@@ -0,0 +1,166 @@
+#include "page_line.h"
+
+#include <stdlib.h>
+
+enum : uint8_t { kOutLeft = 1, kOutRight = 2, kOutTop = 4, kOutBottom = 8 };
+
+static inline uint8_t outcode(int x, int y) {
+  uint8_t code = 0;
+  if (x < 0) code |= kOutLeft;
+  else if (x >= kPanelWidth) code |= kOutRight;
+  if (y < 0) code |= kOutTop;
+  else if (y >= kPanelHeight) code |= kOutBottom;
+  return code;
+}
+
+static inline void apply(uint8_t* p, uint8_t mask, uint16_t color) {
+  switch (color) {
+    case kWhite: *p |= mask; break;
+    case kBlack: *p &= ~mask; break;
+    case kInverse: *p ^= mask; break;
+  }
+}
+
+static inline void plot(uint8_t* frame, int x, int y, uint16_t color) {
+  apply(frame + x + (y >> 3) * kPanelWidth, 1 << (y & 7), color);
+}
+
+static void hSpan(uint8_t* frame, int x0, int x1, int y, uint16_t color) {
+  if (y < 0 || y >= kPanelHeight) return;
+  if (x0 < 0) x0 = 0;
+  if (x1 >= kPanelWidth) x1 = kPanelWidth - 1;
+  uint8_t* p = frame + (y >> 3) * kPanelWidth;
+  uint8_t mask = 1 << (y & 7);
+  for (int x = x0; x <= x1; x++) apply(p + x, mask, color);
+}
+
+static void vSpan(uint8_t* frame, int x, int y0, int y1, uint16_t color) {
+  if (x < 0 || x >= kPanelWidth) return;
+  if (y0 < 0) y0 = 0;
+  if (y1 >= kPanelHeight) y1 = kPanelHeight - 1;
+  for (int page = y0 >> 3; page <= y1 >> 3; page++) {
+    int top = page * 8 > y0 ? page * 8 : y0;
+    int bottom = page * 8 + 7 < y1 ? page * 8 + 7 : y1;
+    uint8_t mask = (uint8_t)((0xFF << (top & 7)) & (0xFF >> (7 - (bottom & 7))));
+    apply(frame + x + page * kPanelWidth, mask, color);
+  }
+}
+
+void pageLine(uint8_t* frame, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  uint8_t c0 = outcode(x0, y0), c1 = outcode(x1, y1);
+  if (c0 & c1) return;  // both ends past the same edge
+
+  if (x0 == x1) {
+    if (y0 > y1) { int16_t t = y0; y0 = y1; y1 = t; }
+    if ((c0 | c1) == 0 && y0 == y1) plot(frame, x0, y0, color);
+    else vSpan(frame, x0, y0, y1, color);
+    return;
+  }
+  if (y0 == y1) {
+    if (x0 > x1) { int16_t t = x0; x0 = x1; x1 = t; }
+    hSpan(frame, x0, x1, y0, color);
+    return;
+  }
+
+  // Major axis a, minor axis b, stepped exactly like Adafruit_GFX::writeLine().
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  int a0 = steep ? y0 : x0, b0 = steep ? x0 : y0;
+  int a1 = steep ? y1 : x1, b1 = steep ? x1 : y1;
+  if (a0 > a1) {
+    int t = a0; a0 = a1; a1 = t;
+    t = b0; b0 = b1; b1 = t;
+  }
+  int da = a1 - a0, db = abs(b1 - b0);
+  int err = da / 2;
+  int bstep = b0 < b1 ? 1 : -1;
+
+  if (c0 | c1) {
+    // Partly off screen: clip the major range, jump the error term to the
+    // first visible step, and bounds-check only the minor axis.
+    int aLimit = steep ? kPanelHeight : kPanelWidth;
+    int bLimit = steep ? kPanelWidth : kPanelHeight;
+    int k0 = a0 < 0 ? -a0 : 0;
+    int k1 = a1 >= aLimit ? aLimit - 1 - a0 : da;
+    if (k0 > k1) return;
+    int b = b0;
+    if (k0 > 0) {
+      int n = (int)(((int32_t)k0 * db - err + da - 1) / da);
+      b += bstep * n;
+      err = (int)(err - (int32_t)k0 * db + (int32_t)n * da);
+    }
+    for (int k = k0; k <= k1; k++) {
+      if (b >= 0 && b < bLimit) {
+        if (steep) plot(frame, b, a0 + k, color);
+        else plot(frame, a0 + k, b, color);
+      } else if ((b < 0) == (bstep < 0)) {
+        break;  // left the screen for good
+      }
+      err -= db;
+      if (err < 0) {
+        b += bstep;
+        err += da;
+      }
+    }
+    return;
+  }
+
+  if (da < 4) {
+    // 2-4 px: the bulk of marching-squares output; plot without setting
+    // up the pointer walk.
+    for (int a = a0, b = b0; a <= a1; a++) {
+      if (steep) plot(frame, b, a, color);
+      else plot(frame, a, b, color);
+      err -= db;
+      if (err < 0) {
+        b += bstep;
+        err += da;
+      }
+    }
+    return;
+  }
+
+  if (!steep) {
+    // One column per step; the row bit moves between pages on overflow.
+    uint8_t* p = frame + a0 + (b0 >> 3) * kPanelWidth;
+    uint8_t mask = 1 << (b0 & 7);
+    for (int a = a0; a <= a1; a++, p++) {
+      apply(p, mask, color);
+      err -= db;
+      if (err < 0) {
+        err += da;
+        if (bstep > 0) {
+          mask <<= 1;
+          if (!mask) { mask = 0x01; p += kPanelWidth; }
+        } else {
+          mask >>= 1;
+          if (!mask) { mask = 0x80; p -= kPanelWidth; }
+        }
+      }
+    }
+    return;
+  }
+
+  // Steep: one row per step. Rows that share a column byte are gathered
+  // into acc and written once.
+  uint8_t* p = frame + b0 + (a0 >> 3) * kPanelWidth;
+  uint8_t bit = 1 << (a0 & 7);
+  uint8_t acc = 0;
+  for (int a = a0; a <= a1; a++) {
+    acc |= bit;
+    bit <<= 1;
+    err -= db;
+    if (err < 0) {
+      err += da;
+      apply(p, acc, color);
+      acc = 0;
+      p += bstep;
+    }
+    if (!bit) {
+      if (acc) apply(p, acc, color);
+      acc = 0;
+      bit = 0x01;
+      p += kPanelWidth;
+    }
+  }
+  if (acc) apply(p, acc, color);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "panel.h"
+
+// Line straight into a 128x64 SSD1306 page buffer (unrotated, e.g.
+// Adafruit_SSD1306::getBuffer()), for scenes that draw many short lines.
+// Same pixels as Adafruit_GFX::drawLine(): Cohen-Sutherland outcodes reject
+// off-screen lines and pick the unchecked path for on-screen ones, partially
+// visible lines jump the Bresenham state to the first visible column, and
+// the walk steps page pointers and bit masks instead of going through
+// drawPixel(). Steep runs OR several rows into a column byte at once.
+void pageLine(uint8_t* frame, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
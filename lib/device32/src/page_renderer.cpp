@@ -0,0 +1,227 @@
+#include "page_renderer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum OpKind : uint8_t {
+  kOpPixel,
+  kOpHLine,
+  kOpVLine,
+  kOpFillRect,
+  kOpLine,
+  kOpRect,
+  kOpRoundRect,
+  kOpFillRoundRect,
+  kOpCircle,
+  kOpFillCircle,
+  kOpChar,
+};
+
+// Replay target for one page: full-screen Adafruit_GFX whose pixels only
+// land if they fall in the current 8-row band. Rotation and colour handling
+// match Adafruit_SSD1306::drawPixel.
+class PageBand : public Adafruit_GFX {
+ public:
+  PageBand(uint8_t* page, int index, uint8_t rot) : Adafruit_GFX(kPanelWidth, kPanelHeight), _page(page), _index(index) {
+    setRotation(rot);
+  }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || x >= width() || y < 0 || y >= height()) return;
+    switch (rotation) {
+      case 1: _swap_int16_t(x, y); x = WIDTH - x - 1; break;
+      case 2: x = WIDTH - x - 1; y = HEIGHT - y - 1; break;
+      case 3: _swap_int16_t(x, y); y = HEIGHT - y - 1; break;
+    }
+    if ((y >> 3) != _index) return;
+    uint8_t bit = 1 << (y & 7);
+    switch (color) {
+      case SSD1306_WHITE: _page[x] |= bit; break;
+      case SSD1306_BLACK: _page[x] &= ~bit; break;
+      case SSD1306_INVERSE: _page[x] ^= bit; break;
+    }
+  }
+
+  // Unrotated rectangles are the common case; clip them to the band and
+  // apply one mask per column.
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+    if (rotation != 0) {
+      for (int i = x; i < x + w; i++)
+        for (int j = y; j < y + h; j++) drawPixel(i, j, color);
+      return;
+    }
+    int x0 = max<int>(x, 0), x1 = min<int>(x + w, kPanelWidth);
+    int y0 = max<int>(y, _index * 8), y1 = min<int>(y + h, _index * 8 + 8);
+    if (x0 >= x1 || y0 >= y1) return;
+    uint8_t mask = (uint8_t)((0xFF << (y0 & 7)) & (0xFF >> (7 - ((y1 - 1) & 7))));
+    for (int i = x0; i < x1; i++) {
+      switch (color) {
+        case SSD1306_WHITE: _page[i] |= mask; break;
+        case SSD1306_BLACK: _page[i] &= ~mask; break;
+        case SSD1306_INVERSE: _page[i] ^= mask; break;
+      }
+    }
+  }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override { fillRect(x, y, w, 1, color); }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override { fillRect(x, y, 1, h, color); }
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override { fillRect(x, y, w, 1, color); }
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override { fillRect(x, y, 1, h, color); }
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override { fillRect(x, y, w, h, color); }
+
+ private:
+  uint8_t* _page;
+  int _index;
+};
+
+PageRenderer::PageRenderer(Ssd1306Bus& bus, uint16_t capacity)
+  : Adafruit_GFX(kPanelWidth, kPanelHeight), _bus(bus), _capacity(capacity) {}
+
+PageRenderer::~PageRenderer() {
+  free(_ops);
+}
+
+bool PageRenderer::begin(uint8_t vccstate, uint8_t) {
+  if (_ops == nullptr) {
+    _ops = static_cast<Op*>(malloc(sizeof(Op) * _capacity));
+    if (_ops == nullptr) return false;
+  }
+  _count = 0;
+  _bus.init(vccstate);
+  return true;
+}
+
+void PageRenderer::record(uint8_t kind, uint16_t color, int16_t a, int16_t b, int16_t c, int16_t d,
+                          int16_t bx, int16_t by, int16_t bw, int16_t bh, uint8_t arg, uint8_t arg2) {
+  // Logical bounding box to panel rows, so replay can skip pages an op
+  // cannot touch.
+  int r0, r1;
+  switch (rotation) {
+    case 1: r0 = bx; r1 = bx + bw - 1; break;
+    case 2: r0 = kPanelHeight - by - bh; r1 = kPanelHeight - 1 - by; break;
+    case 3: r0 = kPanelHeight - bx - bw; r1 = kPanelHeight - 1 - bx; break;
+    default: r0 = by; r1 = by + bh - 1; break;
+  }
+  if (r0 < 0) r0 = 0;
+  if (r1 >= kPanelHeight) r1 = kPanelHeight - 1;
+  if (r0 > r1 || bw <= 0 || bh <= 0) return;
+
+  if (_ops == nullptr || _count >= _capacity) {
+    _dropped++;
+    return;
+  }
+  Op& op = _ops[_count++];
+  op.kind = kind;
+  op.color = (uint8_t)color;
+  op.arg = arg;
+  op.arg2 = arg2;
+  op.page0 = r0 >> 3;
+  op.page1 = r1 >> 3;
+  op.a = a;
+  op.b = b;
+  op.c = c;
+  op.d = d;
+}
+
+void PageRenderer::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  record(kOpPixel, color, x, y, 0, 0, x, y, 1, 1);
+}
+
+void PageRenderer::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  record(kOpHLine, color, x, y, w, 0, x, y, w, 1);
+}
+
+void PageRenderer::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  record(kOpVLine, color, x, y, h, 0, x, y, 1, h);
+}
+
+void PageRenderer::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  record(kOpFillRect, color, x, y, w, h, x, y, w, h);
+}
+
+void PageRenderer::fillScreen(uint16_t color) {
+  if (color == SSD1306_BLACK) {
+    // Nothing drawn so far can show through a black screen.
+    _count = 0;
+    return;
+  }
+  fillRect(0, 0, _width, _height, color);
+}
+
+void PageRenderer::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  int16_t bx = min(x0, x1), by = min(y0, y1);
+  record(kOpLine, color, x0, y0, x1, y1, bx, by, abs(x1 - x0) + 1, abs(y1 - y0) + 1);
+}
+
+void PageRenderer::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  record(kOpRect, color, x, y, w, h, x, y, w, h);
+}
+
+void PageRenderer::drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color) {
+  record(kOpRoundRect, color, x, y, w, h, x, y, w, h, (uint8_t)r);
+}
+
+void PageRenderer::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color) {
+  record(kOpFillRoundRect, color, x, y, w, h, x, y, w, h, (uint8_t)r);
+}
+
+void PageRenderer::drawCircle(int16_t x, int16_t y, int16_t r, uint16_t color) {
+  record(kOpCircle, color, x, y, r, 0, x - r, y - r, 2 * r + 1, 2 * r + 1);
+}
+
+void PageRenderer::fillCircle(int16_t x, int16_t y, int16_t r, uint16_t color) {
+  record(kOpFillCircle, color, x, y, r, 0, x - r, y - r, 2 * r + 1, 2 * r + 1);
+}
+
+void PageRenderer::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg,
+                            uint8_t size_x, uint8_t size_y) {
+  // Background 3 marks a transparent glyph (bg == color in Adafruit_GFX).
+  uint8_t bgBits = bg == color ? 3 : (bg & 0x03);
+  uint8_t packed = (uint8_t)(bgBits | (size_x & 0x07) << 2 | (size_y & 0x07) << 5);
+  record(kOpChar, color, x, y, 0, 0, x, y, 6 * size_x, 8 * size_y, c, packed);
+}
+
+size_t PageRenderer::write(uint8_t c) {
+  if (gfxFont) return Adafruit_GFX::write(c);
+  // Same cursor handling as Adafruit_GFX::write() for the built-in font.
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += textsize_y * 8;
+  } else if (c != '\r') {
+    if (wrap && ((cursor_x + textsize_x * 6) > _width)) {
+      cursor_x = 0;
+      cursor_y += textsize_y * 8;
+    }
+    drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x, textsize_y);
+    cursor_x += textsize_x * 6;
+  }
+  return 1;
+}
+
+void PageRenderer::display() {
+  for (int page = 0; page < kPanelPages; page++) {
+    memset(_page, 0, sizeof(_page));
+    PageBand band(_page, page, rotation);
+    for (uint16_t i = 0; i < _count; i++) {
+      const Op& op = _ops[i];
+      if (page < op.page0 || page > op.page1) continue;
+      switch (op.kind) {
+        case kOpPixel: band.drawPixel(op.a, op.b, op.color); break;
+        case kOpHLine: band.drawFastHLine(op.a, op.b, op.c, op.color); break;
+        case kOpVLine: band.drawFastVLine(op.a, op.b, op.c, op.color); break;
+        case kOpFillRect: band.fillRect(op.a, op.b, op.c, op.d, op.color); break;
+        case kOpLine: band.drawLine(op.a, op.b, op.c, op.d, op.color); break;
+        case kOpRect: band.drawRect(op.a, op.b, op.c, op.d, op.color); break;
+        case kOpRoundRect: band.drawRoundRect(op.a, op.b, op.c, op.d, op.arg, op.color); break;
+        case kOpFillRoundRect: band.fillRoundRect(op.a, op.b, op.c, op.d, op.arg, op.color); break;
+        case kOpCircle: band.drawCircle(op.a, op.b, op.c, op.color); break;
+        case kOpFillCircle: band.fillCircle(op.a, op.b, op.c, op.color); break;
+        case kOpChar: {
+          uint8_t bg = (op.arg2 & 0x03) == 3 ? op.color : (op.arg2 & 0x03);
+          band.drawChar(op.a, op.b, op.arg, op.color, bg, (op.arg2 >> 2) & 0x07, op.arg2 >> 5);
+          break;
+        }
+      }
+    }
+    _bus.writeWindow(0, kPanelWidth - 1, page, page, _page, sizeof(_page));
+  }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+
+#include "panel.h"
+#include "ssd1306_bus.h"
+
+// Retained display-list renderer in the style of u8g2's page mode. Draw
+// calls are recorded as compact ops instead of touching a framebuffer;
+// display() replays them one 8-row page at a time into a single 128-byte
+// page buffer and sends each page as soon as it is done. A scene whose
+// frame is a handful of shapes needs a few hundred bytes instead of the
+// 1 KB Adafruit_SSD1306 buffer.
+//
+// It mirrors the Adafruit_SSD1306 calls scenes use (begin, clearDisplay,
+// display, and the Adafruit_GFX drawing API), so opting in is a change to
+// the type of the display object. Replay goes through the same Adafruit_GFX
+// code per page, so the pixels match the full-buffer path.
+class PageRenderer : public Adafruit_GFX {
+ public:
+  // capacity is the number of draw ops kept per frame; ops past it are
+  // dropped and counted.
+  PageRenderer(Ssd1306Bus& bus, uint16_t capacity);
+  ~PageRenderer();
+
+  // Allocates the op list and sends the panel init sequence. The I2C
+  // address belongs to the bus; i2caddr is accepted so existing begin()
+  // calls compile unchanged.
+  bool begin(uint8_t vccstate = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0);
+  void clearDisplay() { _count = 0; }
+  void display();
+
+  uint16_t opCount() const { return _count; }
+  uint32_t droppedOps() const { return _dropped; }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) override;
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) override {
+    drawLine(x0, y0, x1, y1, color);
+  }
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+    drawFastHLine(x, y, w, color);
+  }
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+    drawFastVLine(x, y, h, color);
+  }
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+    fillRect(x, y, w, h, color);
+  }
+
+  // Non-virtual in Adafruit_GFX; recorded as one op when called on a
+  // PageRenderer instead of decomposing into pixels and spans.
+  void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+  void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+  void drawCircle(int16_t x, int16_t y, int16_t r, uint16_t color);
+  void fillCircle(int16_t x, int16_t y, int16_t r, uint16_t color);
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+    drawChar(x, y, c, color, bg, size, size);
+  }
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg,
+                uint8_t size_x, uint8_t size_y);
+
+  // Text through print() records one op per glyph (built-in font only).
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  struct Op {
+    uint8_t kind;
+    uint8_t color;
+    uint8_t arg;   // radius or glyph
+    uint8_t arg2;  // glyph bg | size_x << 2 | size_y << 5
+    uint8_t page0;
+    uint8_t page1;
+    int16_t a, b, c, d;
+  };
+
+ private:
+  void record(uint8_t kind, uint16_t color, int16_t a, int16_t b, int16_t c, int16_t d,
+              int16_t bx, int16_t by, int16_t bw, int16_t bh, uint8_t arg = 0, uint8_t arg2 = 0);
+
+  Ssd1306Bus& _bus;
+  Op* _ops = nullptr;
+  uint16_t _capacity;
+  uint16_t _count = 0;
+  uint32_t _dropped = 0;
+  uint8_t _page[kPanelWidth];
+};
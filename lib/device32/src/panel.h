@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+// device32 panel geometry. The SSD1306 stores the screen as 8 horizontal
+// pages of 128 column bytes; bit n of a column byte is row (page * 8 + n).
+constexpr int kPanelWidth = 128;
+constexpr int kPanelHeight = 64;
+constexpr int kPanelPages = kPanelHeight / 8;
+constexpr int kFrameBytes = kPanelWidth * kPanelPages;
+
+// Pixel colours, same values as SSD1306_BLACK / WHITE / INVERSE, for code
+// that works on raw page buffers without pulling in Adafruit_SSD1306.
+constexpr uint16_t kBlack = 0;
+constexpr uint16_t kWhite = 1;
+constexpr uint16_t kInverse = 2;
@@ -0,0 +1,72 @@
+#include "portrait_canvas.h"
+
+#include <Adafruit_SSD1306.h>
+#include <string.h>
+
+static inline uint64_t spanMask(int x, int w) {
+  uint64_t bits = w >= 64 ? ~0ULL : ((1ULL << w) - 1);
+  return bits << x;
+}
+
+void PortraitCanvas::applyMask(int y0, int y1, uint64_t mask, uint16_t color) {
+  for (int y = y0; y < y1; y++) {
+    uint64_t& r = row(y);
+    switch (color) {
+      case SSD1306_WHITE: r |= mask; break;
+      case SSD1306_BLACK: r &= ~mask; break;
+      case SSD1306_INVERSE: r ^= mask; break;
+    }
+  }
+}
+
+void PortraitCanvas::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || x >= kWidth || y < 0 || y >= kHeight) return;
+  applyMask(y, y + 1, 1ULL << x, color);
+}
+
+void PortraitCanvas::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void PortraitCanvas::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void PortraitCanvas::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  int x0 = max<int>(x, 0), x1 = min<int>(x + w, (int)kWidth);
+  int y0 = max<int>(y, 0), y1 = min<int>(y + h, (int)kHeight);
+  if (x0 >= x1 || y0 >= y1) return;
+  applyMask(y0, y1, spanMask(x0, x1 - x0), color);
+}
+
+void PortraitCanvas::fillScreen(uint16_t color) {
+  if (color == SSD1306_INVERSE) {
+    for (int i = 0; i < kPanelWidth; i++) _cols[i] = ~_cols[i];
+  } else {
+    memset(_cols, color == SSD1306_WHITE ? 0xFF : 0x00, sizeof(_cols));
+  }
+}
+
+size_t PortraitCanvas::present(Ssd1306Bus& bus) {
+  int first = 0, last = kPanelWidth - 1;
+  if (_valid) {
+    while (first < kPanelWidth && _cols[first] == _shadow[first]) first++;
+    if (first == kPanelWidth) {
+      _lastBytes = 0;
+      return 0;
+    }
+    while (_cols[last] == _shadow[last]) last--;
+  }
+
+  static const uint8_t kVertical[] = {SSD1306_MEMORYMODE, 0x01};
+  static const uint8_t kHorizontal[] = {SSD1306_MEMORYMODE, 0x00};
+  size_t len = (last - first + 1) * sizeof(uint64_t);
+  bus.commands(kVertical, sizeof(kVertical));
+  bus.writeWindow(first, last, 0, kPanelPages - 1, bytes() + first * sizeof(uint64_t), len);
+  bus.commands(kHorizontal, sizeof(kHorizontal));
+
+  memcpy(&_shadow[first], &_cols[first], len);
+  _valid = true;
+  _lastBytes = len;
+  return len;
+}
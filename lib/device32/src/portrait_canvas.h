@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+
+#include "panel.h"
+#include "ssd1306_bus.h"
+
+// 64x128 portrait render target laid out the way the SSD1306 streams in
+// vertical addressing mode. Each logical row is one 64-bit word (bit x is
+// pixel x), stored in panel column order: logical row y lives in panel
+// column 127 - y, so the word array is byte-for-byte the data stream for
+// COLUMNADDR 0..127 / PAGEADDR 0..7 with vertical addressing.
+//
+// Draws through the normal Adafruit_GFX API without the setRotation(1)
+// coordinate swap, and horizontal spans become a single OR per row.
+class PortraitCanvas : public Adafruit_GFX {
+ public:
+  static constexpr int kWidth = kPanelHeight;
+  static constexpr int kHeight = kPanelWidth;
+
+  PortraitCanvas() : Adafruit_GFX(kWidth, kHeight) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+    drawFastHLine(x, y, w, color);
+  }
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+    drawFastVLine(x, y, h, color);
+  }
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+    fillRect(x, y, w, h, color);
+  }
+
+  // Send the panel columns that changed since the last present(), using
+  // vertical addressing for the transfer and restoring horizontal mode
+  // afterwards so other flush paths keep working. Returns bytes sent.
+  size_t present(Ssd1306Bus& bus);
+  void invalidate() { _valid = false; }
+  size_t lastFrameBytes() const { return _lastBytes; }
+
+  const uint8_t* bytes() const { return reinterpret_cast<const uint8_t*>(_cols); }
+
+ private:
+  uint64_t& row(int y) { return _cols[kHeight - 1 - y]; }
+  void applyMask(int y0, int y1, uint64_t mask, uint16_t color);
+
+  uint64_t _cols[kPanelWidth] = {};
+  uint64_t _shadow[kPanelWidth];
+  bool _valid = false;
+  size_t _lastBytes = 0;
+};
@@ -0,0 +1,91 @@
+#include "quality_governor.h"
+
+#include <Arduino.h>
+
+QualityGovernor::QualityGovernor(uint32_t budgetMicros, uint8_t levels, uint8_t startLevel)
+  : _budget(budgetMicros), _levels(levels), _level(startLevel < levels ? startLevel : levels - 1) {}
+
+void QualityGovernor::reset(uint8_t levels, uint8_t level) {
+  _levels = levels;
+  _level = level < levels ? level : levels - 1;
+  _primed = false;
+  _over = 0;
+  _under = 0;
+  _raiseWait = kRaiseFrames;
+  _sinceRaise = 0xFFFF;
+}
+
+void QualityGovernor::begin() {
+  _start = micros();
+  _mark = _start;
+}
+
+void QualityGovernor::updated() {
+  uint32_t now = micros();
+  _frameUpdate = now - _mark;
+  _mark = now;
+}
+
+void QualityGovernor::rendered() {
+  uint32_t now = micros();
+  _frameRender = now - _mark;
+  _mark = now;
+}
+
+bool QualityGovernor::flushed() {
+  uint32_t frameFlush = micros() - _mark;
+  if (!_primed) {
+    // First frame at this level: start the averages from it rather than
+    // from what the last level cost.
+    _update = _frameUpdate << kShift;
+    _render = _frameRender << kShift;
+    _flush = frameFlush << kShift;
+    _primed = true;
+  } else {
+    _update += _frameUpdate - (_update >> kShift);
+    _render += _frameRender - (_render >> kShift);
+    _flush += frameFlush - (_flush >> kShift);
+  }
+  if (_sinceRaise != 0xFFFF) _sinceRaise++;
+
+  uint32_t busy = busyMicros();
+  _over = busy > _budget / 10 * 9 ? _over + 1 : 0;
+  _under = busy < _budget / 10 * 6 ? _under + 1 : 0;
+
+  if (_over >= kDropFrames && _level > 0) {
+    // The level just raised to did not hold: wait longer before trying it
+    // again.
+    if (_sinceRaise < 2 * _raiseWait && _raiseWait < kMaxRaiseFrames) _raiseWait *= 2;
+    _sinceRaise = 0xFFFF;
+    _drops++;
+    change(-1);
+    return true;
+  }
+  if (_under >= _raiseWait && _level + 1 < _levels) {
+    _sinceRaise = 0;
+    _raises++;
+    change(1);
+    return true;
+  }
+  return false;
+}
+
+void QualityGovernor::change(int8_t by) {
+  if (_log) {
+    _log->printf("quality: level %u -> %u, %lu of %lu us (update %lu, render %lu, flush %lu)\n",
+                 (unsigned)_level, (unsigned)(_level + by), (unsigned long)busyMicros(),
+                 (unsigned long)_budget, (unsigned long)updateMicros(), (unsigned long)renderMicros(),
+                 (unsigned long)flushMicros());
+  }
+  _level += by;
+  _primed = false;
+  _over = 0;
+  _under = 0;
+}
+
+void QualityGovernor::printStats(Print& out) const {
+  out.printf("quality: level %u of %u, %lu of %lu us (update %lu, render %lu, flush %lu), %lu drops, %lu raises\n",
+             (unsigned)_level, (unsigned)(_levels - 1), (unsigned long)busyMicros(), (unsigned long)_budget,
+             (unsigned long)updateMicros(), (unsigned long)renderMicros(), (unsigned long)flushMicros(),
+             (unsigned long)_drops, (unsigned long)_raises);
+}
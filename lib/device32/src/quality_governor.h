@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Print.h>
+#include <stdint.h>
+
+// Holds a scene to a frame budget by moving it between quality levels. The
+// scene keeps a table of knob settings per level (grid step, particle
+// count, ...) with 0 the cheapest, and times each drawn frame:
+//
+//   if (steps > 0) governor.begin();
+//   for (int n = 0; n < steps; n++) update();
+//   if (steps > 0) {
+//     governor.updated();
+//     render();
+//     governor.rendered();
+//     present();
+//     if (governor.flushed()) applyLevel(governor.level());
+//   }
+//
+// The smoothed frame time has to stay over 90% of the budget for a few
+// frames before the level drops, and under 60% for a couple of seconds
+// before it rises. A level that is raised and then dropped again soon
+// after makes the next raise wait twice as long, so a scene that sits near
+// the edge settles instead of flickering between two levels.
+class QualityGovernor {
+ public:
+  QualityGovernor(uint32_t budgetMicros, uint8_t levels, uint8_t startLevel);
+
+  void setBudget(uint32_t budgetMicros) { _budget = budgetMicros; }
+  uint32_t budget() const { return _budget; }
+  // Start over with another table, e.g. after a scene change.
+  void reset(uint8_t levels, uint8_t level);
+
+  void begin();
+  void updated();
+  void rendered();
+  // End of the frame, after the flush. Returns true when level() changed.
+  bool flushed();
+
+  uint8_t level() const { return _level; }
+  uint8_t levels() const { return _levels; }
+
+  // Each level change is written here, with the times that caused it.
+  void setLog(Print* log) { _log = log; }
+
+  // Smoothed phase times of the frames drawn at the current level.
+  uint32_t updateMicros() const { return _update >> kShift; }
+  uint32_t renderMicros() const { return _render >> kShift; }
+  uint32_t flushMicros() const { return _flush >> kShift; }
+  uint32_t busyMicros() const { return updateMicros() + renderMicros() + flushMicros(); }
+
+  uint32_t drops() const { return _drops; }
+  uint32_t raises() const { return _raises; }
+
+  void printStats(Print& out) const;
+
+ private:
+  static const int kShift = 3;  // averages over about 8 frames
+  static const uint16_t kDropFrames = 8;
+  static const uint16_t kRaiseFrames = 60;
+  static const uint16_t kMaxRaiseFrames = 16 * kRaiseFrames;
+
+  void change(int8_t by);
+
+  uint32_t _budget;
+  uint8_t _levels;
+  uint8_t _level;
+  Print* _log = nullptr;
+
+  uint32_t _start = 0;
+  uint32_t _mark = 0;
+  uint32_t _frameUpdate = 0;
+  uint32_t _frameRender = 0;
+  // Phase averages, scaled by 2^kShift; zero until the first frame at a level.
+  uint32_t _update = 0;
+  uint32_t _render = 0;
+  uint32_t _flush = 0;
+  bool _primed = false;
+
+  uint16_t _over = 0;
+  uint16_t _under = 0;
+  uint16_t _raiseWait = kRaiseFrames;
+  uint16_t _sinceRaise = 0xFFFF;
+  uint32_t _drops = 0;
+  uint32_t _raises = 0;
+};
@@ -0,0 +1,30 @@
+#include "scene.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+void SceneArena::release() {
+  if (_scene) {
+    if (_entered) _scene->exit();
+    _scene->~Scene();
+    _scene = nullptr;
+  }
+  // A scene built here next starts from zeroes, whatever the last one left.
+  memset(_storage, 0, _bytes);
+  _used = 0;
+  _ready = false;
+  _entered = false;
+}
+
+bool SceneArena::prepare(uint32_t untilMicros) {
+  if (_scene && !_ready) _ready = _scene->prepare(untilMicros);
+  return _ready;
+}
+
+void SceneArena::enter() {
+  if (!_scene) return;
+  while (!prepare(micros())) {
+  }
+  _scene->enter();
+  _entered = true;
+}
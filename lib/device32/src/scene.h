@@ -0,0 +1,98 @@
+#pragma once
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+// One mode of a sketch that shows several in turn. All of a scene's state
+// is members, so the object is the whole footprint, and nothing is set up
+// until the scene is about to be shown:
+//
+//   prepare() build the opening state (a dungeon, a flock), in slices
+//   enter()   become current: take over anything shared, e.g. rotation
+//   update()  one simulation step, stepMicros() apart
+//   render()  draw the frame into the display buffer
+//   exit()    put back what enter() took over
+//
+// prepare() is called until it returns true. Each call does at least one
+// slice of work and returns once micros() reaches untilMicros, so a scene
+// can be built ahead of time in what is left of other scenes' frames. A
+// scene whose setup is quick does it all in one call.
+//
+// A scene can offer quality levels to a QualityGovernor: qualityLevels() of
+// them, cheapest first, starting at defaultQuality().
+class Scene {
+ public:
+  Scene(const char* name, uint32_t stepMicros) : _name(name), _step(stepMicros) {}
+  virtual ~Scene() {}
+
+  virtual bool prepare(uint32_t untilMicros) {
+    (void)untilMicros;
+    return true;
+  }
+  virtual void enter() {}
+  virtual void update() = 0;
+  virtual void render() = 0;
+  virtual void exit() {}
+
+  virtual uint8_t qualityLevels() const { return 1; }
+  virtual uint8_t defaultQuality() const { return 0; }
+  virtual void setQuality(uint8_t level) { (void)level; }
+
+  const char* name() const { return _name; }
+  uint32_t stepMicros() const { return _step; }
+
+ private:
+  const char* _name;
+  uint32_t _step;
+};
+
+// Holds one Scene at a time in storage the sketch sizes to its largest
+// scene, so scene RAM is the largest footprint rather than the sum of all
+// of them. build<T>() ends the scene already there (exit() if it was
+// entered, destructor), zeroes the storage and constructs a T in it.
+//
+//   alignas(8) static uint8_t storage[maxOf(sizeof(A), sizeof(B))];
+//   SceneArena arena(storage, sizeof(storage));
+//   Scene* scene = arena.build<A>();
+//   arena.enter();
+//
+// A second arena can stage the next scene: build it there, prepare() it a
+// slice at a time, and swap the two arena pointers when it is due.
+class SceneArena {
+ public:
+  SceneArena(void* storage, size_t bytes) : _storage(storage), _bytes(bytes) {}
+  ~SceneArena() { release(); }
+
+  // Null if T does not fit; check sizes with static_assert instead.
+  template <class T>
+  T* build() {
+    release();
+    if (sizeof(T) > _bytes) return nullptr;
+    T* scene = new (_storage) T();
+    _scene = scene;
+    _used = sizeof(T);
+    return scene;
+  }
+  // Exit the scene if it was entered, destroy it and zero the storage.
+  void release();
+
+  // A slice of the scene's prepare(); true once it is done.
+  bool prepare(uint32_t untilMicros);
+  bool ready() const { return _ready; }
+  // Finish preparing the scene, however long that takes, and enter it.
+  void enter();
+
+  Scene* scene() const { return _scene; }
+  size_t bytes() const { return _bytes; }
+  // Size of the scene in the arena now.
+  size_t used() const { return _used; }
+
+ private:
+  void* _storage;
+  size_t _bytes;
+  Scene* _scene = nullptr;
+  size_t _used = 0;
+  bool _ready = false;
+  bool _entered = false;
+};
@@ -0,0 +1,96 @@
+#include "scroll_viewport.h"
+
+#include <string.h>
+
+ScrollViewport::ScrollViewport(Adafruit_SSD1306& display, Ssd1306Bus& bus)
+  : Adafruit_GFX(kPanelWidth, kPanelHeight), _display(display), _bus(bus) {}
+
+void ScrollViewport::reset() {
+  _frame = _display.getBuffer();
+  memset(_frame, 0, kFrameBytes);
+  _start = 0;
+  _sentStart = -1;
+  _dirty = 0xFF;
+}
+
+void ScrollViewport::clearRow(int y) {
+  int r = ramRow(y);
+  uint8_t keep = ~(1 << (r & 7));
+  uint8_t* p = _frame + (r >> 3) * kPanelWidth;
+  for (int x = 0; x < kPanelWidth; x++) p[x] &= keep;
+  _dirty |= 1 << (r >> 3);
+}
+
+void ScrollViewport::scroll(int rows) {
+  if (rows >= kPanelHeight || rows <= -kPanelHeight) {
+    memset(_frame, 0, kFrameBytes);
+    _dirty = 0xFF;
+    return;
+  }
+  _start = (_start + rows) & (kPanelHeight - 1);
+  if (rows > 0) {
+    for (int y = kPanelHeight - rows; y < kPanelHeight; y++) clearRow(y);
+  } else {
+    for (int y = 0; y < -rows; y++) clearRow(y);
+  }
+}
+
+void ScrollViewport::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || x >= kPanelWidth || y < 0 || y >= kPanelHeight) return;
+  int r = ramRow(y);
+  uint8_t* p = _frame + x + (r >> 3) * kPanelWidth;
+  uint8_t bit = 1 << (r & 7);
+  switch (color) {
+    case SSD1306_WHITE: *p |= bit; break;
+    case SSD1306_BLACK: *p &= ~bit; break;
+    case SSD1306_INVERSE: *p ^= bit; break;
+  }
+  _dirty |= 1 << (r >> 3);
+}
+
+void ScrollViewport::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if (y < 0 || y >= kPanelHeight) return;
+  int x0 = max<int>(x, 0), x1 = min<int>(x + w, kPanelWidth);
+  if (x0 >= x1) return;
+  int r = ramRow(y);
+  uint8_t* p = _frame + (r >> 3) * kPanelWidth;
+  uint8_t bit = 1 << (r & 7);
+  for (int i = x0; i < x1; i++) {
+    switch (color) {
+      case SSD1306_WHITE: p[i] |= bit; break;
+      case SSD1306_BLACK: p[i] &= ~bit; break;
+      case SSD1306_INVERSE: p[i] ^= bit; break;
+    }
+  }
+  _dirty |= 1 << (r >> 3);
+}
+
+void ScrollViewport::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int i = 0; i < h; i++) drawFastHLine(x, y + i, w, color);
+}
+
+size_t ScrollViewport::present() {
+  uint32_t before = _bus.bytesSent();
+  if (_dirty == 0xFF) {
+    _bus.writeWindow(0, kPanelWidth - 1, 0, kPanelPages - 1, _frame, kFrameBytes);
+  } else {
+    // Contiguous dirty pages go out as one window.
+    for (int p = 0; p < kPanelPages;) {
+      if (!(_dirty & (1 << p))) {
+        p++;
+        continue;
+      }
+      int q = p;
+      while (q + 1 < kPanelPages && (_dirty & (1 << (q + 1)))) q++;
+      _bus.writeWindow(0, kPanelWidth - 1, p, q, _frame + p * kPanelWidth, (q - p + 1) * kPanelWidth);
+      p = q + 1;
+    }
+  }
+  _dirty = 0;
+  if (_sentStart != _start) {
+    uint8_t cmd = SSD1306_SETSTARTLINE | _start;
+    _bus.commands(&cmd, 1);
+    _sentStart = _start;
+  }
+  return _bus.bytesSent() - before;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+
+#include "panel.h"
+#include "ssd1306_bus.h"
+
+// Vertical scroller that moves the picture with the SSD1306 display start
+// line register (0x40 | line) instead of resending it. Screen row y shows
+// panel RAM row (y + start) % 64, so the panel's 8 pages form a ring: a
+// scroll only changes the start line, and the rows it exposes are redrawn
+// in the RAM slots that just scrolled off. present() sends only the pages
+// those rows live in.
+//
+// The ring lives in display's buffer, which keeps mirroring panel RAM, so
+// display.display() still shows the same picture. Draw through the
+// viewport (screen coordinates) rather than display while scrolling.
+// display.begin() allocates that buffer, so call reset() after it and
+// before anything else.
+class ScrollViewport : public Adafruit_GFX {
+ public:
+  ScrollViewport(Adafruit_SSD1306& display, Ssd1306Bus& bus);
+
+  // Bind display's buffer, clear the picture, reset the start line and
+  // resend everything on the next present().
+  void reset();
+  // Move the picture up by rows (down if negative). The rows exposed at
+  // the bottom (top) are cleared, ready to be drawn.
+  void scroll(int rows);
+  // Send the dirty pages, then the new start line. Returns bus bytes sent.
+  size_t present();
+
+  uint8_t startLine() const { return _start; }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+    drawFastHLine(x, y, w, color);
+  }
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+    fillRect(x, y, w, h, color);
+  }
+
+ private:
+  int ramRow(int y) const { return (y + _start) & (kPanelHeight - 1); }
+  void clearRow(int y);
+
+  Adafruit_SSD1306& _display;
+  uint8_t* _frame = nullptr;
+  Ssd1306Bus& _bus;
+  uint8_t _start = 0;
+  int16_t _sentStart = -1;
+  uint8_t _dirty = 0xFF;  // bit n: page n needs sending
+};
@@ -0,0 +1,34 @@
+#include "serial_mirror.h"
+
+#include <Arduino.h>
+
+bool SerialMirror::present(const uint8_t* frame) {
+  uint32_t now = micros();
+  if (!_started) {
+    _budget = _capacity;
+    _lastMicros = now;
+    _lastSentMillis = millis();
+    _started = true;
+  }
+  uint64_t refill = (uint64_t)(now - _lastMicros) * _bytesPerSecond / 1000000;
+  if (refill > 0) {
+    _budget = refill >= _capacity - _budget ? _capacity : _budget + (uint32_t)refill;
+    // Keep the remainder so slow refills are not rounded away.
+    _lastMicros += (uint32_t)(refill * 1000000 / _bytesPerSecond);
+  }
+
+  uint32_t ms = millis();
+  uint32_t elapsed = ms - _lastSentMillis;
+  size_t len = _encoder.encode(frame, elapsed > 0xFFFF ? 0xFFFF : elapsed, _packet);
+  if (len > _budget) {
+    _dropped++;
+    return false;
+  }
+  _out.write(_packet, len);
+  _encoder.commit(frame);
+  _budget -= len;
+  _lastSentMillis = ms;
+  _sent++;
+  _bytes += len;
+  return true;
+}
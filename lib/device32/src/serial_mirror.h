@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Print.h>
+
+#include "frame_mirror.h"
+
+// Sends presented frames to a host viewer (tools/mirror_view.cpp) over the
+// serial console, as frame_mirror.h packets. The link is metered rather
+// than waited on: a token bucket fills at baud / 10 bytes per second up to
+// the size of the TX buffer, and a frame whose packet does not fit is
+// dropped instead of blocking the render loop. The next frame is coded
+// against the last one that went out, so the viewer only loses frame rate.
+// Give Serial a TX buffer of at least kMirrorMaxPacket bytes
+// (setTxBufferSize() before begin()) so a keyframe can go out whole.
+class SerialMirror {
+ public:
+  SerialMirror(Print& out, uint32_t baud, size_t txBuffer, uint16_t keyframeEvery = 60)
+    : _out(out), _bytesPerSecond(baud / 10), _capacity(txBuffer), _encoder(keyframeEvery) {}
+
+  // Returns true if the frame was sent.
+  bool present(const uint8_t* frame);
+
+  uint32_t sent() const { return _sent; }
+  uint32_t dropped() const { return _dropped; }
+  uint32_t bytesSent() const { return _bytes; }
+
+ private:
+  Print& _out;
+  uint32_t _bytesPerSecond;
+  size_t _capacity;
+  MirrorEncoder _encoder;
+  uint8_t _packet[kMirrorMaxPacket];
+  uint32_t _budget = 0;  // bytes the link can take right now
+  uint32_t _lastMicros = 0;
+  uint32_t _lastSentMillis = 0;
+  bool _started = false;
+  uint32_t _sent = 0;
+  uint32_t _dropped = 0;
+  uint32_t _bytes = 0;
+};
@@ -0,0 +1,120 @@
+#include "sprite_layer.h"
+
+#include <stdlib.h>
+
+SpriteLayer::SpriteLayer(SpriteFootprint* slots, int count, Mode mode)
+  : _slots(slots), _count(count), _mode(mode) {
+  clearDamage();
+}
+
+void SpriteLayer::attach(uint8_t* frame) {
+  _frame = frame;
+  reset();
+  clearDamage();
+}
+
+void SpriteLayer::damage(int index) {
+  uint8_t col = index & (kPanelWidth - 1);
+  int page = index / kPanelWidth;
+  if (col < _first[page]) _first[page] = col;
+  if (col > _last[page]) _last[page] = col;
+  _touched++;
+}
+
+void SpriteLayer::erase(int sprite) {
+  SpriteFootprint& s = _slots[sprite];
+  for (int n = 0; n < s.count; n++) {
+    if (_mode == kXor) {
+      _frame[s.index[n]] ^= s.bits[n];
+    } else {
+      _frame[s.index[n]] &= ~s.bits[n];
+    }
+    damage(s.index[n]);
+  }
+  s.count = 0;
+}
+
+void SpriteLayer::eraseAll() {
+  for (int i = 0; i < _count; i++) erase(i);
+}
+
+void SpriteLayer::add(uint16_t index, uint8_t bits) {
+  SpriteFootprint& s = *_current;
+  int n = 0;
+  while (n < s.count && s.index[n] != index) n++;
+  if (n == s.count) {
+    if (n == SpriteFootprint::kMaxBytes) return;
+    s.index[n] = index;
+    s.bits[n] = 0;
+    s.count++;
+  }
+  bits &= ~s.bits[n];
+  if (!bits) return;
+  s.bits[n] |= bits;
+  if (_mode == kXor) {
+    _frame[index] ^= bits;
+  } else {
+    _frame[index] |= bits;
+  }
+  damage(index);
+}
+
+void SpriteLayer::plot(int x, int y) {
+  if (x < 0 || x >= kPanelWidth || y < 0 || y >= kPanelHeight || !_current) return;
+  add(x + (y >> 3) * kPanelWidth, 1 << (y & 7));
+}
+
+void SpriteLayer::fillRect(int x, int y, int w, int h) {
+  int x1 = x + w - 1, y1 = y + h - 1;
+  if (x < 0) x = 0;
+  if (y < 0) y = 0;
+  if (x1 >= kPanelWidth) x1 = kPanelWidth - 1;
+  if (y1 >= kPanelHeight) y1 = kPanelHeight - 1;
+  if (x > x1 || y > y1 || !_current) return;
+
+  // One footprint byte per column and page, as in vSpan() of page_line.
+  for (int page = y >> 3; page <= y1 >> 3; page++) {
+    int top = page * 8 > y ? page * 8 : y;
+    int bottom = page * 8 + 7 < y1 ? page * 8 + 7 : y1;
+    uint8_t mask = (uint8_t)((0xFF << (top & 7)) & (0xFF >> (7 - (bottom & 7))));
+    for (int col = x; col <= x1; col++) add(col + page * kPanelWidth, mask);
+  }
+}
+
+void SpriteLayer::line(int x0, int y0, int x1, int y1) {
+  // Adafruit_GFX::writeLine()'s stepping, so lines match drawLine().
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    int t = x0; x0 = y0; y0 = t;
+    t = x1; x1 = y1; y1 = t;
+  }
+  if (x0 > x1) {
+    int t = x0; x0 = x1; x1 = t;
+    t = y0; y0 = y1; y1 = t;
+  }
+  int dx = x1 - x0, dy = abs(y1 - y0);
+  int err = dx / 2;
+  int ystep = y0 < y1 ? 1 : -1;
+  for (; x0 <= x1; x0++) {
+    if (steep) plot(y0, x0);
+    else plot(x0, y0);
+    err -= dy;
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+void SpriteLayer::clearDamage() {
+  for (int page = 0; page < kPanelPages; page++) {
+    _first[page] = kPanelWidth - 1;
+    _last[page] = 0;
+  }
+  _touched = 0;
+}
+
+void SpriteLayer::reset() {
+  for (int i = 0; i < _count; i++) _slots[i].count = 0;
+  _current = nullptr;
+}
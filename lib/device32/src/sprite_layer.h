@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "panel.h"
+
+// What one sprite last put into the frame: the column bytes it touched and
+// the bits it set in each. Small sprites (stars, boid heads) fit easily;
+// pixels beyond kMaxBytes distinct bytes are not drawn, so nothing is ever
+// left behind that erase() cannot take back.
+struct SpriteFootprint {
+  static constexpr int kMaxBytes = 6;
+
+  uint16_t index[kMaxBytes];
+  uint8_t bits[kMaxBytes];
+  uint8_t count;
+};
+
+// Incremental redraw for scenes made of many small moving objects on a
+// mostly black frame. Instead of clearing 1 KB and rasterising everything
+// again, each sprite's footprint is erased and the new one drawn, so a
+// frame of 100 stars writes a few hundred bytes. The column span touched
+// in each page is kept as damage for DirtyFlush::flush(frame, first, last).
+//
+//   sprites.eraseAll();
+//   for each object i: sprites.select(i); sprites.fillRect(...);
+//   flusher.flush(frame, sprites.firstCols(), sprites.lastCols());
+//   sprites.clearDamage();
+//
+// kClearMask erases by clearing the footprint bits, which also clears any
+// other pixel underneath; erase every sprite before drawing any so that
+// overlapping sprites are not cut. kXor toggles pixels on draw and again on
+// erase, so sprites can move over a background, and overlaps show as holes.
+class SpriteLayer {
+ public:
+  enum Mode : uint8_t { kClearMask, kXor };
+
+  // slots holds one footprint per sprite and stays owned by the caller.
+  SpriteLayer(SpriteFootprint* slots, int count, Mode mode = kClearMask);
+
+  // Draw into frame (an SSD1306 page buffer, e.g. after display.begin()
+  // has allocated it). All footprints start empty.
+  void attach(uint8_t* frame);
+
+  // Take sprite's footprint back out of the frame and leave it empty.
+  void erase(int sprite);
+  void eraseAll();
+
+  // Start drawing sprite; following draw calls add to its footprint.
+  // Erase it first if it was drawn before.
+  void select(int sprite) { _current = &_slots[sprite]; }
+
+  // Clipped to the panel; lines match drawLine(). Pixels already in the
+  // footprint are skipped.
+  void plot(int x, int y);
+  void fillRect(int x, int y, int w, int h);
+  void line(int x0, int y0, int x1, int y1);
+
+  // Column span changed per page since clearDamage(); empty when
+  // first > last.
+  const uint8_t* firstCols() const { return _first; }
+  const uint8_t* lastCols() const { return _last; }
+  void clearDamage();
+
+  // Frame bytes read-modify-written since clearDamage().
+  size_t touchedBytes() const { return _touched; }
+
+  // Forget every footprint without touching the frame, e.g. after the
+  // caller cleared it.
+  void reset();
+
+ private:
+  void add(uint16_t index, uint8_t bits);
+  void damage(int index);
+
+  uint8_t* _frame = nullptr;
+  SpriteFootprint* _slots;
+  SpriteFootprint* _current = nullptr;
+  int _count;
+  Mode _mode;
+  uint8_t _first[kPanelPages];
+  uint8_t _last[kPanelPages];
+  size_t _touched = 0;
+};
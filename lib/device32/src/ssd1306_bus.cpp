@@ -0,0 +1,67 @@
+#include "ssd1306_bus.h"
+
+#include <Adafruit_SSD1306.h>
+
+#ifdef I2C_BUFFER_LENGTH
+static const size_t kWireMax = I2C_BUFFER_LENGTH < 256 ? I2C_BUFFER_LENGTH : 256;
+#else
+static const size_t kWireMax = 32;
+#endif
+
+void Ssd1306Bus::init(uint8_t vccstate) {
+  bool internal = vccstate == SSD1306_SWITCHCAPVCC;
+  const uint8_t cmds[] = {
+    SSD1306_DISPLAYOFF,
+    SSD1306_SETDISPLAYCLOCKDIV, 0x80,
+    SSD1306_SETMULTIPLEX, 63,
+    SSD1306_SETDISPLAYOFFSET, 0x00,
+    SSD1306_SETSTARTLINE | 0x00,
+    SSD1306_CHARGEPUMP, (uint8_t)(internal ? 0x14 : 0x10),
+    SSD1306_MEMORYMODE, 0x00,
+    SSD1306_SEGREMAP | 0x01,
+    SSD1306_COMSCANDEC,
+    SSD1306_SETCOMPINS, 0x12,
+    SSD1306_SETCONTRAST, (uint8_t)(internal ? 0xCF : 0x9F),
+    SSD1306_SETPRECHARGE, (uint8_t)(internal ? 0xF1 : 0x22),
+    SSD1306_SETVCOMDETECT, 0x40,
+    SSD1306_DISPLAYALLON_RESUME,
+    SSD1306_NORMALDISPLAY,
+    SSD1306_DEACTIVATE_SCROLL,
+    SSD1306_DISPLAYON,
+  };
+  commands(cmds, sizeof(cmds));
+}
+
+void Ssd1306Bus::writeWindow(uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1,
+                             const uint8_t* bytes, size_t len) {
+  const uint8_t cmds[] = {SSD1306_COLUMNADDR, col0, col1, SSD1306_PAGEADDR, page0, page1};
+  commands(cmds, sizeof(cmds));
+  data(bytes, len);
+}
+
+void WireBus::send(uint8_t control, const uint8_t* bytes, size_t len) {
+  while (len > 0) {
+    size_t chunk = len < kWireMax - 1 ? len : kWireMax - 1;
+    _wire.beginTransmission(_addr);
+    _wire.write(control);
+    _wire.write(bytes, chunk);
+    _wire.endTransmission();
+    _transactions++;
+    _bytes += chunk + 1;
+    bytes += chunk;
+    len -= chunk;
+  }
+}
+
+size_t WireBus::chunkSize() {
+  return kWireMax - 1;
+}
+
+void CountingBus::count(size_t len) {
+  while (len > 0) {
+    size_t chunk = len < _chunk ? len : _chunk;
+    _transactions++;
+    _bytes += chunk + 1;
+    len -= chunk;
+  }
+}
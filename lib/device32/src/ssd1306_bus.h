@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Wire.h>
+
+// Byte-level transport to an SSD1306. Implementations decide how commands
+// and data map onto bus transactions; the counters record what actually
+// went out so flush strategies can be compared without a scope.
+class Ssd1306Bus {
+ public:
+  virtual ~Ssd1306Bus() {}
+
+  virtual void commands(const uint8_t* cmds, size_t len) = 0;
+  virtual void data(const uint8_t* bytes, size_t len) = 0;
+
+  // Send the 128x64 power-up sequence Adafruit_SSD1306::begin() uses, for
+  // renderers that drive the panel without an Adafruit_SSD1306 buffer.
+  // vccstate is SSD1306_SWITCHCAPVCC or SSD1306_EXTERNALVCC.
+  void init(uint8_t vccstate);
+
+  // Set the column/page address window (horizontal addressing mode) and
+  // stream len bytes into it.
+  virtual void writeWindow(uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1,
+                           const uint8_t* bytes, size_t len);
+
+  // Bracket several writeWindow() calls that may go out together; the
+  // buffers passed in between must stay valid until endBatch(). Transports
+  // that send immediately ignore them.
+  virtual void beginBatch() {}
+  virtual void endBatch() {}
+
+  uint32_t transactions() const { return _transactions; }
+  uint32_t bytesSent() const { return _bytes; }
+  void resetCounters() {
+    _transactions = 0;
+    _bytes = 0;
+  }
+
+ protected:
+  uint32_t _transactions = 0;
+  uint32_t _bytes = 0;
+};
+
+// Arduino Wire transport, the same framing Adafruit_SSD1306 uses: each
+// transaction starts with a control byte (0x00 commands, 0x40 data) and is
+// split to fit the Wire buffer. Counters include control bytes but not the
+// address byte.
+class WireBus : public Ssd1306Bus {
+ public:
+  WireBus(TwoWire& wire, uint8_t addr = 0x3C, uint32_t clock = 400000)
+    : _wire(wire), _addr(addr), _clock(clock) {}
+
+  void begin() { _wire.setClock(_clock); }
+
+  // Largest payload per transaction after the control byte.
+  static size_t chunkSize();
+
+  void commands(const uint8_t* cmds, size_t len) override { send(0x00, cmds, len); }
+  void data(const uint8_t* bytes, size_t len) override { send(0x40, bytes, len); }
+
+ private:
+  void send(uint8_t control, const uint8_t* bytes, size_t len);
+
+  TwoWire& _wire;
+  uint8_t _addr;
+  uint32_t _clock;
+};
+
+// Transport that frames traffic like WireBus and then drops it, so the
+// counters show what a flush strategy would put on the wire. Useful on host
+// builds, or next to the real bus to price an alternative (e.g. a full
+// redraw) without sending it.
+class CountingBus : public Ssd1306Bus {
+ public:
+  explicit CountingBus(size_t chunk = WireBus::chunkSize()) : _chunk(chunk) {}
+
+  void commands(const uint8_t*, size_t len) override { count(len); }
+  void data(const uint8_t*, size_t len) override { count(len); }
+
+ private:
+  void count(size_t len);
+
+  size_t _chunk;
+};
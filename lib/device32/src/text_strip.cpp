@@ -0,0 +1,97 @@
+#include "text_strip.h"
+
+#include <string.h>
+
+#include "glyph_blit.h"
+
+static inline void apply(uint8_t* p, uint8_t mask, uint16_t color) {
+  switch (color) {
+    case SSD1306_WHITE: *p |= mask; break;
+    case SSD1306_BLACK: *p &= ~mask; break;
+    case SSD1306_INVERSE: *p ^= mask; break;
+  }
+}
+
+// Put an 8-bit run at panel rows row..row+7 of column col.
+static inline void writeByte(uint8_t* frame, int col, int row, uint8_t bits, uint16_t color) {
+  if (!bits || col < 0 || col >= kPanelWidth) return;
+  int page = row >> 3;
+  int shift = row & 7;
+  if (page >= 0 && page < kPanelPages) apply(frame + col + page * kPanelWidth, bits << shift, color);
+  if (shift && page + 1 >= 0 && page + 1 < kPanelPages) {
+    apply(frame + col + (page + 1) * kPanelWidth, bits >> (8 - shift), color);
+  }
+}
+
+void TextStrip::render(const char* text, uint8_t rotation, bool bold) {
+  _rotation = rotation == 1 ? 1 : 0;
+  memset(_bits, 0, sizeof(_bits));
+  _chars = 0;
+  for (; text[_chars] && _chars < kMaxChars; _chars++) {
+    uint8_t c = text[_chars];
+    uint8_t cols[5], rows[8];
+    if (GlyphFont::has(c)) {
+      memcpy(cols, GlyphFont::columns(c), 5);
+      GlyphFont::rows(c, rows);
+    } else {
+      GlyphFont::capture(c, cols, rows);
+    }
+    int x = _chars * 6;
+    if (_rotation == 0) {
+      memcpy(_bits + x, cols, 5);
+    } else {
+      // Glyph rows are 5 bits wide; x is not byte aligned, so split each
+      // row across two bytes.
+      for (int r = 0; r < 8; r++) {
+        uint16_t bits = (uint16_t)rows[r] << (x & 7);
+        _bits[r * kRowBytes + (x >> 3)] |= (uint8_t)bits;
+        _bits[r * kRowBytes + (x >> 3) + 1] |= (uint8_t)(bits >> 8);
+      }
+    }
+  }
+  _width = _chars * 6;
+  if (bold && _width > 0) {
+    if (_rotation == 0) {
+      for (int i = _width; i > 0; i--) _bits[i] |= _bits[i - 1];
+    } else {
+      for (int r = 0; r < 8; r++) {
+        uint8_t* row = _bits + r * kRowBytes;
+        for (int i = kRowBytes - 1; i > 0; i--) row[i] |= (uint8_t)(row[i] << 1 | row[i - 1] >> 7);
+        row[0] |= (uint8_t)(row[0] << 1);
+      }
+    }
+    _width++;
+  }
+}
+
+void TextStrip::blit(Adafruit_SSD1306& display, int16_t x, int16_t y, int16_t offset, int16_t w,
+                     uint16_t color) const {
+  if (offset < 0) offset = 0;
+  if (w <= 0 || offset + w > _width) w = _width - offset;
+  if (w <= 0 || display.getRotation() != _rotation) return;
+  if (_rotation == 0) drawLandscape(display.getBuffer(), x, y, offset, w, color);
+  else drawPortrait(display.getBuffer(), x, y, offset, w, color);
+}
+
+void TextStrip::drawLandscape(uint8_t* frame, int16_t x, int16_t y, int16_t offset, int16_t w,
+                              uint16_t color) const {
+  for (int i = 0; i < w; i++) writeByte(frame, x + i, y, _bits[offset + i], color);
+}
+
+void TextStrip::drawPortrait(uint8_t* frame, int16_t x, int16_t y, int16_t offset, int16_t w,
+                             uint16_t color) const {
+  // Logical row y + r is panel column 127 - (y + r); logical x is the
+  // panel row, so each window byte lands on one or two pages.
+  int shift = offset & 7;
+  for (int r = 0; r < 8; r++) {
+    int col = kPanelWidth - 1 - (y + r);
+    if (col < 0 || col >= kPanelWidth) continue;
+    const uint8_t* row = _bits + r * kRowBytes + (offset >> 3);
+    for (int k = 0; k * 8 < w; k++) {
+      uint8_t bits = (uint8_t)((row[k] >> shift) | (shift ? row[k + 1] << (8 - shift) : 0));
+      int left = w - k * 8;
+      if (left < 8) bits &= (uint8_t)((1 << left) - 1);
+      writeByte(frame, col, x + k * 8, bits, color);
+    }
+  }
+}
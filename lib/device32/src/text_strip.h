@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Adafruit_SSD1306.h>
+
+#include "panel.h"
+
+// One line of built-in-font text rendered once into a fixed 1bpp strip,
+// then drawn any number of times through a pixel window. Scrolling a
+// marquee is a windowed blit at a new offset: no String slicing, no
+// re-measuring and no heap. Bold (the text drawn again one pixel right) is
+// folded into the strip when it is rendered.
+//
+// The strip is stored in the panel's native order for the rotation it is
+// rendered for: column bytes for rotation 0, and one bit row per glyph row
+// for rotation 1, where a logical row is a panel column.
+class TextStrip {
+ public:
+  static constexpr int kMaxChars = 32;  // longest SSID
+
+  // Renders text (truncated to kMaxChars) for display rotation 0 or 1.
+  void render(const char* text, uint8_t rotation, bool bold = false);
+  void clear() { _chars = 0; _width = 0; }
+
+  // Strip width in pixels including the trailing spacing column.
+  int16_t width() const { return _width; }
+  // Width getTextBounds() reports for the same text, ignoring bold.
+  int16_t textWidth() const { return _chars * 6; }
+  int16_t length() const { return _chars; }
+
+  // Draw strip pixels [offset, offset + w) with their left edge at the
+  // logical position (x, y). w <= 0 draws to the end of the strip.
+  void blit(Adafruit_SSD1306& display, int16_t x, int16_t y, int16_t offset = 0,
+            int16_t w = 0, uint16_t color = SSD1306_WHITE) const;
+
+ private:
+  static constexpr int kMaxWidth = kMaxChars * 6 + 1;
+  static constexpr int kRowBytes = (kMaxWidth + 7) / 8 + 1;  // +1 so windows can read ahead
+
+  void drawLandscape(uint8_t* frame, int16_t x, int16_t y, int16_t offset, int16_t w, uint16_t color) const;
+  void drawPortrait(uint8_t* frame, int16_t x, int16_t y, int16_t offset, int16_t w, uint16_t color) const;
+
+  uint8_t _rotation = 0;
+  int16_t _chars = 0;
+  int16_t _width = 0;
+  // Rotation 0: one byte per column. Rotation 1: 8 rows of kRowBytes.
+  uint8_t _bits[8 * kRowBytes];
+};
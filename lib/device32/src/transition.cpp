@@ -0,0 +1,149 @@
+#include "transition.h"
+
+#include <string.h>
+
+#include "bayer.h"
+
+// Tables are built by constexpr functions at compile time and live in
+// flash. C++11 constexpr functions are single expressions, so the rows are
+// spelled out with the macros below rather than generated by a loop.
+
+// Column byte of the dissolve at step: rows whose 8x8 Bayer rank is below
+// step.
+static constexpr uint8_t dissolveColumn(int step, int x) {
+  return (uint8_t)((bayer8(x, 0) < step) | (bayer8(x, 1) < step) << 1 | (bayer8(x, 2) < step) << 2 |
+                   (bayer8(x, 3) < step) << 3 | (bayer8(x, 4) < step) << 4 | (bayer8(x, 5) < step) << 5 |
+                   (bayer8(x, 6) < step) << 6 | (bayer8(x, 7) < step) << 7);
+}
+
+#define DISSOLVE_ROW(s)                                                                     \
+  {dissolveColumn(s, 0), dissolveColumn(s, 1), dissolveColumn(s, 2), dissolveColumn(s, 3), \
+   dissolveColumn(s, 4), dissolveColumn(s, 5), dissolveColumn(s, 6), dissolveColumn(s, 7)}
+#define DISSOLVE_ROWS8(s)                                                                   \
+  DISSOLVE_ROW(s), DISSOLVE_ROW(s + 1), DISSOLVE_ROW(s + 2), DISSOLVE_ROW(s + 3),           \
+  DISSOLVE_ROW(s + 4), DISSOLVE_ROW(s + 5), DISSOLVE_ROW(s + 6), DISSOLVE_ROW(s + 7)
+
+// A page is 8 rows, so one 8-byte row of this table tiles the whole frame.
+static constexpr uint8_t kDissolve[Transition::kSteps + 1][8] = {
+  DISSOLVE_ROWS8(0), DISSOLVE_ROWS8(8), DISSOLVE_ROWS8(16), DISSOLVE_ROWS8(24),
+  DISSOLVE_ROWS8(32), DISSOLVE_ROWS8(40), DISSOLVE_ROWS8(48), DISSOLVE_ROWS8(56),
+  DISSOLVE_ROW(64),
+};
+
+// Iris geometry in doubled coordinates around the panel centre (63.5,
+// 31.5), so distances stay integers: column c of a half is 2c + 1 from the
+// centre, row y is |2y - 63|. The doubled radius grows to 142, which
+// reaches the corners (127^2 + 63^2 <= 142^2).
+static constexpr int isqrtIn(int n, int lo, int hi) {
+  return hi - lo <= 1 ? lo
+         : ((lo + hi) / 2) * ((lo + hi) / 2) <= n ? isqrtIn(n, (lo + hi) / 2, hi)
+                                                  : isqrtIn(n, lo, (lo + hi) / 2);
+}
+static constexpr int irisReach(int step) { return (step * 142 + Transition::kSteps - 1) / Transition::kSteps; }
+
+// First covered row of half-column c at step; rows top..63 - top are
+// inside the iris, and 32 means none.
+static constexpr uint8_t irisTopFor(int h) { return h >= 63 ? 0 : (uint8_t)((64 - h) / 2); }
+static constexpr uint8_t irisTop(int step, int c) {
+  return irisReach(step) * irisReach(step) < (2 * c + 1) * (2 * c + 1)
+             ? 32
+             : irisTopFor(isqrtIn(irisReach(step) * irisReach(step) - (2 * c + 1) * (2 * c + 1), 0, 256));
+}
+
+#define IRIS_COLS8(s, c)                                                                           \
+  irisTop(s, c), irisTop(s, c + 1), irisTop(s, c + 2), irisTop(s, c + 3), irisTop(s, c + 4),     \
+  irisTop(s, c + 5), irisTop(s, c + 6), irisTop(s, c + 7)
+#define IRIS_ROW(s)                                                                                \
+  {IRIS_COLS8(s, 0), IRIS_COLS8(s, 8), IRIS_COLS8(s, 16), IRIS_COLS8(s, 24), IRIS_COLS8(s, 32),  \
+   IRIS_COLS8(s, 40), IRIS_COLS8(s, 48), IRIS_COLS8(s, 56)}
+#define IRIS_ROWS8(s)                                                                              \
+  IRIS_ROW(s), IRIS_ROW(s + 1), IRIS_ROW(s + 2), IRIS_ROW(s + 3), IRIS_ROW(s + 4), IRIS_ROW(s + 5), \
+  IRIS_ROW(s + 6), IRIS_ROW(s + 7)
+
+// Indexed by distance from the centre column: half-column c is panel
+// columns 63 - c and 64 + c.
+static constexpr uint8_t kIrisTop[Transition::kSteps + 1][kPanelWidth / 2] = {
+  IRIS_ROWS8(0), IRIS_ROWS8(8), IRIS_ROWS8(16), IRIS_ROWS8(24),
+  IRIS_ROWS8(32), IRIS_ROWS8(40), IRIS_ROWS8(48), IRIS_ROWS8(56),
+  IRIS_ROW(64),
+};
+
+static_assert(kDissolve[Transition::kSteps][0] == 0xFF && kDissolve[1][0] == 0x01,
+              "dissolve starts at rank 0 and ends full");
+static_assert(kIrisTop[0][0] == 32 && kIrisTop[Transition::kSteps][kPanelWidth / 2 - 1] == 0,
+              "iris starts closed and ends past the corners");
+
+// Rows y0..y1 (clipped to page) of a page byte.
+static uint8_t pageSpan(int page, int y0, int y1) {
+  int top = page * 8 > y0 ? page * 8 : y0;
+  int bottom = page * 8 + 7 < y1 ? page * 8 + 7 : y1;
+  if (top > bottom) return 0;
+  return (uint8_t)((0xFF << (top & 7)) & (0xFF >> (7 - (bottom & 7))));
+}
+
+void Transition::buildMask(Wipe wipe, int step, uint32_t* mask) {
+  if (step < 0) step = 0;
+  if (step > kSteps) step = kSteps;
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(mask);
+
+  switch (wipe) {
+    case Wipe::kDissolve: {
+      uint32_t pattern[2];
+      memcpy(pattern, kDissolve[step], sizeof(pattern));
+      for (int i = 0; i < kFrameBytes / 4; i += 2) {
+        mask[i] = pattern[0];
+        mask[i + 1] = pattern[1];
+      }
+      break;
+    }
+    case Wipe::kHorizontal: {
+      int edge = step * kPanelWidth / kSteps;
+      for (int page = 0; page < kPanelPages; page++) {
+        memset(bytes + page * kPanelWidth, 0xFF, edge);
+        memset(bytes + page * kPanelWidth + edge, 0x00, kPanelWidth - edge);
+      }
+      break;
+    }
+    case Wipe::kVertical: {
+      int edge = step * kPanelHeight / kSteps;
+      for (int page = 0; page < kPanelPages; page++) {
+        memset(bytes + page * kPanelWidth, pageSpan(page, 0, edge - 1), kPanelWidth);
+      }
+      break;
+    }
+    case Wipe::kRadial: {
+      const uint8_t* tops = kIrisTop[step];
+      for (int c = 0; c < kPanelWidth / 2; c++) {
+        int top = tops[c];
+        for (int page = 0; page < kPanelPages; page++) {
+          uint8_t b = pageSpan(page, top, kPanelHeight - 1 - top);
+          bytes[page * kPanelWidth + kPanelWidth / 2 - 1 - c] = b;
+          bytes[page * kPanelWidth + kPanelWidth / 2 + c] = b;
+        }
+      }
+      break;
+    }
+  }
+}
+
+void Transition::blend(const uint8_t* from, const uint8_t* to, const uint32_t* mask, uint8_t* out) {
+  const uint32_t* a = reinterpret_cast<const uint32_t*>(from);
+  const uint32_t* b = reinterpret_cast<const uint32_t*>(to);
+  uint32_t* words = reinterpret_cast<uint32_t*>(out);
+  for (int i = 0; i < kFrameBytes / 4; i++) words[i] = (a[i] & ~mask[i]) | (b[i] & mask[i]);
+}
+
+void Transition::start(const uint8_t* outgoing, Wipe wipe, int frames) {
+  memcpy(_from, outgoing, kFrameBytes);
+  _wipe = wipe;
+  _frame = 0;
+  _frames = frames > 0 ? frames : 1;
+}
+
+const uint8_t* Transition::apply(const uint8_t* incoming) {
+  if (!active()) return incoming;
+  _frame++;
+  buildMask(_wipe, _frame * kSteps / _frames, _mask);
+  blend(reinterpret_cast<const uint8_t*>(_from), incoming, _mask, reinterpret_cast<uint8_t*>(_out));
+  return reinterpret_cast<const uint8_t*>(_out);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "panel.h"
+
+// Shape of a scene transition. kDissolve fills in through an 8x8 Bayer
+// ordering, kHorizontal wipes left to right, kVertical top to bottom and
+// kRadial opens an iris from the centre.
+enum class Wipe : uint8_t { kDissolve, kHorizontal, kVertical, kRadial };
+constexpr int kWipeKinds = 4;
+
+// Cross-fades from a held outgoing frame to whatever the incoming scene
+// presents over the next few frames. Each step builds a coverage mask from
+// tables in flash and merges the two frames 32 bits at a time:
+//
+//   out = (outgoing & ~mask) | (incoming & mask)
+//
+// so a transition costs about as much as a memcpy of the frame and runs at
+// the scene's own frame rate. The incoming scene renders as usual; the
+// outgoing frame stays on screen while it resets.
+class Transition {
+ public:
+  static constexpr int kSteps = 64;
+
+  // Coverage for step (0 = all outgoing, kSteps = all incoming) of wipe;
+  // set bits show the incoming frame.
+  static void buildMask(Wipe wipe, int step, uint32_t* mask);
+
+  // out = (from & ~mask) | (to & mask). All 4-byte aligned; out may be
+  // from or to.
+  static void blend(const uint8_t* from, const uint8_t* to, const uint32_t* mask, uint8_t* out);
+
+  // Hold a copy of outgoing and spread wipe over the next frames calls to
+  // apply(). outgoing may be the result of a running transition.
+  void start(const uint8_t* outgoing, Wipe wipe, int frames);
+  void cancel() { _frame = _frames; }
+  bool active() const { return _frame < _frames; }
+
+  // Blend incoming over the held frame at the next step and return the
+  // result (owned by the transition), or incoming itself when not active.
+  const uint8_t* apply(const uint8_t* incoming);
+
+ private:
+  uint32_t _from[kFrameBytes / 4];
+  uint32_t _mask[kFrameBytes / 4];
+  uint32_t _out[kFrameBytes / 4];
+  Wipe _wipe = Wipe::kDissolve;
+  int _frame = 0;
+  int _frames = 0;
+};
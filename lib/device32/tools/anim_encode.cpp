@@ -0,0 +1,92 @@
+// Offline encoder for anim_stream.h. Turns a sequence of 128x64 binary PBM
+// frames into one XOR-delta + RLE stream for a data partition. White
+// pixels (PBM 0 bits) are lit, as on the panel. Frames from a GIF, e.g. one
+// of docs/gifs:
+//
+//   convert docs/gifs/starfield.gif -coalesce -resize 128x64! -threshold 50% /tmp/f_%04d.pbm
+//   g++ -O2 -std=gnu++11 -Isrc tools/anim_encode.cpp src/anim_stream.cpp -o anim_encode
+//   ./anim_encode -d 33 anim.bin /tmp/f_*.pbm
+//
+// then flash anim.bin at the offset of the anim partition (see
+// examples/flipbook).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "anim_stream.h"
+
+// Read a P4 PBM into SSD1306 page layout. Returns false on anything else.
+static bool readPbm(const char* path, uint8_t* frame) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  int w = 0, h = 0;
+  bool ok = fscanf(f, "P4 %d %d", &w, &h) == 2 && w == kPanelWidth && h == kPanelHeight && fgetc(f) != EOF;
+  uint8_t rows[kPanelHeight][kPanelWidth / 8];
+  ok = ok && fread(rows, 1, sizeof(rows), f) == sizeof(rows);
+  fclose(f);
+  if (!ok) return false;
+
+  memset(frame, 0, kFrameBytes);
+  for (int y = 0; y < kPanelHeight; y++) {
+    for (int x = 0; x < kPanelWidth; x++) {
+      bool black = rows[y][x / 8] & (0x80 >> (x & 7));
+      if (!black) frame[x + (y / 8) * kPanelWidth] |= 1 << (y & 7);
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  int delayMs = 33;
+  int arg = 1;
+  if (arg + 1 < argc && strcmp(argv[arg], "-d") == 0) {
+    delayMs = atoi(argv[arg + 1]);
+    arg += 2;
+  }
+  if (argc - arg < 2) {
+    fprintf(stderr, "usage: %s [-d delay_ms] out.bin frame.pbm...\n", argv[0]);
+    return 2;
+  }
+  const char* outPath = argv[arg++];
+  int count = argc - arg;
+  if (count > 0xFFFF) {
+    fprintf(stderr, "too many frames\n");
+    return 1;
+  }
+
+  std::vector<uint8_t> frames((size_t)count * kFrameBytes);
+  for (int n = 0; n < count; n++) {
+    if (!readPbm(argv[arg + n], &frames[(size_t)n * kFrameBytes])) {
+      fprintf(stderr, "%s: not a %dx%d P4 PBM\n", argv[arg + n], kPanelWidth, kPanelHeight);
+      return 1;
+    }
+  }
+
+  std::vector<uint8_t> out(kAnimHeaderBytes);
+  static uint8_t black[kFrameBytes];
+  uint8_t delta[kFrameBytes + kFrameBytes / 64];
+  AnimHeader header = {(uint16_t)count, (uint16_t)delayMs, 0, 0};
+  // Deltas 0..count-1 build each frame from the one before; the last one
+  // leads from the final frame back to the first.
+  for (int n = 0; n <= count; n++) {
+    if (n == 1) header.loopOffset = out.size();
+    const uint8_t* prev = n == 0 ? black : &frames[(size_t)(n - 1) * kFrameBytes];
+    const uint8_t* next = &frames[(size_t)(n % count) * kFrameBytes];
+    size_t len = animEncodeDelta(prev, next, delta);
+    out.insert(out.end(), delta, delta + len);
+  }
+  header.size = out.size();
+  animWriteHeader(header, out.data());
+
+  FILE* f = fopen(outPath, "wb");
+  if (!f || fwrite(out.data(), 1, out.size(), f) != out.size()) {
+    fprintf(stderr, "%s: write failed\n", outPath);
+    return 1;
+  }
+  fclose(f);
+  printf("%d frames, %zu bytes (%.1f per frame, %.1f%% of raw)\n", count, out.size(),
+         (double)out.size() / count, 100.0 * out.size() / ((double)count * kFrameBytes));
+  return 0;
+}
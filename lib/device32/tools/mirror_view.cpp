@@ -0,0 +1,275 @@
+// Host end of SerialMirror (see serial_mirror.h). Reads the raw serial
+// stream, decodes the frame_mirror.h packets in it (console text in
+// between is skipped) and writes what it sees as numbered PBM or PNG
+// frames, an animated GIF timed from the packets, and/or raw page-layout
+// frames for bench/mirror_bench.cpp. Live from the board:
+//
+//   g++ -O2 -std=gnu++11 -Isrc tools/mirror_view.cpp src/frame_mirror.cpp src/anim_stream.cpp -o mirror_view
+//   stty -F /dev/ttyACM0 115200 raw
+//   ./mirror_view -f png -o /tmp/mirror/f -g /tmp/mirror.gif /dev/ttyACM0
+//
+// or from a capture (e.g. cat /dev/ttyACM0 > capture.bin). Stop a live
+// session with Ctrl-C; the GIF is finished on the way out.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "frame_mirror.h"
+
+static volatile sig_atomic_t stopping = 0;
+
+static bool lit(const uint8_t* frame, int x, int y) {
+  return frame[x + (y / 8) * kPanelWidth] & (1 << (y & 7));
+}
+
+// P4 PBM, lit pixels white (0 bits), as tools/anim_encode.cpp reads them.
+static bool writePbm(const char* path, const uint8_t* frame) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P4\n%d %d\n", kPanelWidth, kPanelHeight);
+  for (int y = 0; y < kPanelHeight; y++) {
+    uint8_t row[kPanelWidth / 8] = {};
+    for (int x = 0; x < kPanelWidth; x++)
+      if (!lit(frame, x, y)) row[x / 8] |= 0x80 >> (x & 7);
+    fwrite(row, 1, sizeof(row), f);
+  }
+  return fclose(f) == 0;
+}
+
+static uint32_t crc32(const uint8_t* p, size_t len, uint32_t crc = 0) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *p++;
+    for (int k = 0; k < 8; k++) crc = crc >> 1 ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+static void putBe32(std::vector<uint8_t>& out, uint32_t v) {
+  for (int shift = 24; shift >= 0; shift -= 8) out.push_back(v >> shift);
+}
+
+static void pngChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+  putBe32(out, data.size());
+  size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  putBe32(out, crc32(&out[start], out.size() - start));
+}
+
+// 1-bit greyscale PNG. The image is small enough to go uncompressed, in a
+// single stored deflate block, so no zlib is needed.
+static bool writePng(const char* path, const uint8_t* frame) {
+  std::vector<uint8_t> raw;
+  for (int y = 0; y < kPanelHeight; y++) {
+    raw.push_back(0);  // filter: none
+    for (int x = 0; x < kPanelWidth; x += 8) {
+      uint8_t b = 0;
+      for (int k = 0; k < 8; k++)
+        if (lit(frame, x + k, y)) b |= 0x80 >> k;
+      raw.push_back(b);
+    }
+  }
+  uint32_t a = 1, b = 0;
+  for (uint8_t c : raw) {
+    a = (a + c) % 65521;
+    b = (b + a) % 65521;
+  }
+
+  std::vector<uint8_t> ihdr, idat;
+  putBe32(ihdr, kPanelWidth);
+  putBe32(ihdr, kPanelHeight);
+  const uint8_t format[] = {1, 0, 0, 0, 0};  // depth 1, greyscale
+  ihdr.insert(ihdr.end(), format, format + sizeof(format));
+  const uint8_t stored[] = {0x78, 0x01, 0x01, (uint8_t)raw.size(), (uint8_t)(raw.size() >> 8),
+                            (uint8_t)~raw.size(), (uint8_t)(~raw.size() >> 8)};
+  idat.insert(idat.end(), stored, stored + sizeof(stored));
+  idat.insert(idat.end(), raw.begin(), raw.end());
+  putBe32(idat, b << 16 | a);
+
+  static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  std::vector<uint8_t> png(signature, signature + sizeof(signature));
+  pngChunk(png, "IHDR", ihdr);
+  pngChunk(png, "IDAT", idat);
+  pngChunk(png, "IEND", std::vector<uint8_t>());
+
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+  return fclose(f) == 0 && ok;
+}
+
+// Animated GIF, two colours, looping, one image per decoded frame.
+class GifWriter {
+ public:
+  bool open(const char* path) {
+    _f = fopen(path, "wb");
+    if (!_f) return false;
+    const uint8_t header[] = {
+      'G', 'I', 'F', '8', '9', 'a', kPanelWidth, 0, kPanelHeight, 0,
+      0x80, 0, 0,             // global table of 2 colours
+      0, 0, 0, 255, 255, 255, // off, lit
+      0x21, 0xFF, 11, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 3, 1, 0, 0, 0,
+    };
+    fwrite(header, 1, sizeof(header), _f);
+    return true;
+  }
+
+  void add(const uint8_t* frame, uint16_t delayMs) {
+    uint16_t cs = (delayMs + 5) / 10;
+    const uint8_t head[] = {
+      0x21, 0xF9, 4, 0, (uint8_t)cs, (uint8_t)(cs >> 8), 0, 0,
+      0x2C, 0, 0, 0, 0, kPanelWidth, 0, kPanelHeight, 0, 0,
+      2,  // LZW minimum code size
+    };
+    fwrite(head, 1, sizeof(head), _f);
+
+    uint8_t pixels[kPanelWidth * kPanelHeight];
+    for (int y = 0; y < kPanelHeight; y++)
+      for (int x = 0; x < kPanelWidth; x++) pixels[y * kPanelWidth + x] = lit(frame, x, y);
+    std::vector<uint8_t> data;
+    lzw(pixels, sizeof(pixels), data);
+    for (size_t i = 0; i < data.size(); i += 255) {
+      size_t n = data.size() - i < 255 ? data.size() - i : 255;
+      fputc((int)n, _f);
+      fwrite(&data[i], 1, n, _f);
+    }
+    fputc(0, _f);
+  }
+
+  bool close() {
+    if (!_f) return true;
+    fputc(0x3B, _f);
+    bool ok = fclose(_f) == 0;
+    _f = nullptr;
+    return ok;
+  }
+
+ private:
+  static void lzw(const uint8_t* pixels, size_t count, std::vector<uint8_t>& out) {
+    const int kClear = 4, kEnd = 5;
+    static int16_t next[4096][4];
+    uint32_t bits = 0;
+    int held = 0, size = 3, last = kEnd;
+    auto put = [&](int code) {
+      bits |= (uint32_t)code << held;
+      for (held += size; held >= 8; held -= 8, bits >>= 8) out.push_back(bits & 0xFF);
+    };
+    auto reset = [&]() {
+      memset(next, 0xFF, sizeof(next));
+      put(kClear);
+      size = 3;
+      last = kEnd;
+    };
+
+    reset();
+    int prefix = pixels[0];
+    for (size_t i = 1; i < count; i++) {
+      int c = pixels[i];
+      if (next[prefix][c] >= 0) {
+        prefix = next[prefix][c];
+        continue;
+      }
+      put(prefix);
+      next[prefix][c] = ++last;
+      if (last >= 1 << size) size++;
+      if (last == 4095) reset();
+      prefix = c;
+    }
+    put(prefix);
+    put(kEnd);
+    if (held) out.push_back(bits & 0xFF);
+  }
+
+  FILE* _f = nullptr;
+};
+
+static void usage() {
+  fprintf(stderr,
+          "usage: mirror_view [-f pbm|png] [-o prefix] [-g out.gif] [-r frames.raw] [input]\n"
+          "  -o writes prefix_NNNNN.pbm/png per frame; input defaults to stdin\n");
+}
+
+int main(int argc, char** argv) {
+  const char* format = "pbm";
+  const char* prefix = nullptr;
+  const char* gifPath = nullptr;
+  const char* rawPath = nullptr;
+  const char* inputPath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    const char* opt = argv[i];
+    if (opt[0] == '-' && opt[1] && !opt[2] && i + 1 < argc && strchr("fogr", opt[1])) {
+      const char* value = argv[++i];
+      switch (opt[1]) {
+        case 'f': format = value; break;
+        case 'o': prefix = value; break;
+        case 'g': gifPath = value; break;
+        case 'r': rawPath = value; break;
+      }
+    } else if (opt[0] != '-' && !inputPath) {
+      inputPath = opt;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  bool png = strcmp(format, "png") == 0;
+  if ((!png && strcmp(format, "pbm") != 0) || (!prefix && !gifPath && !rawPath)) {
+    usage();
+    return 2;
+  }
+
+  FILE* in = inputPath ? fopen(inputPath, "rb") : stdin;
+  if (!in) {
+    fprintf(stderr, "can't open %s\n", inputPath);
+    return 1;
+  }
+  GifWriter gif;
+  if (gifPath && !gif.open(gifPath)) {
+    fprintf(stderr, "can't write %s\n", gifPath);
+    return 1;
+  }
+  FILE* raw = rawPath ? fopen(rawPath, "wb") : nullptr;
+  if (rawPath && !raw) {
+    fprintf(stderr, "can't write %s\n", rawPath);
+    return 1;
+  }
+  signal(SIGINT, [](int) { stopping = 1; });
+
+  // Each frame is written when the next one arrives, so its GIF delay is
+  // known: the next packet's stamp is how long this frame was up.
+  static MirrorDecoder decoder;
+  uint8_t shown[kFrameBytes];
+  bool pending = false;
+  uint32_t written = 0, keyframes = 0;
+  auto emit = [&](uint16_t delayMs) {
+    if (prefix) {
+      char path[512];
+      snprintf(path, sizeof(path), "%s_%05u.%s", prefix, (unsigned)written, format);
+      if (!(png ? writePng(path, shown) : writePbm(path, shown))) fprintf(stderr, "can't write %s\n", path);
+    }
+    if (gifPath) gif.add(shown, delayMs);
+    if (raw) fwrite(shown, 1, kFrameBytes, raw);
+    written++;
+  };
+
+  int c;
+  while (!stopping && (c = getc(in)) != EOF) {
+    if (!decoder.push((uint8_t)c)) continue;
+    keyframes += decoder.keyframe();
+    if (pending) emit(decoder.elapsedMs());
+    memcpy(shown, decoder.frame(), kFrameBytes);
+    pending = true;
+  }
+  if (pending) emit(100);
+
+  if (raw) fclose(raw);
+  if (!gif.close()) fprintf(stderr, "can't finish %s\n", gifPath);
+  fprintf(stderr, "%u frames, %u keyframes seen, %u corrupt packets, %u deltas without a base\n",
+          (unsigned)decoder.frames(), (unsigned)keyframes, (unsigned)decoder.corrupt(),
+          (unsigned)decoder.unsynced());
+  return 0;
+}